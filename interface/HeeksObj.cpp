@@ -164,6 +164,14 @@ bool HeeksObj::Add(HeeksObj* object, HeeksObj* prev_object)
 	return true;
 }
 
+void HeeksObj::Remove(std::list<HeeksObj*> objects)
+{
+	for(std::list<HeeksObj*>::iterator It = objects.begin(); It != objects.end(); It++)
+	{
+		Remove(*It);
+	}
+}
+
 void HeeksObj::OnRemove()
 {
 	if(m_owner == NULL)KillGLLists();
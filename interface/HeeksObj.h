@@ -55,6 +55,7 @@ enum{
 	ImageType,
 	XmlType,
 	InsertType, // just temporarily during dxf import
+	InstanceType,
 	ObjectMaximumType,
 };
 
@@ -164,6 +165,7 @@ public:
 	virtual bool Add(HeeksObj* object, HeeksObj* prev_object);
 	virtual bool IsDifferent(HeeksObj* other){return false;}
 	virtual void Remove(HeeksObj* object){object->OnRemove();}
+	virtual void Remove(std::list<HeeksObj*> objects); // removes them one at a time, unless a list can do it faster
 	virtual void OnAdd(){}
 	virtual void OnRemove();
 	virtual bool CanBeRemoved(){return true;}
@@ -20,10 +20,14 @@ void ObjList::Clear()
 	std::list<HeeksObj*>::iterator It;
 	for(It=m_objects.begin(); It!=m_objects.end() ;It++)
 	{
+#ifdef HEEKSCAD
+		wxGetApp().m_snap_index.Remove(*It);
+#endif
 		(*It)->m_owner = NULL;
 		delete *It;
 	}
 	m_objects.clear();
+	m_object_set.clear();
 	m_index_list.clear();
 	m_index_list_valid = true;
 }
@@ -35,7 +39,11 @@ void ObjList::Clear(std::set<HeeksObj*> &to_delete)
 	{
 		if(to_delete.find(*It) != to_delete.end())
 		{
+#ifdef HEEKSCAD
+			wxGetApp().m_snap_index.Remove(*It);
+#endif
 			(*It)->m_owner = NULL;
+			m_object_set.erase(*It);
 			It = m_objects.erase(It);
 		}
 		else
@@ -75,6 +83,7 @@ void ObjList::ClearUndoably(void)
 #endif
 	}
 	m_objects.clear();
+	m_object_set.clear();
 	LoopItStack.clear();
 	m_index_list.clear();
 	m_index_list_valid = true;
@@ -106,6 +115,9 @@ void ObjList::glCommands(bool select, bool marked, bool no_color)
 		HeeksObj* object = *It;
 		if(object->OnVisibleLayer() && object->m_visible)
 		{
+#ifdef HEEKSCAD
+			if(wxGetApp().m_view_culler.IsCulled(object))continue;
+#endif
 			if(select)glPushName(object->GetIndex());
 #ifdef HEEKSCAD
 			(*It)->glCommands(select, marked || wxGetApp().m_marked_list->ObjectMarked(object), no_color);
@@ -185,6 +197,7 @@ void ObjList::Add(std::list<HeeksObj*> objects)
 
 void ObjList::Remove(std::list<HeeksObj*> objects)
 {
+	// one at a time, so subclasses which override Remove(HeeksObj*) see every object
 	std::list<HeeksObj*>::iterator it;
 	for(it = objects.begin(); it != objects.end(); it++)
 	{
@@ -192,11 +205,39 @@ void ObjList::Remove(std::list<HeeksObj*> objects)
 	}
 }
 
+void ObjList::RemoveInOnePass(std::list<HeeksObj*> objects)
+{
+	if(objects.size() == 1)
+	{
+		Remove(objects.front());
+		return;
+	}
+
+	// take them all out in one pass through m_objects, rather than looking for each one
+	std::set<HeeksObj*> to_remove(objects.begin(), objects.end());
+	for(LoopIt = m_objects.begin(); LoopIt != m_objects.end();)
+	{
+		if(to_remove.find(*LoopIt) != to_remove.end())
+		{
+			m_object_set.erase(*LoopIt);
+			LoopIt = m_objects.erase(LoopIt);
+		}
+		else LoopIt++;
+	}
+	m_index_list_valid = false;
+
+	std::list<HeeksObj*>::iterator it;
+	for(it = objects.begin(); it != objects.end(); it++)
+	{
+		Removed(*it);
+	}
+}
+
 bool ObjList::Add(HeeksObj* object, HeeksObj* prev_object)
 {
 	if (object==NULL) return false;
 	if (!CanAdd(object)) return false;
-	if (std::find(m_objects.begin(), m_objects.end(), object) != m_objects.end()) return true; // It's already here.
+	if (!m_object_set.insert(object).second) return true; // It's already here.
 
 	if (m_objects.size()==0 || prev_object==NULL)
 	{
@@ -213,6 +254,8 @@ bool ObjList::Add(HeeksObj* object, HeeksObj* prev_object)
 	HeeksObj::Add(object, prev_object);
 
 #ifdef HEEKSCAD
+	wxGetApp().m_view_culler.Invalidate();
+	wxGetApp().m_snap_index.Add(object);
 	if(((!wxGetApp().m_in_OpenFile || wxGetApp().m_file_open_or_import_type != FileOpenTypeHeeks || wxGetApp().m_inPaste) && object->UsesID() && (object->m_id == 0 || (wxGetApp().m_file_open_or_import_type == FileImportTypeHeeks && wxGetApp().m_in_OpenFile))))
 	{
 		object->SetID(wxGetApp().GetNextID(object->GetIDGroupType()));
@@ -244,8 +287,14 @@ void ObjList::Remove(HeeksObj* object)
 	if(LoopIt != m_objects.end())
 	{
 		m_objects.erase(LoopIt);
+		m_object_set.erase(object);
 	}
 	m_index_list_valid = false;
+	Removed(object);
+}
+
+void ObjList::Removed(HeeksObj* object)
+{
 	HeeksObj::Remove(object);
 
 	std::list<HeeksObj*> parents;
@@ -253,6 +302,8 @@ void ObjList::Remove(HeeksObj* object)
 	object->Disconnect(parents);
 
 #ifdef HEEKSCAD
+	wxGetApp().m_view_culler.Invalidate();
+	wxGetApp().m_snap_index.Remove(object);
 	if( (!wxGetApp().m_in_OpenFile || wxGetApp().m_file_open_or_import_type != FileOpenTypeHeeks) &&
 		object->UsesID() &&
 		(object->m_id == 0 || (wxGetApp().m_file_open_or_import_type == FileImportTypeHeeks && wxGetApp().m_in_OpenFile))
@@ -17,12 +17,15 @@ class ObjList : public HeeksObj
 
 protected:
 	std::list<HeeksObj*> m_objects;
+	std::set<HeeksObj*> m_object_set; // the same objects as m_objects, so Add can tell whether an object is already here without looking through the list
 	std::list<HeeksObj*>::iterator LoopIt;
 	std::list<std::list<HeeksObj*>::iterator> LoopItStack;
 	std::vector<HeeksObj*> m_index_list; // for quick performance of GetAtIndex();
 	bool m_index_list_valid;
 
 	void recalculate_index_list();
+	void Removed(HeeksObj* object); // everything Remove does after taking the object out of m_objects
+	void RemoveInOnePass(std::list<HeeksObj*> objects); // Remove(list) without calling Remove(HeeksObj*), for subclasses whose Remove(HeeksObj*) adds nothing they can't do for the whole list
 
 public:
 	ObjList():m_index_list_valid(true){}
@@ -0,0 +1,284 @@
+// BatchConvert.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "BatchConvert.h"
+#include "WorkerPool.h"
+#include "HDxf.h"
+#include "OffscreenRender.h"
+#include <wx/stopwatch.h>
+#ifndef WIN32
+#include <sys/wait.h>
+#include <errno.h>
+#endif
+
+static const wxChar* files_to_read[] = {_T("heeks"), _T("heeksb"), _T("step"), _T("stp"), _T("iges"), _T("igs"), _T("stl"), _T("dxf"), _T("svg"), NULL};
+static const wxChar* files_to_write[] = {_T("heeks"), _T("heeksb"), _T("step"), _T("stp"), _T("iges"), _T("igs"), _T("stl"), _T("dxf"), _T("png"), NULL};
+
+static bool ExtensionInList(const wxString &filepath, const wxChar** extensions)
+{
+	wxString ext = wxFileName(filepath).GetExt().Lower();
+	for(int i = 0; extensions[i]; i++)
+	{
+		if(ext == extensions[i])return true;
+	}
+	return false;
+}
+
+bool CBatchConvert::ReadCommandLine(int argc, wxChar** argv)
+{
+	wxCmdLineParser parser(argc, argv);
+	parser.AddOption(_T("c"), _T("convert"), _("converts the files to this file type, without the main window"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(_T("t"), _T("threads"), _("how many files to convert at once, 0 for one per processor"), wxCMD_LINE_VAL_NUMBER);
+	parser.AddOption(_T("s"), _T("size"), _("the size of png files, in pixels, like 256 or 320x200"), wxCMD_LINE_VAL_STRING);
+	parser.AddOption(_T("v"), _T("view"), _("the view for png files; xy, xym, xz, xzm, yz, yzm or xyz"), wxCMD_LINE_VAL_STRING);
+	parser.AddParam(_("input files"), wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE);
+	if(parser.Parse(false) != 0)return false;
+
+	wxString extension;
+	if(!parser.Found(_T("convert"), &extension))return false;
+	parser.Found(_T("threads"), &m_num_threads);
+	parser.Found(_T("size"), &m_size);
+	parser.Found(_T("view"), &m_view);
+
+	m_program = argv[0];
+	m_extension = extension.Lower();
+	if(m_extension.StartsWith(_T(".")))m_extension = m_extension.Mid(1);
+	for(unsigned int i = 0; i < parser.GetParamCount(); i++)m_files.Add(parser.GetParam(i));
+
+	return true;
+}
+
+// static
+bool CBatchConvert::InCommandLine(int argc, wxChar** argv)
+{
+#ifdef PYHEEKSCAD
+	return false;
+#else
+	for(int i = 1; i < argc; i++)
+	{
+		wxString arg(argv[i]);
+		if(arg == _T("--convert") || arg == _T("-c") || arg.StartsWith(_T("--convert=")))return true;
+	}
+	return false;
+#endif
+}
+
+int CBatchConvert::Run()
+{
+	// don't pop up message boxes for logged errors; there is nobody to close them
+	delete wxLog::SetActiveTarget(new wxLogStderr);
+
+	// and don't ask whether to read a DXF file again, ignoring errors; just do that
+	HeeksDxfRead::m_ignore_errors = true;
+
+	if(!ExtensionInList(_T("a.") + m_extension, files_to_write))
+	{
+		wxFprintf(stderr, _T("can't write %s files\n"), m_extension.c_str());
+		return 1;
+	}
+
+	if(m_extension == _T("png"))
+	{
+		if(!OffscreenRenderAvailable())
+		{
+			wxFprintf(stderr, _T("this HeeksCAD was built without OSMesa, so it can't draw pictures without a window\n"));
+			return 1;
+		}
+
+		long width = 0, height = 0;
+		wxString height_str;
+		wxString width_str = m_size.BeforeFirst(_T('x'));
+		if(m_size.Find(_T('x')) == wxNOT_FOUND)height_str = width_str;
+		else height_str = m_size.AfterFirst(_T('x'));
+		if(!width_str.ToLong(&width) || !height_str.ToLong(&height) || width <= 0 || height <= 0)
+		{
+			wxFprintf(stderr, _T("bad picture size: %s\n"), m_size.c_str());
+			return 1;
+		}
+		m_width = (int)width;
+		m_height = (int)height;
+
+		gp_Vec unitY, unitZ;
+		if(!GetStandardView(m_view, unitY, unitZ))
+		{
+			wxFprintf(stderr, _T("unknown view: %s\n"), m_view.c_str());
+			return 1;
+		}
+	}
+
+	if(m_files.GetCount() == 1)return ConvertFile(m_files[0]) ? 0 : 1;
+	return ConvertFiles();
+}
+
+bool CBatchConvert::ConvertFile(const wxString &filepath)
+{
+	wxFileName output_name(filepath);
+	output_name.SetExt(m_extension);
+	wxString output_path = output_name.GetFullPath();
+
+	// check the file types first, so OpenFile and SaveFile don't pop up message boxes about them
+	if(!ExtensionInList(filepath, files_to_read))
+	{
+		wxPrintf(_T("%s: can't read this type of file\n"), filepath.c_str());
+		fflush(stdout);
+		return false;
+	}
+
+	wxStopWatch timer;
+	bool succeeded = false;
+	long open_time = 0;
+	try
+	{
+		if(wxGetApp().OpenFile(filepath.c_str(), false, NULL, NULL, false))
+		{
+			open_time = timer.Time();
+			timer.Start();
+			if(m_extension == _T("png"))succeeded = WritePicture(output_path);
+			else succeeded = wxGetApp().SaveFile(output_path.c_str(), false, false, false);
+		}
+	}
+	catch(...)
+	{
+		succeeded = false;
+	}
+
+	if(succeeded)wxPrintf(_T("%s -> %s: read in %.3fs, written in %.3fs\n"), filepath.c_str(), output_path.c_str(), open_time * 0.001, timer.Time() * 0.001);
+	else wxPrintf(_T("%s: failed\n"), filepath.c_str());
+	fflush(stdout);
+
+	return succeeded;
+}
+
+bool CBatchConvert::WritePicture(const wxString &filepath)
+{
+	gp_Vec unitY, unitZ;
+	GetStandardView(m_view, unitY, unitZ);
+
+	wxImage image;
+	if(!RenderImage(image, m_width, m_height, unitY, unitZ))return false;
+	return image.SaveFile(filepath, wxBITMAP_TYPE_PNG);
+}
+
+// copies of this program, started with wxExecute, each converting one file.
+// wxExecute can only be used on the main thread, so the main thread starts them, and waits for whichever finishes first
+class CConvertProcesses
+{
+	std::vector<long> m_pids;
+#ifdef WIN32
+	std::vector<HANDLE> m_handles;
+#endif
+
+public:
+	static int MaxRunning()
+	{
+#ifdef WIN32
+		return MAXIMUM_WAIT_OBJECTS;
+#else
+		return 1000;
+#endif
+	}
+
+	int NumRunning()const{return (int)m_pids.size();}
+
+	// returns false if the copy couldn't be started
+	bool Start(const wxArrayString &args)
+	{
+		// an argument list, not a command line, so nothing in the file names is interpreted by a shell
+		std::vector<const wxChar*> argv;
+		for(unsigned int i = 0; i < args.GetCount(); i++)argv.push_back((const wxChar*)args[i].c_str());
+		argv.push_back(NULL);
+
+		long pid = wxExecute((wxChar**)&argv[0], wxEXEC_ASYNC);
+		if(pid <= 0)return false;
+
+#ifdef WIN32
+		HANDLE handle = OpenProcess(SYNCHRONIZE | PROCESS_QUERY_INFORMATION, FALSE, (DWORD)pid);
+		if(handle == NULL)return false;
+		m_handles.push_back(handle);
+#endif
+		m_pids.push_back(pid);
+		return true;
+	}
+
+	// waits for one of the running copies to finish, and returns true if it succeeded
+	bool WaitForOne()
+	{
+		if(m_pids.size() == 0)return false;
+
+#ifdef WIN32
+		DWORD result = WaitForMultipleObjects((DWORD)m_handles.size(), &m_handles[0], FALSE, INFINITE);
+		size_t i = result - WAIT_OBJECT_0;
+		if(i >= m_handles.size())i = 0;
+		DWORD exit_code = 1;
+		if(!GetExitCodeProcess(m_handles[i], &exit_code))exit_code = 1;
+		CloseHandle(m_handles[i]);
+		m_handles.erase(m_handles.begin() + i);
+		m_pids.erase(m_pids.begin() + i);
+		return exit_code == 0;
+#else
+		while(1)
+		{
+			int status = 0;
+			pid_t pid = waitpid(-1, &status, 0);
+			if(pid == -1)
+			{
+				if(errno == EINTR)continue;
+
+				// there are no children left to wait for
+				m_pids.clear();
+				return false;
+			}
+
+			std::vector<long>::iterator FindIt = std::find(m_pids.begin(), m_pids.end(), (long)pid);
+			if(FindIt == m_pids.end())continue;
+			m_pids.erase(FindIt);
+			return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+		}
+#endif
+	}
+};
+
+int CBatchConvert::ConvertFiles()
+{
+	wxStopWatch timer;
+
+	int num_running = (m_num_threads > 0) ? (int)m_num_threads : CWorkerPool::NumThreads();
+	if(num_running > CConvertProcesses::MaxRunning())num_running = CConvertProcesses::MaxRunning();
+
+	CConvertProcesses processes;
+	int num_succeeded = 0;
+	for(unsigned int i = 0; i < m_files.GetCount(); i++)
+	{
+		if(processes.NumRunning() >= num_running && processes.WaitForOne())num_succeeded++;
+
+		// the copy prints its own timings
+		wxArrayString args;
+		args.Add(m_program);
+		args.Add(_T("--convert"));
+		args.Add(m_extension);
+		if(m_extension == _T("png"))
+		{
+			args.Add(_T("--size"));
+			args.Add(m_size);
+			args.Add(_T("--view"));
+			args.Add(m_view);
+		}
+		args.Add(m_files[i]);
+		if(!processes.Start(args))
+		{
+			wxPrintf(_T("%s: couldn't start %s\n"), m_files[i].c_str(), m_program.c_str());
+			fflush(stdout);
+		}
+	}
+
+	while(processes.NumRunning() > 0)
+	{
+		if(processes.WaitForOne())num_succeeded++;
+	}
+
+	wxPrintf(_T("converted %d of %d files in %.3fs\n"), num_succeeded, (int)m_files.GetCount(), timer.Time() * 0.001);
+	fflush(stdout);
+
+	return (num_succeeded == (int)m_files.GetCount()) ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+// BatchConvert.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// converts files from one format to another without the main window or OpenGL, for scripts.
+// "HeeksCAD --convert stl a.step b.igs" writes a.stl and b.stl, and prints how long each file took.
+// "HeeksCAD --convert png --size 128x128 --view xyz a.step" draws a picture of a.step in a.png, if HeeksCAD was built with OSMesa.
+// there is only one document, so each file is converted by a copy of HeeksCAD of its own, and several copies are run at once.
+class CBatchConvert
+{
+	wxString m_program; // how this copy was run, to run the others with
+	wxString m_extension; // of the files to write, without the dot
+	wxArrayString m_files;
+	long m_num_threads; // 0 for one per processor
+	wxString m_size; // of pictures, "width" or "widthxheight"
+	wxString m_view; // for pictures, one of the names GetStandardView knows
+	int m_width;
+	int m_height;
+
+	bool ConvertFile(const wxString &filepath); // in this copy
+	bool WritePicture(const wxString &filepath);
+	int ConvertFiles(); // in other copies
+
+public:
+	CBatchConvert():m_num_threads(0), m_size(_T("256")), m_view(_T("xyz")), m_width(256), m_height(256){}
+
+	// returns true if the command line asks for files to be converted
+	bool ReadCommandLine(int argc, wxChar** argv);
+	static bool InCommandLine(int argc, wxChar** argv); // the same, without parsing it, for before wxWidgets is started
+	bool Requested()const{return m_extension.Len() > 0;}
+
+	// returns the program's exit code
+	int Run();
+};
@@ -0,0 +1,178 @@
+// BoxTree.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "BoxTree.h"
+
+void CFrustum::SetFromGL()
+{
+	double p[16], m[16], c[16];
+	glGetDoublev(GL_PROJECTION_MATRIX, p);
+	glGetDoublev(GL_MODELVIEW_MATRIX, m);
+
+	// clip = projection * modelview; the matrices are in column order
+	for(int col = 0; col<4; col++)
+	{
+		for(int row = 0; row<4; row++)
+		{
+			c[col*4+row] = p[row] * m[col*4] + p[4+row] * m[col*4+1] + p[8+row] * m[col*4+2] + p[12+row] * m[col*4+3];
+		}
+	}
+
+	// each plane is the fourth row of the clip matrix, plus or minus one of the other rows
+	for(int i = 0; i<3; i++)
+	{
+		for(int j = 0; j<4; j++)
+		{
+			m_planes[i*2][j] = c[j*4+3] + c[j*4+i];
+			m_planes[i*2+1][j] = c[j*4+3] - c[j*4+i];
+		}
+	}
+}
+
+bool CFrustum::Intersects(const CBox &box)const
+{
+	if(!box.m_valid)return true;
+
+	for(int i = 0; i<6; i++)
+	{
+		// the corner furthest along the plane's normal
+		const double* plane = m_planes[i];
+		double x = (plane[0] > 0) ? box.m_x[3] : box.m_x[0];
+		double y = (plane[1] > 0) ? box.m_x[4] : box.m_x[1];
+		double z = (plane[2] > 0) ? box.m_x[5] : box.m_x[2];
+		if(plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0)return false;
+	}
+	return true;
+}
+
+CLineBoxTest::CLineBoxTest(const gp_Lin &line, double radius):m_radius(radius)
+{
+	extract(line.Location(), m_start);
+	extract(line.Direction().XYZ(), m_direction);
+}
+
+bool CLineBoxTest::Intersects(const CBox &box)const
+{
+	if(!box.m_valid)return true;
+
+	// clip the line to each pair of faces of the box, made bigger by the radius
+	double t_min = -1.0e30;
+	double t_max = 1.0e30;
+	for(int i = 0; i<3; i++)
+	{
+		double lo = box.m_x[i] - m_radius;
+		double hi = box.m_x[i+3] + m_radius;
+		if(fabs(m_direction[i]) < 1.0e-12)
+		{
+			if(m_start[i] < lo || m_start[i] > hi)return false;
+			continue;
+		}
+		double t1 = (lo - m_start[i]) / m_direction[i];
+		double t2 = (hi - m_start[i]) / m_direction[i];
+		if(t1 > t2){double t = t1; t1 = t2; t2 = t;}
+		if(t1 > t_min)t_min = t1;
+		if(t2 < t_max)t_max = t2;
+		if(t_min > t_max)return false;
+	}
+	return true;
+}
+
+static const int max_items_in_leaf = 4;
+
+class CCompareCentres
+{
+	const std::vector<double> &m_centres;
+	int m_axis;
+public:
+	CCompareCentres(const std::vector<double> &centres, int axis):m_centres(centres), m_axis(axis){}
+	bool operator()(int a, int b)const{return m_centres[a*3+m_axis] < m_centres[b*3+m_axis];}
+};
+
+void CBoxTree::BuildNode(int node_index, const std::vector<double> &centres, int first, int count)
+{
+	CBox box;
+	CBox centre_box;
+	for(int i = first; i < first + count; i++)
+	{
+		box.Insert(m_boxes[m_items[i]]);
+		centre_box.Insert(&centres[m_items[i]*3]);
+	}
+	m_nodes[node_index].m_box = box;
+	m_nodes[node_index].m_first = first;
+	m_nodes[node_index].m_count = count;
+
+	if(count <= max_items_in_leaf)
+	{
+		m_nodes[node_index].m_child = -1;
+		return;
+	}
+
+	// split at the middle item along the longest side
+	int axis = 0;
+	if(centre_box.Height() > centre_box.Width())axis = 1;
+	if(centre_box.Depth() > ((axis == 0) ? centre_box.Width() : centre_box.Height()))axis = 2;
+	int half = count / 2;
+	std::nth_element(m_items.begin() + first, m_items.begin() + first + half, m_items.begin() + first + count, CCompareCentres(centres, axis));
+
+	// the two children are next to each other, so only the first one's index is needed
+	int child = (int)m_nodes.size();
+	m_nodes[node_index].m_child = child;
+	m_nodes.push_back(Node());
+	m_nodes.push_back(Node());
+	BuildNode(child, centres, first, half);
+	BuildNode(child + 1, centres, first + half, count - half);
+}
+
+void CBoxTree::Build(const std::vector<CBox> &boxes)
+{
+	Clear();
+	m_boxes = boxes;
+
+	std::vector<double> centres(boxes.size() * 3);
+	for(size_t i = 0; i<boxes.size(); i++)
+	{
+		if(!boxes[i].m_valid)continue;
+		boxes[i].Centre(&centres[i*3]);
+		m_items.push_back((int)i);
+	}
+
+	if(m_items.size() == 0)return;
+	m_nodes.reserve(m_items.size());
+	m_nodes.push_back(Node());
+	BuildNode(0, centres, 0, (int)m_items.size());
+}
+
+void CBoxTree::Clear()
+{
+	m_nodes.clear();
+	m_items.clear();
+	m_boxes.clear();
+}
+
+void CBoxTree::Find(const CBoxTest &test, std::vector<int> &items)const
+{
+	if(m_nodes.empty())return;
+
+	std::vector<int> stack;
+	stack.push_back(0);
+	while(stack.size() > 0)
+	{
+		const Node &node = m_nodes[stack.back()];
+		stack.pop_back();
+		if(!test.Intersects(node.m_box))continue;
+		if(node.m_child == -1)
+		{
+			for(int i = node.m_first; i < node.m_first + node.m_count; i++)
+			{
+				int item = m_items[i];
+				if(test.Intersects(m_boxes[item]))items.push_back(item);
+			}
+		}
+		else
+		{
+			stack.push_back(node.m_child + 1);
+			stack.push_back(node.m_child);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+// BoxTree.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// something to find boxes with
+class CBoxTest
+{
+public:
+	virtual ~CBoxTest(){}
+	virtual bool Intersects(const CBox &box)const = 0;
+};
+
+// the space which can be seen, using the current OpenGL projection and modelview matrices
+class CFrustum: public CBoxTest
+{
+	double m_planes[6][4]; // a, b, c, d; inside is where a * x + b * y + c * z + d >= 0
+
+public:
+	void SetFromGL();
+	bool Intersects(const CBox &box)const;
+};
+
+// the boxes which come within a distance of an infinite line
+class CLineBoxTest: public CBoxTest
+{
+	double m_start[3];
+	double m_direction[3];
+	double m_radius;
+
+public:
+	CLineBoxTest(const gp_Lin &line, double radius);
+	bool Intersects(const CBox &box)const;
+};
+
+// a bounding volume hierarchy of boxes, each of which is an item index, for finding the items which may be in a region without looking at all of them
+class CBoxTree
+{
+	struct Node
+	{
+		CBox m_box;
+		int m_child; // index of the first of two child nodes, or -1 for a leaf
+		int m_first; // for a leaf, the first of its items in m_items
+		int m_count;
+	};
+
+	std::vector<Node> m_nodes;
+	std::vector<int> m_items; // item indices, in the order of the leaves
+	std::vector<CBox> m_boxes; // for each item
+
+	void BuildNode(int node_index, const std::vector<double> &centres, int first, int count);
+
+public:
+	void Build(const std::vector<CBox> &boxes); // the items are the indices into boxes; items with invalid boxes are left out
+	void Clear();
+	bool IsEmpty()const{return m_nodes.empty();}
+	void Find(const CBoxTest &test, std::vector<int> &items)const; // adds the items whose boxes pass the test
+	const CBox &GetBox(int item)const{return m_boxes[item];}
+};
@@ -41,6 +41,7 @@ public:
 	bool DescendForUndo(){return false;}
 
 	// CShape's virtual functions
+	bool CanPick(){return !m_render_without_OpenCASCADE;}
 	void SetXMLElement(TiXmlElement* element);
 	void SetFromXMLElement(TiXmlElement* pElem);
 
@@ -0,0 +1,120 @@
+// CurvePolyline.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "CurvePolyline.h"
+
+std::vector<double> CCurvePolyline::m_key_buffer;
+
+static std::vector<float>* vertices_for_callback = NULL;
+static unsigned int next_revision = 1;
+
+static void add_vertex(const double* p)
+{
+	vertices_for_callback->push_back((float)p[0]);
+	vertices_for_callback->push_back((float)p[1]);
+	vertices_for_callback->push_back((float)p[2]);
+}
+
+void CCurvePolyline::Update(const HeeksObj* curve, const std::vector<double> &key)
+{
+	double pixels_per_mm = wxGetApp().GetPixelScale();
+	double step = (pixels_per_mm > 0.0) ? floor(log(pixels_per_mm) / log(2.0) * 4.0) : 0.0;
+
+	if(m_key.size() == key.size() + 1 && m_key.back() == step && std::equal(key.begin(), key.end(), m_key.begin()))return;
+
+	m_key = key;
+	m_key.push_back(step);
+	m_vertices.clear();
+	vertices_for_callback = &m_vertices;
+	curve->GetSegments(add_vertex, pow(2.0, (step + 1) / 4.0));
+	m_revision = next_revision++;
+}
+
+void CCurvePolyline::glCommands()const
+{
+	if(m_vertices.size() < 6)return;
+
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, &m_vertices[0]);
+	glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)(m_vertices.size() / 3));
+	glPopClientAttrib();
+}
+
+void CCurveBatch::Add(const CCurvePolyline &polyline, const HeeksColor &col)
+{
+	Entry entry;
+	entry.m_polyline = &polyline;
+	entry.m_revision = polyline.Revision();
+	entry.m_color = col.COLORREF_color();
+	m_new_entries.push_back(entry);
+}
+
+void CCurveBatch::MakeBuffers()
+{
+	Destroy();
+
+	// one set of vertices and line indices for each colour, in the order the colours were first met
+	std::map<long, int> buffer_for_color;
+	std::vector< std::vector<float> > vertices;
+	std::vector< std::vector<unsigned int> > indices;
+	for(std::vector<Entry>::iterator It = m_new_entries.begin(); It != m_new_entries.end(); It++)
+	{
+		const std::vector<float> &points = It->m_polyline->Vertices();
+		if(points.size() < 6)continue;
+
+		std::map<long, int>::iterator FindIt = buffer_for_color.find(It->m_color);
+		if(FindIt == buffer_for_color.end())
+		{
+			FindIt = buffer_for_color.insert(std::make_pair(It->m_color, (int)m_buffers.size())).first;
+			Buffer buffer;
+			buffer.m_color = HeeksColor(It->m_color);
+			buffer.m_buffer = NULL;
+			m_buffers.push_back(buffer);
+			vertices.push_back(std::vector<float>());
+			indices.push_back(std::vector<unsigned int>());
+		}
+
+		std::vector<float> &v = vertices[FindIt->second];
+		std::vector<unsigned int> &i = indices[FindIt->second];
+		unsigned int first = (unsigned int)(v.size() / 3);
+		unsigned int num_points = (unsigned int)(points.size() / 3);
+		v.insert(v.end(), points.begin(), points.end());
+		for(unsigned int j = 1; j < num_points; j++)
+		{
+			i.push_back(first + j - 1);
+			i.push_back(first + j);
+		}
+	}
+
+	std::vector<float> no_normals;
+	for(unsigned int j = 0; j < m_buffers.size(); j++)
+	{
+		m_buffers[j].m_buffer = new CVertexBuffer;
+		m_buffers[j].m_buffer->SetData(vertices[j], no_normals, indices[j]);
+	}
+
+	m_entries.swap(m_new_entries);
+}
+
+void CCurveBatch::glCommands()
+{
+	if(m_new_entries.size() != m_entries.size() || !std::equal(m_new_entries.begin(), m_new_entries.end(), m_entries.begin()))MakeBuffers();
+
+	for(std::vector<Buffer>::iterator It = m_buffers.begin(); It != m_buffers.end(); It++)
+	{
+		wxGetApp().glColorEnsuringContrast(It->m_color);
+		It->m_buffer->Draw(GL_LINES);
+	}
+}
+
+void CCurveBatch::Destroy()
+{
+	for(std::vector<Buffer>::iterator It = m_buffers.begin(); It != m_buffers.end(); It++)
+	{
+		delete It->m_buffer;
+	}
+	m_buffers.clear();
+	m_entries.clear();
+}
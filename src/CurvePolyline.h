@@ -0,0 +1,70 @@
+// CurvePolyline.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "../interface/HeeksColor.h"
+#include "VertexBuffer.h"
+
+// the points a curve is drawn with, made by its GetSegments and kept until the curve changes or the view is zoomed to another step.
+// the steps are a quarter of a doubling of the pixel scale apart, and the points are made for the top of the step, so panning doesn't remake them.
+class CCurvePolyline
+{
+	std::vector<float> m_vertices; // x, y, z of each point of a line strip
+	std::vector<double> m_key; // the key the points were made for, followed by the zoom step
+	unsigned int m_revision; // changed whenever the points are remade
+
+	static std::vector<double> m_key_buffer;
+
+public:
+	CCurvePolyline():m_revision(0){}
+
+	// the curves make their keys in one vector, so drawing doesn't allocate
+	static std::vector<double>& NewKey(){m_key_buffer.clear(); return m_key_buffer;}
+	static void AddToKey(std::vector<double> &key, const gp_XYZ &xyz){key.push_back(xyz.X()); key.push_back(xyz.Y()); key.push_back(xyz.Z());}
+
+	// key is the numbers which decide the curve's shape; the points are remade if it, or the zoom step, differs from last time
+	void Update(const HeeksObj* curve, const std::vector<double> &key);
+	const std::vector<float>& Vertices()const{return m_vertices;}
+	unsigned int Revision()const{return m_revision;}
+	void glCommands()const;
+};
+
+// the curves of a sketch, joined into one buffer of lines for each colour, so a sketch with many curves is drawn with a few calls.
+// the buffers are only remade when the list of curves, their colours, or their points change.
+class CCurveBatch
+{
+	struct Entry
+	{
+		const CCurvePolyline* m_polyline;
+		unsigned int m_revision;
+		long m_color;
+		bool operator==(const Entry& e)const{return m_polyline == e.m_polyline && m_revision == e.m_revision && m_color == e.m_color;}
+	};
+
+	struct Buffer
+	{
+		HeeksColor m_color;
+		CVertexBuffer* m_buffer;
+	};
+
+	std::vector<Entry> m_entries; // what m_buffers were made from
+	std::vector<Entry> m_new_entries; // the curves for this time
+	std::vector<Buffer> m_buffers;
+
+	// not copyable
+	CCurveBatch(const CCurveBatch&);
+	CCurveBatch& operator=(const CCurveBatch&);
+
+	void MakeBuffers();
+
+public:
+	CCurveBatch(){}
+	~CCurveBatch(){Destroy();}
+
+	void Begin(){m_new_entries.clear();}
+	void Add(const CCurvePolyline &polyline, const HeeksColor &col);
+	void glCommands(); // draws the curves added since Begin
+	void Destroy();
+};
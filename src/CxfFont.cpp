@@ -66,37 +66,11 @@ HeeksObj *VectorFont::Glyph::GlyphLine::Sketch( const gp_Pnt & location, const g
 	return(line);
 } // End Sketch() method
 
-void VectorFont::Glyph::GlyphLine::glCommands(
-	const gp_Pnt & starting_point,
-	const bool select,
-	const bool marked,
-	const bool no_color,
-	COrientationModifier *pOrientationModifier,
-	gp_Trsf transformation,
-	const float width ) const
+void VectorFont::Glyph::GlyphLine::GetVertices( std::vector<gp_Pnt> &vertices ) const
 {
-	gp_Pnt from( starting_point );
-	gp_Pnt to( starting_point );
-
-    from.SetX( starting_point.X() + m_x1);
-	from.SetY( starting_point.Y() + m_y1);
-	from.SetZ( starting_point.Z() );
-
-	to.SetX( starting_point.X() + m_x2);
-	to.SetY( starting_point.Y() + m_y2);
-	to.SetZ( starting_point.Z() );
-
-	if (pOrientationModifier)
-	{
-	    from = pOrientationModifier->Transform(transformation, starting_point.Distance(gp_Pnt(0.0,0.0,0.0)), from, width );
-	    to = pOrientationModifier->Transform(transformation, starting_point.Distance(gp_Pnt(0.0,0.0,0.0)), to, width );
-	}
-
-	glBegin(GL_LINE_STRIP);
-	glVertex3d(from.X(), from.Y(), from.Z());
-	glVertex3d(to.X(), to.Y(), to.Z());
-	glEnd();
-} // End glCommands() method
+	vertices.push_back(gp_Pnt(m_x1, m_y1, 0.0));
+	vertices.push_back(gp_Pnt(m_x2, m_y2, 0.0));
+}
 
 
 
@@ -187,24 +161,11 @@ HeeksObj *VectorFont::Glyph::GlyphArc::Sketch( const gp_Pnt & location, const gp
 	return(arc);
 } // End Sketch() method
 
-void VectorFont::Glyph::GlyphArc::glCommands(
-	const gp_Pnt & starting_point,
-	const bool select,
-	const bool marked,
-	const bool no_color,
-	COrientationModifier *pOrientationModifier,
-	gp_Trsf transformation,
-	const float width) const
+void VectorFont::Glyph::GlyphArc::GetVertices( std::vector<gp_Pnt> &vertices ) const
 {
-	glBegin(GL_LINE_STRIP);
-	std::list<gp_Pnt> vertices = Interpolate( starting_point, 20 );
-	for (std::list<gp_Pnt>::iterator l_itVertex = vertices.begin(); l_itVertex != vertices.end(); l_itVertex++)
-	{
-		if (pOrientationModifier) *l_itVertex = pOrientationModifier->Transform(transformation, starting_point.Distance(gp_Pnt(0.0,0.0,0.0)), *l_itVertex, width );
-		glVertex3d(l_itVertex->X(), l_itVertex->Y(), l_itVertex->Z());
-	} // End for
-	glEnd();
-} // End glCommands() method
+	std::list<gp_Pnt> points = Interpolate( gp_Pnt(0.0, 0.0, 0.0), 20 );
+	vertices.insert( vertices.end(), points.begin(), points.end() );
+}
 
 
 /**
@@ -350,6 +311,8 @@ VectorFont::Glyph::Glyph( const std::list<std::string> &cxf_glyph_definition, co
 			throw(std::runtime_error(l_ossError.str().c_str()));
 		} // End switch
 	} // End for
+
+	MakeStrips();
 } // End constructor
 
 VectorFont::Glyph::Glyph( const std::string &hershey_glyph_definition, const double word_space_percentage, const double character_space_percentage )
@@ -403,6 +366,8 @@ VectorFont::Glyph::Glyph( const std::string &hershey_glyph_definition, const dou
 			}
 		}
 	} // End if - then
+
+	MakeStrips();
 } // End constructor
 
 VectorFont::Glyph::~Glyph()
@@ -441,6 +406,10 @@ VectorFont::Glyph & VectorFont::Glyph::operator= ( const VectorFont::Glyph & rhs
 		} // End for
 
 		m_bounding_box = rhs.m_bounding_box;
+		m_word_space_percentage = rhs.m_word_space_percentage;
+		m_character_space_percentage = rhs.m_character_space_percentage;
+		m_vertices = rhs.m_vertices;
+		m_strip_ends = rhs.m_strip_ends;
 	} // End if - then
 
 	return(*this);
@@ -481,6 +450,39 @@ std::list<HeeksObj *> VectorFont::Glyph::GetGraphics( const gp_Pnt & location, c
 } // End Graphics() method
 
 
+void VectorFont::Glyph::MakeStrips()
+{
+	m_vertices.clear();
+	m_strip_ends.clear();
+
+	std::vector<gp_Pnt> vertices;
+	for (GraphicsList_t::const_iterator l_itGraphic = m_graphics_list.begin(); l_itGraphic != m_graphics_list.end(); l_itGraphic++)
+	{
+		vertices.clear();
+		(*l_itGraphic)->GetVertices( vertices );
+		if (vertices.empty()) continue;
+
+		std::vector<gp_Pnt>::const_iterator l_itVertex = vertices.begin();
+		if (! m_strip_ends.empty())
+		{
+			// Carry on with the last strip if this one starts where it finished.
+			if ((m_vertices[m_vertices.size() - 2] == (float) l_itVertex->X()) &&
+				(m_vertices[m_vertices.size() - 1] == (float) l_itVertex->Y()))
+			{
+				m_strip_ends.pop_back();
+				l_itVertex++;
+			}
+		}
+
+		for (; l_itVertex != vertices.end(); l_itVertex++)
+		{
+			m_vertices.push_back( (float) l_itVertex->X() );
+			m_vertices.push_back( (float) l_itVertex->Y() );
+		} // End for
+		m_strip_ends.push_back( (int) m_vertices.size() / 2 );
+	} // End for
+} // End MakeStrips() method
+
 void VectorFont::Glyph::glCommands(
 		const gp_Pnt & starting_point,
 		const bool select,
@@ -490,9 +492,19 @@ void VectorFont::Glyph::glCommands(
 		gp_Trsf transformation,
 		const float width ) const
 {
-	for (GraphicsList_t::const_iterator l_itGraphic = m_graphics_list.begin(); l_itGraphic != m_graphics_list.end(); l_itGraphic++)
+	double distance = starting_point.Distance(gp_Pnt(0.0,0.0,0.0));
+
+	int vertex = 0;
+	for (std::vector<int>::const_iterator l_itEnd = m_strip_ends.begin(); l_itEnd != m_strip_ends.end(); l_itEnd++)
 	{
-		(*l_itGraphic)->glCommands( starting_point, select, marked, no_color, pOrientationModifier, transformation, width );
+		glBegin(GL_LINE_STRIP);
+		for (; vertex < *l_itEnd; vertex++)
+		{
+			gp_Pnt point( starting_point.X() + m_vertices[vertex * 2], starting_point.Y() + m_vertices[vertex * 2 + 1], starting_point.Z() );
+			if (pOrientationModifier) point = pOrientationModifier->Transform(transformation, distance, point, width );
+			glVertex3d(point.X(), point.Y(), point.Z());
+		} // End for
+		glEnd();
 	} // End for
 } // End glCommands() method
 
@@ -547,6 +559,28 @@ void VectorFont::Glyph::glCommands(
 #endif
 
 
+/**
+	The name in a '# Name: ...' comment is all the tokens after the first.
+ */
+static VectorFont::Name_t NameFromComment( const std::vector<wxString> & tokens )
+{
+	VectorFont::Name_t name;
+	for (std::vector<wxString>::const_iterator l_itToken = tokens.begin();
+		l_itToken != tokens.end(); l_itToken++)
+	{
+		if (l_itToken != tokens.begin())
+		{
+			if (name.Length() > 0)
+			{
+				name.Append(_T(" "));
+			}
+			name.Append( *l_itToken );
+		}
+	}
+
+	return(name);
+}
+
 CxfFont::CxfFont( const wxChar *p_szFile, const double word_space_percentage, const double character_space_percentage )
 	: VectorFont(word_space_percentage, character_space_percentage)
 {
@@ -619,20 +653,7 @@ CxfFont::CxfFont( const wxChar *p_szFile, const double word_space_percentage, co
 					}
 					else if (line.find("Name") != line.npos)
 					{
-						// We want all tokens except the first.
-						m_name.Clear();
-						for (std::vector<wxString>::iterator l_itToken = tokens.begin();
-							l_itToken != tokens.end(); l_itToken++)
-						{
-							if (l_itToken != tokens.begin())
-							{
-								if (m_name.Length() > 0)
-								{
-									m_name.Append(_T(" "));
-								}
-								m_name.Append( *l_itToken );
-							}
-						}
+						m_name = NameFromComment( tokens );
 					}
 				}
 				else if ((line.size() > 0) && ((line[0] == 'L') || (line[0] == 'A')))
@@ -662,6 +683,31 @@ CxfFont::CxfFont( const wxChar *p_szFile, const double word_space_percentage, co
 	}
 }
 
+/* static */ bool CxfFont::ReadName( const wxChar *p_szFile, Name_t &name )
+{
+	std::ifstream file(Ttc(p_szFile));
+	if (! file.is_open()) return(false);
+
+	// The comments come before the glyphs, so stop at the first glyph.
+	name = _T("");
+	std::string line;
+	while (std::getline (file,line))
+	{
+		if (line.size() < 5) continue;
+		if (line[0] == '[') break;
+
+		if ((line[0] == '#') &&
+			(line.find("LineSpacingFactor") == line.npos) &&
+			(line.find("LetterSpacing") == line.npos) &&
+			(line.find("Name") != line.npos))
+		{
+			name = NameFromComment( Tokens( wxString::From8BitData(line.c_str()), _T("# \r\t\n:") ) );
+		}
+	}
+
+	return(true);
+}
+
 struct LineEnding : public std::unary_function< char, bool >
 {
 	bool operator()( const char character )
@@ -676,26 +722,9 @@ HersheyFont::HersheyFont( const wxChar *p_szFile, const double word_space_percen
 	: VectorFont(word_space_percentage, character_space_percentage)
 {
 	m_line_spacing_factor = 1.0;
-	m_name = _T("Hershey");
+	m_name = FontName( p_szFile );
 	wxChar character_name = ' ';
 
-	wxString name = p_szFile;
-	int offset = -1;
-	for (offset = name.Find('/'); offset >= 0; offset = name.Find('/'))
-	{
-        if (offset >= 0)	name.Remove(0, offset+1);
-	}
-
-	for (offset = name.Find('\\'); offset >= 0; offset = name.Find('/'))
-	{
-        if (offset >= 0)	name.Remove(0, offset+1);
-	}
-
-	offset = name.Find('.');
-	if (offset >= 0) name.erase( offset, name.Length() - offset );
-
-	m_name = _T("Hershey ") + name;
-
 	std::ifstream file(Ttc(p_szFile));
 	if (file.is_open())
 	{
@@ -744,6 +773,27 @@ HersheyFont::HersheyFont( const wxChar *p_szFile, const double word_space_percen
 
 
 
+/* static */ VectorFont::Name_t HersheyFont::FontName( const wxChar *p_szFile )
+{
+	wxString name = p_szFile;
+	int offset = -1;
+	for (offset = name.Find('/'); offset >= 0; offset = name.Find('/'))
+	{
+        if (offset >= 0)	name.Remove(0, offset+1);
+	}
+
+	for (offset = name.Find('\\'); offset >= 0; offset = name.Find('/'))
+	{
+        if (offset >= 0)	name.Remove(0, offset+1);
+	}
+
+	offset = name.Find('.');
+	if (offset >= 0) name.erase( offset, name.Length() - offset );
+
+	return(_T("Hershey ") + name);
+}
+
+
 HeeksObj *VectorFont::Sketch( const wxString & text, const gp_Trsf & transformation_matrix, const float width, COrientationModifier *pOrientationModifier ) const
 {
     if (pOrientationModifier)
@@ -1067,42 +1117,35 @@ void VectorFonts::Add( const VectorFont::Name_t & directory )
     printf("Within directory %s\n", Ttc( directory.c_str()));
 
 	std::list<wxString> files = GetFileNames( directory.c_str() );
+	int num_found = 0;
 	for (std::list<wxString>::const_iterator l_itFile = files.begin(); l_itFile != files.end(); l_itFile++)
 	{
-	    printf("Looking at %s\n", Ttc(l_itFile->c_str()));
+		FontFile font_file;
+		font_file.m_path = directory + _T("/") + wxString(l_itFile->c_str());
 
-		try {
-			if (CxfFont::ValidExtension( *l_itFile ))
-			{
-				wxString path( directory );
-				path = path + _T("/");
-				path = path + wxString(l_itFile->c_str());
-				CxfFont *pFont = new CxfFont( path.c_str(), m_word_space_percentage, m_character_space_percentage );
-				m_fonts.insert( std::make_pair( pFont->Name(), pFont ) );
-			} // End if - then
-			else if (HersheyFont::ValidExtension( *l_itFile ))
-			{
-				wxString path( directory );
-				path = path + _T("/");
-				path = path + wxString(l_itFile->c_str());
-				HersheyFont *pFont = new HersheyFont( path.c_str(), m_word_space_percentage, m_character_space_percentage );
-				m_fonts.insert( std::make_pair( pFont->Name(), pFont ) );
-			} // End if - then
-		} // End try
-		catch( const std::exception & error)
+		VectorFont::Name_t name;
+		if (CxfFont::ValidExtension( *l_itFile ))
 		{
-			printf("Failed to load font.  Error is %s\n", error.what() );
-		} // End catch
+			if (! CxfFont::ReadName( font_file.m_path.c_str(), name )) continue;
+		} // End if - then
+		else if (HersheyFont::ValidExtension( *l_itFile ))
+		{
+			font_file.m_hershey = true;
+			name = HersheyFont::FontName( font_file.m_path.c_str() );
+		} // End if - then
+		else continue;
+
+		if (m_fonts.insert( std::make_pair( name, font_file ) ).second) num_found++;
 	} // End for
 
-	printf("Read %d vector font files\n", (unsigned)m_fonts.size());
+	printf("Found %d vector font files\n", num_found);
 } // End Add() method
 
 VectorFonts::~VectorFonts()
 {
 	for (Fonts_t::iterator l_itFont = m_fonts.begin(); l_itFont != m_fonts.end(); l_itFont++)
 	{
-		delete l_itFont->second;
+		delete l_itFont->second.m_pFont;
 	} // End for
 	m_fonts.clear();
 }
@@ -1121,12 +1164,30 @@ std::set<VectorFont::Name_t> VectorFonts::FontNames() const
 
 VectorFont *VectorFonts::Font( const VectorFont::Name_t & name ) const
 {
-	for (Fonts_t::const_iterator l_itFont = m_fonts.begin(); l_itFont != m_fonts.end(); l_itFont++)
+	Fonts_t::iterator l_itFont = m_fonts.find( name );
+	if (l_itFont == m_fonts.end()) return(NULL);
+
+	FontFile &font_file = l_itFont->second;
+	if ((font_file.m_pFont == NULL) && (! font_file.m_failed))
 	{
-		if (l_itFont->first == name) return(l_itFont->second);
-	} // End for
+		try {
+			if (font_file.m_hershey)
+			{
+				font_file.m_pFont = new HersheyFont( font_file.m_path.c_str(), m_word_space_percentage, m_character_space_percentage );
+			}
+			else
+			{
+				font_file.m_pFont = new CxfFont( font_file.m_path.c_str(), m_word_space_percentage, m_character_space_percentage );
+			}
+		} // End try
+		catch( const std::exception & error)
+		{
+			printf("Failed to load font %s.  Error is %s\n", Ttc(font_file.m_path.c_str()), error.what() );
+			font_file.m_failed = true;
+		} // End catch
+	} // End if - then
 
-	return(NULL);
+	return(font_file.m_pFont);
 } // End Font() method
 
 void VectorFonts::SetWordSpacePercentage( const double value )
@@ -1134,7 +1195,7 @@ void VectorFonts::SetWordSpacePercentage( const double value )
     m_word_space_percentage = value;
     for (Fonts_t::iterator itFont = m_fonts.begin(); itFont != m_fonts.end(); itFont++)
     {
-        itFont->second->SetWordSpacePercentage(value);
+        if (itFont->second.m_pFont) itFont->second.m_pFont->SetWordSpacePercentage(value);
     }
 }
 
@@ -1143,7 +1204,7 @@ void VectorFonts::SetCharacterSpacePercentage( const double value )
     m_character_space_percentage = value;
     for (Fonts_t::iterator itFont = m_fonts.begin(); itFont != m_fonts.end(); itFont++)
     {
-        itFont->second->SetCharacterSpacePercentage(value);
+        if (itFont->second.m_pFont) itFont->second.m_pFont->SetCharacterSpacePercentage(value);
     }
 }
 
@@ -52,15 +52,9 @@ protected:
 			virtual ~Graphics() {};
 
 			virtual HeeksObj *Sketch( const gp_Pnt & location, const gp_Trsf & transformation_matrix, const float width, COrientationModifier *pOrientationModifier ) const = 0;
-			virtual void glCommands( const gp_Pnt & starting_point,
-									 const bool select,
-									 const bool marked,
-									 const bool no_color,
-									 COrientationModifier *pOrientationModifier,
-									 gp_Trsf transformation,
-									 const float width) const = 0;
 			virtual CBox BoundingBox() const = 0;
 			virtual Graphics *Duplicate() = 0;
+			virtual void GetVertices( std::vector<gp_Pnt> &vertices ) const = 0;	// the polyline which glCommands() draws, relative to the glyph's origin
 		}; // End Graphics class defintion.
 
 		class GlyphLine : public Graphics
@@ -102,15 +96,9 @@ protected:
 			}
 
 		    HeeksObj *Sketch( const gp_Pnt & location, const gp_Trsf & transformation_matrix, const float width, COrientationModifier *pOrientationModifier ) const;
-			void glCommands( const gp_Pnt & starting_point,
-							 const bool select,
-							 const bool marked,
-							 const bool no_color,
-							 COrientationModifier *pOrientationModifier,
-							 gp_Trsf transformation,
-							 const float width ) const;
 			CBox BoundingBox() const { return(m_bounding_box); }
 			Graphics *Duplicate() { return(new GlyphLine(*this)); }
+			void GetVertices( std::vector<gp_Pnt> &vertices ) const;
 
 		private:
 			double m_x1;
@@ -149,14 +137,8 @@ protected:
 			Graphics *Duplicate() { return(new GlyphArc(*this)); }
 
 			HeeksObj *Sketch( const gp_Pnt & location, const gp_Trsf & transformation_matrix, const float width, COrientationModifier *pOrientationModifier ) const;
-			void glCommands( const gp_Pnt & starting_point,
-							 const bool select,
-							 const bool marked,
-							 const bool no_color,
-							 COrientationModifier *pOrientationModifier,
-							 gp_Trsf transformation,
-							 const float width ) const;
 			CBox BoundingBox() const { return(m_bounding_box); }
+			void GetVertices( std::vector<gp_Pnt> &vertices ) const;
 
 			std::list<gp_Pnt> Interpolate(const gp_Pnt & location, const unsigned int number_of_points ) const;
 
@@ -200,6 +182,13 @@ protected:
 		double m_word_space_percentage;
 		double m_character_space_percentage;
 
+		// The graphics as line strips, for glCommands().  m_vertices holds x,y pairs and each
+		// strip ends at the vertex index in m_strip_ends.  Lines that follow on from each other
+		// share a strip and the arcs are already interpolated.
+		std::vector<float> m_vertices;
+		std::vector<int> m_strip_ends;
+
+		void MakeStrips();
 		wxString PrepareStringForConversion( wxString &value ) const;
 		double PointToMM( const double points ) const;
 	}; // End Glyph class definition
@@ -249,6 +238,7 @@ class CxfFont : public VectorFont
 public:
 	CxfFont( const wxChar *p_szFile, const double word_space_percentage, const double character_space_percentage );
 	static bool ValidExtension( const wxString &file_name );
+	static bool ReadName( const wxChar *p_szFile, Name_t &name );	// reads only the comments before the first glyph
 	/* virtual */ gp_Pnt StartingLocation() const { return(gp_Pnt(0.0, 0.0, 0.0)); }
 
 }; // End CxfFont class definition
@@ -259,15 +249,32 @@ class HersheyFont : public VectorFont
 public:
 	HersheyFont( const wxChar *p_szFile, const double word_space_percentage, const double character_space_percentage );
 	static bool ValidExtension( const wxString &file_name );
+	static Name_t FontName( const wxChar *p_szFile );	// the name comes from the file name
 	/* virtual */ gp_Pnt StartingLocation() const { return(gp_Pnt(0.0, BoundingBox().Height()/2.0, 0.0)); }
 
 }; // End CxfFont class definition
 
 
+/**
+	VectorFonts is a catalogue of the font files found in the font directories.  Only the
+	names are read when a directory is added; a font's glyphs are read from its file the
+	first time Font() is asked for it.
+ */
 class VectorFonts
 {
 public:
-	typedef std::map< VectorFont::Name_t, VectorFont * > Fonts_t;
+	class FontFile
+	{
+	public:
+		FontFile() : m_hershey(false), m_pFont(NULL), m_failed(false) { }
+
+		wxString m_path;
+		bool m_hershey;		// otherwise it's a CXF file
+		VectorFont *m_pFont;	// NULL until it's been read
+		bool m_failed;		// don't keep trying to read a file that is broken
+	};
+
+	typedef std::map< VectorFont::Name_t, FontFile > Fonts_t;
 
 	VectorFonts(const VectorFont::Name_t &directory, const double word_space_percentage, const double character_space_percentage);
 	~VectorFonts();
@@ -283,7 +290,7 @@ public:
 	void SetCharacterSpacePercentage( const double value );
 
 private:
-	Fonts_t	m_fonts;
+	mutable Fonts_t	m_fonts;
 	double m_word_space_percentage;
 	double m_character_space_percentage;
 }; // End CxfFonts class definition.
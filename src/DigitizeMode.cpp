@@ -176,104 +176,106 @@ bool DigitizeMode::OnModeChange(void){
 DigitizedPoint DigitizeMode::digitize1(const wxPoint &input_point){
 	gp_Lin ray = wxGetApp().m_current_viewport->m_view_point.SightLine(input_point);
 	std::list<DigitizedPoint> compare_list;
-	MarkedObjectManyOfSame marked_object;
+	std::list<DigitizedPoint> index_points;
+	std::list<HeeksObj*> bottom_objects; // the objects, not including their owners, for end points, intersections and mid points
+	std::list<HeeksObj*> all_objects;
 	if(wxGetApp().digitize_end || wxGetApp().digitize_inters || wxGetApp().digitize_centre || wxGetApp().digitize_midpoint || wxGetApp().digitize_nearest || wxGetApp().digitize_tangent){
-		point_or_window->SetWithPoint(input_point);
-		wxGetApp().m_marked_list->ignore_coords_only = true;
-		wxGetApp().m_marked_list->ObjectsInWindow(point_or_window->box_chosen, &marked_object);
-		wxGetApp().m_marked_list->ignore_coords_only = false;
+		// the snap index has the points and curves near the mouse; only solids, which it doesn't split up, need picking
+		double snap_radius = 10 / wxGetApp().GetPixelScale();
+		std::list<HeeksObj*> curves;
+		bool solid_near = wxGetApp().m_snap_index.Find(ray, snap_radius, index_points, curves);
+		bottom_objects = curves;
+		all_objects = curves;
+
+		if(solid_near){
+			MarkedObjectManyOfSame marked_object;
+			point_or_window->SetWithPoint(input_point);
+			wxGetApp().m_marked_list->ignore_coords_only = true;
+			wxGetApp().m_marked_list->ObjectsInWindow(point_or_window->box_chosen, &marked_object);
+			wxGetApp().m_marked_list->ignore_coords_only = false;
+
+			for(HeeksObj* object = marked_object.GetFirstOfBottomOnly(); object; object = marked_object.Increment()){
+				if(!wxGetApp().m_snap_index.Contains(object))bottom_objects.push_back(object);
+			}
+			for(HeeksObj* object = marked_object.GetFirstOfEverything(); object; object = marked_object.Increment()){
+				if(!wxGetApp().m_snap_index.Contains(object))all_objects.push_back(object);
+			}
+		}
 	}
 	if(wxGetApp().digitize_end){
-		if(marked_object.m_map.size()>0){
-			HeeksObj* object = marked_object.GetFirstOfBottomOnly();
-			while(object){
-				std::list<GripData> vl;
-				object->GetGripperPositionsTransformed(&vl, true);
-				std::list<gp_Pnt> plist;
-				convert_gripdata_to_pnts(vl, plist);
-				for(std::list<gp_Pnt>::iterator It = plist.begin(); It != plist.end(); It++)
-				{
-					gp_Pnt& pnt = *It;
-					compare_list.push_back(DigitizedPoint(pnt, DigitizeEndofType));
-				}
-				object = marked_object.Increment();
+		for(std::list<DigitizedPoint>::iterator It = index_points.begin(); It != index_points.end(); It++){
+			if(It->m_type == DigitizeEndofType)compare_list.push_back(*It);
+		}
+		for(std::list<HeeksObj*>::iterator It = bottom_objects.begin(); It != bottom_objects.end(); It++){
+			HeeksObj* object = *It;
+			if(wxGetApp().m_snap_index.Contains(object))continue;
+			std::list<GripData> vl;
+			object->GetGripperPositionsTransformed(&vl, true);
+			std::list<gp_Pnt> plist;
+			convert_gripdata_to_pnts(vl, plist);
+			for(std::list<gp_Pnt>::iterator It = plist.begin(); It != plist.end(); It++)
+			{
+				gp_Pnt& pnt = *It;
+				compare_list.push_back(DigitizedPoint(pnt, DigitizeEndofType));
 			}
 		}
 	}
 	if(wxGetApp().digitize_inters){
-		if(marked_object.m_map.size()>0){
-			std::list<HeeksObj*> object_list;
-			HeeksObj* object = marked_object.GetFirstOfBottomOnly();
-			while(object){
-				object_list.push_back(object);
-				object = marked_object.Increment();
-			}
-
-			if(object_list.size() > 1)
+		if(bottom_objects.size() > 1)
+		{
+			for(std::list<HeeksObj*>::iterator It = bottom_objects.begin(); It != bottom_objects.end(); It++)
 			{
-				for(std::list<HeeksObj*>::iterator It = object_list.begin(); It != object_list.end(); It++)
+				HeeksObj* object = *It;
+				std::list<HeeksObj*>::iterator It2 = It;
+				It2++;
+				for(; It2 != bottom_objects.end(); It2++)
 				{
-					HeeksObj* object = *It;
-					std::list<HeeksObj*>::iterator It2 = It;
-					It2++;
-					for(; It2 != object_list.end(); It2++)
+					HeeksObj* object2 = *It2;
+					std::list<gp_Pnt> plist;
+					wxGetApp().m_snap_index.GetIntersections(object, object2, plist);
+					for(std::list<gp_Pnt>::iterator It = plist.begin(); It != plist.end(); It++)
 					{
-						HeeksObj* object2 = *It2;
-						std::list<double> rl;
-						if(object->Intersects(object2, &rl))
-						{
-							std::list<gp_Pnt> plist;
-							convert_doubles_to_pnts(rl, plist);
-							for(std::list<gp_Pnt>::iterator It = plist.begin(); It != plist.end(); It++)
-							{
-								gp_Pnt& pnt = *It;
-								compare_list.push_back(DigitizedPoint(pnt, DigitizeIntersType));
-							}
-						}
+						gp_Pnt& pnt = *It;
+						compare_list.push_back(DigitizedPoint(pnt, DigitizeIntersType));
 					}
 				}
 			}
 		}
 	}
 	if(wxGetApp().digitize_midpoint){
-		if(marked_object.m_map.size()>0){
-			HeeksObj* object = marked_object.GetFirstOfBottomOnly();
-			while(object){
-				double p[3];
-				if(object->GetMidPoint(p)){
-					compare_list.push_back(DigitizedPoint(make_point(p), DigitizeMidpointType));
-				}
-				object = marked_object.Increment();
+		for(std::list<DigitizedPoint>::iterator It = index_points.begin(); It != index_points.end(); It++){
+			if(It->m_type == DigitizeMidpointType)compare_list.push_back(*It);
+		}
+		for(std::list<HeeksObj*>::iterator It = bottom_objects.begin(); It != bottom_objects.end(); It++){
+			HeeksObj* object = *It;
+			if(wxGetApp().m_snap_index.Contains(object))continue;
+			double p[3];
+			if(object->GetMidPoint(p)){
+				compare_list.push_back(DigitizedPoint(make_point(p), DigitizeMidpointType));
 			}
 		}
 	}
 	if(wxGetApp().digitize_nearest){
-		if(marked_object.m_map.size()>0){
-			HeeksObj* object = marked_object.GetFirstOfEverything();
-			while(object){
-				double ray_start[3], ray_direction[3];
-				extract(ray.Location(), ray_start);
-				extract(ray.Direction(), ray_direction);
-				double p[3];
-				if(object->FindNearPoint(ray_start, ray_direction, p)){
-					compare_list.push_back(DigitizedPoint(make_point(p), DigitizeNearestType));
-				}
-				object = marked_object.Increment();
+		for(std::list<HeeksObj*>::iterator It = all_objects.begin(); It != all_objects.end(); It++){
+			HeeksObj* object = *It;
+			double ray_start[3], ray_direction[3];
+			extract(ray.Location(), ray_start);
+			extract(ray.Direction(), ray_direction);
+			double p[3];
+			if(object->FindNearPoint(ray_start, ray_direction, p)){
+				compare_list.push_back(DigitizedPoint(make_point(p), DigitizeNearestType));
 			}
 		}
 	}
 	if(wxGetApp().digitize_tangent){
-		if(marked_object.m_map.size()>0){
-			HeeksObj* object = marked_object.GetFirstOfEverything();
-			while(object){
-				double ray_start[3], ray_direction[3];
-				extract(ray.Location(), ray_start);
-				extract(ray.Direction(), ray_direction);
-				double p[3];
-				if(object->FindPossTangentPoint(ray_start, ray_direction, p)){
-					compare_list.push_back(DigitizedPoint(make_point(p), DigitizeTangentType, object));
-				}
-				object = marked_object.Increment();
+		for(std::list<HeeksObj*>::iterator It = all_objects.begin(); It != all_objects.end(); It++){
+			HeeksObj* object = *It;
+			double ray_start[3], ray_direction[3];
+			extract(ray.Location(), ray_start);
+			extract(ray.Direction(), ray_direction);
+			double p[3];
+			if(object->FindPossTangentPoint(ray_start, ray_direction, p)){
+				compare_list.push_back(DigitizedPoint(make_point(p), DigitizeTangentType, object));
 			}
 		}
 	}
@@ -303,7 +305,8 @@ DigitizedPoint DigitizeMode::digitize1(const wxPoint &input_point){
 	}
 	if(wxGetApp().digitize_centre && (min_dist == -1 || min_dist * wxGetApp().GetPixelScale()>5)){
 		gp_Pnt pos;
-		for(HeeksObj* object = marked_object.GetFirstOfEverything(); object != NULL; object = marked_object.Increment()){
+		for(std::list<HeeksObj*>::iterator It = all_objects.begin(); It != all_objects.end(); It++){
+			HeeksObj* object = *It;
 			double p[3], p2[3];
 			int num = object->GetCentrePoints(p, p2);
 			if(num == 1)
@@ -77,6 +77,7 @@ public:
 	void MakeSureMarkingGLListExists();
 	void KillMarkingGLList();
 	void UpdateMarkingGLList(bool marked);
+	void CallMarkingGLList(){if(m_marking_gl_list)glCallList(m_marking_gl_list);}
 };
 
 class FaceToSketchTool:public Tool
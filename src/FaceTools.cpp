@@ -48,6 +48,39 @@ void DrawFaceWithCommands(TopoDS_Face face)
 	glEnd();
 }
 
+void GetFaceTriangles(const TopoDS_Face &face, std::vector<float> &corners)
+{
+	TopLoc_Location L;
+	Handle_Poly_Triangulation facing = BRep_Tool::Triangulation(face,L);
+	if(facing.IsNull())return;
+	gp_Trsf tr = L;
+
+	const TColgp_Array1OfPnt& Nodes = facing->Nodes();
+	const Poly_Array1OfTriangle& triangles = facing->Triangles();
+	bool reversed = (face.Orientation() == TopAbs_REVERSED);
+
+	Standard_Integer nnn = facing->NbTriangles();
+	corners.reserve(corners.size() + nnn * 9);
+	Standard_Integer n[3];
+	for (Standard_Integer nt = 1; nt <= nnn; nt++)
+	{
+		if(reversed)
+			triangles(nt).Get(n[0],n[2],n[1]);
+		else
+			triangles(nt).Get(n[0],n[1],n[2]);
+
+		if (!TriangleIsValid (Nodes(n[0]),Nodes(n[1]),Nodes(n[2])))continue;
+
+		for(int i = 0; i<3; i++)
+		{
+			gp_Pnt v = Nodes(n[i]).Transformed(tr);
+			corners.push_back((float)v.X());
+			corners.push_back((float)v.Y());
+			corners.push_back((float)v.Z());
+		}
+	}
+}
+
 gp_Dir GetFaceNormalAtUV(const TopoDS_Face &face, double u, double v, gp_Pnt *pos){
 	if(face.IsNull()) return gp_Dir(0, 0, 1);
 
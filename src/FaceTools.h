@@ -7,5 +7,6 @@
 void MeshFace(TopoDS_Face face, double pixels_per_mm);
 void DrawFace(TopoDS_Face face,void(*callbackfunc)(const double* x, const double* n), bool just_one_average_normal);
 void DrawFaceWithCommands(TopoDS_Face face);
+void GetFaceTriangles(const TopoDS_Face &face, std::vector<float> &corners); // adds nine floats for each triangle of the face's existing mesh; safe to call from any thread
 gp_Dir GetFaceNormalAtUV(const TopoDS_Face &face, double u, double v, gp_Pnt *pos);
 
@@ -10,6 +10,7 @@
 #include "HeeksFrame.h"
 #include "../interface/HeeksCADInterface.h"
 #include "TreeCanvas.h"
+#include "Shape.h"
 
 extern CHeeksCADInterface heekscad_interface;
 
@@ -27,6 +28,7 @@ BEGIN_EVENT_TABLE(CGraphicsCanvas, wxGLCanvas)
     EVT_SIZE(CGraphicsCanvas::OnSize)
 	EVT_ERASE_BACKGROUND(CGraphicsCanvas::OnEraseBackground)
     EVT_PAINT(CGraphicsCanvas::OnPaint)
+	EVT_IDLE(CGraphicsCanvas::OnIdle)
     EVT_MOUSE_EVENTS(CGraphicsCanvas::OnMouse)
     EVT_MENU_RANGE(ID_FIRST_POP_UP_MENU_TOOL, ID_FIRST_POP_UP_MENU_TOOL + 1000, CGraphicsCanvas::OnMenuEvent)
 	EVT_KEY_DOWN(CGraphicsCanvas::OnKeyDown)
@@ -259,6 +261,16 @@ void CGraphicsCanvas::OnPaint( wxPaintEvent& WXUNUSED(event) )
 	DrawFront();
 }
 
+void CGraphicsCanvas::OnIdle(wxIdleEvent& event)
+{
+	// draw again, to make the finer levels of detail for the solids which were drawn coarsely
+	if(CShape::m_lod_refinement_pending)
+	{
+		CShape::m_lod_refinement_pending = false;
+		Refresh();
+	}
+}
+
 void CGraphicsCanvas::OnSize(wxSizeEvent& event)
 {
     // this is also necessary to update the context on some platforms
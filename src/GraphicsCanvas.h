@@ -59,6 +59,7 @@ public:
     virtual ~CGraphicsCanvas(){};
 
     void OnPaint(wxPaintEvent& event);
+	void OnIdle(wxIdleEvent& event);
     void OnSize(wxSizeEvent& event);
 	void OnEraseBackground(wxEraseEvent& event);
     void OnMouse( wxMouseEvent& event );
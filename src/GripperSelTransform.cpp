@@ -34,13 +34,7 @@ bool GripperSelTransform::OnGripperGrabbed(const std::list<HeeksObj*>& list, boo
 	}
 	if ( m_data.m_type <= GripperTypeObjectScaleXY )
 	{
-		wxGetApp().CreateTransformGLList(list, show_grippers_on_drag);
-		wxGetApp().m_drag_matrix = gp_Trsf();
-		for(It = list.begin(); It != list.end(); It++){
-			HeeksObj* object = *It;
-			if(object->m_visible)wxGetApp().m_hidden_for_drag.push_back(object);
-			object->m_visible = false;
-		}
+		wxGetApp().StartTransformDrag(list, show_grippers_on_drag);
 	}
 	return true;
 }
@@ -104,10 +98,16 @@ void GripperSelTransform::OnGripperMoved( double* from, const double* to ){
 
 void GripperSelTransform::OnGripperReleased ( const double* from, const double* to )
 {
-	wxGetApp().DestroyTransformGLList();
+	if ( m_data.m_type <= GripperTypeObjectScaleXY )
+	{
+		wxGetApp().EndTransformDrag();
+	}
 
 	wxGetApp().StartHistory();
 
+	// the objects which aren't stretched are transformed together, so their solids are transformed in parallel
+	std::list<HeeksObj*> transform_list;
+
 	for ( std::list<HeeksObj *>::iterator It = m_items_marked_at_grab.begin(); It != m_items_marked_at_grab.end(); It++ )
 	{
 		HeeksObj* object = *It;
@@ -132,30 +132,25 @@ void GripperSelTransform::OnGripperReleased ( const double* from, const double*
 			m_data.m_y += shift[1];
 			m_data.m_z += shift[2];
 		}
-		else
+		else if(object)
 		{
-			gp_Trsf mat;
-			double object_m[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
-			if(m_items_marked_at_grab.size() > 0)m_items_marked_at_grab.front()->GetScaleAboutMatrix(object_m);
-			MakeMatrix ( from, to, object_m, mat );
-			double m[16];
-			extract(mat, m );
-			wxGetApp().TransformUndoably(object, m);
+			transform_list.push_back(object);
 		}
 	}
 
-	m_items_marked_at_grab.clear();
-
-	if ( m_data.m_type <= GripperTypeObjectScaleXY )
+	if(transform_list.size() > 0)
 	{
-		for(std::list<HeeksObj*>::iterator It = wxGetApp().m_hidden_for_drag.begin(); It != wxGetApp().m_hidden_for_drag.end(); It++)
-		{
-			HeeksObj* object = *It;
-			object->m_visible = true;
-		}
-		wxGetApp().m_hidden_for_drag.clear();
+		gp_Trsf mat;
+		double object_m[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+		m_items_marked_at_grab.front()->GetScaleAboutMatrix(object_m);
+		MakeMatrix ( from, to, object_m, mat );
+		double m[16];
+		extract(mat, m );
+		wxGetApp().TransformUndoably(transform_list, m);
 	}
 
+	m_items_marked_at_grab.clear();
+
 	{
 		std::list<HeeksObj *>::iterator It;
 		for ( It = m_items_marked_at_grab.begin(); It != m_items_marked_at_grab.end(); It++ )
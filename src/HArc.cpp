@@ -217,7 +217,18 @@ void HArc::GetSegments(void(*callbackfunc)(const double *p), double pixels_per_m
     }
 }
 
-static void glVertexFunction(const double *p){glVertex3d(p[0], p[1], p[2]);}
+
+const CCurvePolyline& HArc::GetPolyline()const
+{
+	std::vector<double> &key = CCurvePolyline::NewKey();
+	CCurvePolyline::AddToKey(key, A.XYZ());
+	CCurvePolyline::AddToKey(key, B.XYZ());
+	CCurvePolyline::AddToKey(key, C.XYZ());
+	CCurvePolyline::AddToKey(key, m_axis.Direction().XYZ());
+	key.push_back(m_radius);
+	m_polyline.Update(this, key);
+	return m_polyline;
+}
 
 void HArc::glCommands(bool select, bool marked, bool no_color){
 	if(!no_color){
@@ -230,9 +241,7 @@ void HArc::glCommands(bool select, bool marked, bool no_color){
 		glLineWidth(2);
 	}
 
-	glBegin(GL_LINE_STRIP);
-	GetSegments(glVertexFunction, wxGetApp().GetPixelScale());
-	glEnd();
+	GetPolyline().glCommands();
 
 	if(marked){
 		glLineWidth(1);
@@ -5,8 +5,11 @@
 #pragma once
 
 #include "EndedObject.h"
+#include "CurvePolyline.h"
 
 class HArc: public EndedObject{
+	mutable CCurvePolyline m_polyline;
+
 public:
 	gp_Ax1 m_axis;
 
@@ -58,4 +61,5 @@ public:
 	bool UsesID(){return true;} 
 	void Reverse();
 	double IncludedAngle()const;
+	const CCurvePolyline& GetPolyline()const;
 };
@@ -98,7 +98,16 @@ void HCircle::GetSegments(void(*callbackfunc)(const double *p), double pixels_pe
     }
 }
 
-static void glVertexFunction(const double *p){glVertex3d(p[0], p[1], p[2]);}
+
+const CCurvePolyline& HCircle::GetPolyline()const
+{
+	std::vector<double> &key = CCurvePolyline::NewKey();
+	CCurvePolyline::AddToKey(key, m_axis.Location().XYZ());
+	CCurvePolyline::AddToKey(key, m_axis.Direction().XYZ());
+	key.push_back(m_radius);
+	m_polyline.Update(this, key);
+	return m_polyline;
+}
 
 void HCircle::glCommands(bool select, bool marked, bool no_color){
 	if(!no_color){
@@ -111,9 +120,7 @@ void HCircle::glCommands(bool select, bool marked, bool no_color){
 		glLineWidth(2);
 	}
 
-	glBegin(GL_LINE_STRIP);
-	GetSegments(glVertexFunction, wxGetApp().GetPixelScale());
-	glEnd();
+	GetPolyline().glCommands();
 
 	if(marked){
 		glLineWidth(1);
@@ -6,10 +6,12 @@
 
 #include "../interface/IdNamedObj.h"
 #include "../interface/HeeksColor.h"
+#include "CurvePolyline.h"
 
 class HCircle: public IdNamedObj{
 private:
 	HeeksColor color;
+	mutable CCurvePolyline m_polyline;
 
 public:
 	gp_Ax1 m_axis;
@@ -58,4 +60,5 @@ public:
 
 	void SetCircle(gp_Circ c);
 	gp_Circ GetCircle() const;
+	const CCurvePolyline& GetPolyline()const;
 };
@@ -13,6 +13,9 @@
 #include "Sketch.h"
 #include "HText.h"
 #include "HeeksConfig.h"
+#include "WorkerPool.h"
+
+#define DXF_ENTITIES_PER_TASK 256
 
 
 // static
@@ -31,7 +34,11 @@ HeeksDxfRead::HeeksDxfRead(const wxChar* filepath, bool undoable) : CDxfRead(Ttc
 	config.Read(_T("LayerNameSuffixesToDiscard"), m_layer_name_suffixes_to_discard);
 
 	m_current_block = NULL;
-	extract(gp_Trsf(), m_ucs_matrix);
+	m_ucs_matrices.resize(16);
+	extract(gp_Trsf(), &m_ucs_matrices[0]);
+	m_layer = 0;
+	m_ucs = 0;
+	m_file_open_matrix = NULL;
 }
 
 HeeksColor *HeeksDxfRead::ActiveColorPtr(Aci_t & aci)
@@ -47,7 +54,46 @@ void HeeksDxfRead::OnReadUCS(const double* ucs_point)
 {
 	gp_Trsf tm;
 	tm.SetTranslation(make_point(ucs_point), gp_Pnt(0, 0, 0));
-	extract(tm, m_ucs_matrix);
+	m_ucs = (int)(m_ucs_matrices.size() / 16);
+	m_ucs_matrices.resize(m_ucs_matrices.size() + 16);
+	extract(tm, &m_ucs_matrices[m_ucs * 16]);
+}
+
+int HeeksDxfRead::CurrentLayer()
+{
+	LayerName_t layer_name = LayerName();
+	std::map<LayerName_t, int>::iterator FindIt = m_layer_indexes.find(layer_name);
+	if(FindIt != m_layer_indexes.end())return FindIt->second;
+
+	Layer layer;
+	layer.m_name = layer_name;
+	layer.m_valid = IsValidLayerName(layer_name);
+	int index = (int)m_layers.size();
+	m_layers.push_back(layer);
+	m_layer_indexes.insert(std::make_pair(layer_name, index));
+	return index;
+}
+
+HeeksDxfRead::Entity& HeeksDxfRead::NewEntity(EntityType type, const double* values, int num_values)
+{
+	Entity entity;
+	entity.m_type = type;
+	entity.m_layer = CurrentLayer();
+	entity.m_ucs = m_ucs;
+	entity.m_block = m_current_block;
+	entity.m_aci = m_aci;
+	entity.m_hidden = false;
+	entity.m_dir = true;
+	entity.m_values = (int)m_values.size();
+	entity.m_ints[0] = entity.m_ints[1] = 0;
+	entity.m_spline = NULL;
+	entity.m_text = NULL;
+	entity.m_inserted_block = NULL;
+	entity.m_object = NULL;
+	entity.m_failed = false;
+	m_values.insert(m_values.end(), values, values + num_values);
+	m_entities.push_back(entity);
+	return m_entities.back();
 }
 
 void HeeksDxfRead::OnReadBlock(const wxString& block_name, const double* base_point)
@@ -78,21 +124,30 @@ void HeeksDxfRead::OnReadInsert(const wxString& block_name, const double* insert
 		HInsert* new_object = new HInsert(block_name, insert_point, rotation_angle);
 		AddObject(new_object);
 #else
-		CSketch* block = m_blocks[b_name];
-		CSketch* block_copy = new CSketch(*block);
-		gp_Trsf tm;
-		tm.SetTranslationPart(make_vector(insert_point));
-		gp_Trsf rm;
-		rm.SetRotation(gp_Ax1(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1)), rotation_angle * 0.01745329251994329);
-		double m[16];
-		extract(tm * rm, m);
-		block_copy->ModifyByMatrix(m);
-		AddObject(block_copy);
+		double values[4] = {insert_point[0], insert_point[1], insert_point[2], rotation_angle};
+		Entity &entity = NewEntity(EntityInsert, values, 4);
+		entity.m_inserted_block = m_blocks[b_name];
 #endif
 		inserted_blocks.insert(b_name);
 	}
 }
 
+void HeeksDxfRead::AddInsert(const Entity& entity)
+{
+	// the block is copied as it is at this point in the file
+	const double* insert_point = &m_values[entity.m_values];
+	double rotation_angle = m_values[entity.m_values + 3];
+	CSketch* block_copy = new CSketch(*entity.m_inserted_block);
+	gp_Trsf tm;
+	tm.SetTranslationPart(make_vector(insert_point));
+	gp_Trsf rm;
+	rm.SetRotation(gp_Ax1(gp_Pnt(0, 0, 0), gp_Dir(0, 0, 1)), rotation_angle * 0.01745329251994329);
+	double m[16];
+	extract(tm * rm, m);
+	block_copy->ModifyByMatrix(m);
+	AddObject(block_copy);
+}
+
 void HeeksDxfRead::OnReadEndBlock()
 {
 	m_current_block = NULL;
@@ -100,58 +155,43 @@ void HeeksDxfRead::OnReadEndBlock()
 
 void HeeksDxfRead::OnReadLine(const double* s, const double* e, bool hidden)
 {
-	HLine* new_object = new HLine(make_point(s), make_point(e), hidden ? (&hidden_color) : ActiveColorPtr(m_aci));
-	AddObject(new_object);
+	double values[6] = {s[0], s[1], s[2], e[0], e[1], e[2]};
+	NewEntity(EntityLine, values, 6).m_hidden = hidden;
 }
 
 void HeeksDxfRead::OnReadPoint(const double* s)
 {
 	if(m_read_points)
 	{
-		HPoint* new_object = new HPoint(make_point(s), ActiveColorPtr(m_aci));
-		AddObject(new_object);
+		NewEntity(EntityPoint, s, 3);
 	}
 }
 
 void HeeksDxfRead::OnReadArc(const double* s, const double* e, const double* c, bool dir, bool hidden)
 {
-	gp_Pnt p0 = make_point(s);
-	gp_Pnt p1 = make_point(e);
-	gp_Dir up(0, 0, 1);
-	if(!dir)up = -up;
-	gp_Pnt pc = make_point(c);
-	gp_Circ circle(gp_Ax2(pc, up), p1.Distance(pc));
-	HArc* new_object = new HArc(p0, p1, circle, hidden ? (&hidden_color) : ActiveColorPtr(m_aci));
-	AddObject(new_object);
+	double values[9] = {s[0], s[1], s[2], e[0], e[1], e[2], c[0], c[1], c[2]};
+	Entity &entity = NewEntity(EntityArc, values, 9);
+	entity.m_dir = dir;
+	entity.m_hidden = hidden;
 }
 
 void HeeksDxfRead::OnReadCircle(const double* s, const double* c, bool dir, bool hidden)
 {
-	gp_Pnt p0 = make_point(s);
-	//gp_Pnt p1 = make_point(e);
-	gp_Dir up(0, 0, 1);
-	if(!dir)up = -up;
-	gp_Pnt pc = make_point(c);
-	gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
-	HCircle* new_object = new HCircle(circle, hidden ? (&hidden_color) : ActiveColorPtr(m_aci));
-	AddObject(new_object);
+	double values[6] = {s[0], s[1], s[2], c[0], c[1], c[2]};
+	Entity &entity = NewEntity(EntityCircle, values, 6);
+	entity.m_dir = dir;
+	entity.m_hidden = hidden;
 }
 
-void HeeksDxfRead::OnReadSpline(TColgp_Array1OfPnt &control, TColStd_Array1OfReal &weight, TColStd_Array1OfReal &knot,TColStd_Array1OfInteger &mult, int degree, bool periodic, bool rational)
+void HeeksDxfRead::OnReadSpline(struct SplineData& sd)
 {
-	try{
-		Geom_BSplineCurve spline(control,weight,knot,mult,degree,periodic,rational);
-		HSpline* new_object = new HSpline(spline, ActiveColorPtr(m_aci));
-		AddObject(new_object);
-	}
-	catch(Standard_Failure)
-	{
-		if (! IgnoreErrors()) throw;	// Re-throw the exception.
-	}
+	m_splines.push_back(sd);
+	NewEntity(EntitySpline, NULL, 0).m_spline = &m_splines.back();
 }
 
-void HeeksDxfRead::OnReadSpline(struct SplineData& sd)
+HeeksObj* HeeksDxfRead::MakeSpline(const SplineData& sd, const HeeksColor* col)const
 {
+	// this throws Standard_Failure if the spline is bad
 	bool closed = (sd.flag & 1) != 0;
 	bool periodic = (sd.flag & 2) != 0;
 	bool rational = (sd.flag & 4) != 0;
@@ -175,12 +215,12 @@ void HeeksDxfRead::OnReadSpline(struct SplineData& sd)
 	std::list<double> knoto;
 	std::list<int> multo;
 
-	std::list<double>::iterator ity = sd.controly.begin();
-	std::list<double>::iterator itz = sd.controlz.begin();
-	std::list<double>::iterator itw = sd.weight.begin();
+	std::list<double>::const_iterator ity = sd.controly.begin();
+	std::list<double>::const_iterator itz = sd.controlz.begin();
+	std::list<double>::const_iterator itw = sd.weight.begin();
 
 	unsigned i=1; //int i=1;
-	for(std::list<double>::iterator itx = sd.controlx.begin(); itx!=sd.controlx.end(); ++itx)
+	for(std::list<double>::const_iterator itx = sd.controlx.begin(); itx!=sd.controlx.end(); ++itx)
 	{
 		gp_Pnt pnt(*itx,*ity,*itz);
 		control.SetValue(i,pnt);
@@ -198,7 +238,7 @@ void HeeksDxfRead::OnReadSpline(struct SplineData& sd)
 
 	i=1;
 	double last_knot = -1;
-	for(std::list<double>::iterator it = sd.knot.begin(); it!=sd.knot.end(); ++it)
+	for(std::list<double>::const_iterator it = sd.knot.begin(); it!=sd.knot.end(); ++it)
 	{
 		if(*it != last_knot)
 		{
@@ -230,18 +270,152 @@ void HeeksDxfRead::OnReadSpline(struct SplineData& sd)
 		++i;
 	}
 
-	OnReadSpline(control, weight, knot, mult, sd.degree, periodic, rational);
+	Geom_BSplineCurve spline(control,weight,knot,mult,sd.degree,periodic,rational);
+	return new HSpline(spline, col);
 }
 
 void HeeksDxfRead::OnReadEllipse(const double* c, double major_radius, double minor_radius, double rotation, double start_angle, double end_angle, bool dir)
 {
+	double values[8] = {c[0], c[1], c[2], major_radius, minor_radius, rotation, start_angle, end_angle};
+	NewEntity(EntityEllipse, values, 8).m_dir = dir;
+}
+
+HeeksObj* HeeksDxfRead::MakeObject(const Entity& entity)const
+{
+	// this mustn't change anything but the new object, it is used on worker threads
+	const double* v = (entity.m_values < (int)m_values.size()) ? &m_values[entity.m_values] : NULL; // splines have no numbers here
+	HeeksColor color(entity.m_aci);
+	const HeeksColor* col = entity.m_hidden ? (&hidden_color) : (&color);
 	gp_Dir up(0, 0, 1);
-	if(!dir)up = -up;
-	gp_Pnt pc = make_point(c);
-	gp_Elips ellipse(gp_Ax2(pc, up), major_radius, minor_radius);
-	ellipse.Rotate(gp_Ax1(pc,up),rotation);
-	HEllipse* new_object = new HEllipse(ellipse, start_angle, end_angle, ActiveColorPtr(m_aci));
-	AddObject(new_object);
+	if(!entity.m_dir)up = -up;
+
+	switch(entity.m_type)
+	{
+	case EntityLine:
+		return new HLine(make_point(v), make_point(&v[3]), col);
+
+	case EntityPoint:
+		return new HPoint(make_point(v), col);
+
+	case EntityArc:
+		{
+			gp_Pnt p0 = make_point(v);
+			gp_Pnt p1 = make_point(&v[3]);
+			gp_Pnt pc = make_point(&v[6]);
+			gp_Circ circle(gp_Ax2(pc, up), p1.Distance(pc));
+			return new HArc(p0, p1, circle, col);
+		}
+
+	case EntityCircle:
+		{
+			gp_Pnt p0 = make_point(v);
+			gp_Pnt pc = make_point(&v[3]);
+			gp_Circ circle(gp_Ax2(pc, up), p0.Distance(pc));
+			return new HCircle(circle, col);
+		}
+
+	case EntityEllipse:
+		{
+			gp_Pnt pc = make_point(v);
+			gp_Elips ellipse(gp_Ax2(pc, up), v[3], v[4]);
+			ellipse.Rotate(gp_Ax1(pc,up),v[5]);
+			return new HEllipse(ellipse, v[6], v[7], col);
+		}
+
+	case EntitySpline:
+		return MakeSpline(*entity.m_spline, col);
+
+	default:
+		// texts, dimensions and inserts are added by AddEntities
+		return NULL;
+	}
+}
+
+void HeeksDxfRead::MakeObjects(size_t begin, size_t end)
+{
+	for(size_t i = begin; i < end; i++)
+	{
+		Entity &entity = m_entities[i];
+		if(!m_layers[entity.m_layer].m_valid)continue;
+		try{
+			entity.m_object = MakeObject(entity);
+		}
+		catch(Standard_Failure)
+		{
+			entity.m_failed = true;
+			continue;
+		}
+		if(entity.m_object)TransformObject(entity.m_object, entity.m_block, entity.m_ucs);
+	}
+}
+
+class CMakeDxfObjectsTask: public CWorkerTask
+{
+	HeeksDxfRead* m_dxf_read;
+	size_t m_begin;
+	size_t m_end;
+
+public:
+	CMakeDxfObjectsTask(HeeksDxfRead* dxf_read, size_t begin, size_t end):m_dxf_read(dxf_read), m_begin(begin), m_end(end){}
+
+	void Run(){m_dxf_read->MakeObjects(m_begin, m_end);}
+};
+
+void HeeksDxfRead::AddEntities()
+{
+	m_file_open_matrix = (wxGetApp().m_in_OpenFile) ? wxGetApp().m_file_open_matrix : NULL;
+
+	// make the objects on all the processors
+	std::vector<CWorkerTask*> tasks;
+	for(size_t begin = 0; begin < m_entities.size(); begin += DXF_ENTITIES_PER_TASK)
+	{
+		size_t end = begin + DXF_ENTITIES_PER_TASK;
+		if(end > m_entities.size())end = m_entities.size();
+		tasks.push_back(new CMakeDxfObjectsTask(this, begin, end));
+	}
+	CWorkerPool::Run(tasks);
+	for(std::vector<CWorkerTask*>::iterator It = tasks.begin(); It != tasks.end(); It++)delete *It;
+
+	// then add them in the order they were in the file, so the result is the same as adding them as they were read
+	CSketch* current_block = m_current_block;
+	for(size_t i = 0; i < m_entities.size(); i++)
+	{
+		Entity &entity = m_entities[i];
+		m_layer = entity.m_layer;
+		m_ucs = entity.m_ucs;
+		m_current_block = entity.m_block;
+
+		if(entity.m_failed && !IgnoreErrors())
+		{
+			for(size_t j = i + 1; j < m_entities.size(); j++)delete m_entities[j].m_object;
+			m_entities.clear();
+			Standard_Failure::Raise("failed to make an object from a DXF entity");
+		}
+
+		switch(entity.m_type)
+		{
+		case EntityText:
+			AddText(entity);
+			break;
+		case EntityDimension:
+			AddDimension(entity);
+			break;
+		case EntityInsert:
+			AddInsert(entity);
+			break;
+		default:
+			if(entity.m_object)PlaceObject(entity.m_object);
+			break;
+		}
+	}
+
+	m_entities.clear();
+	m_values.clear();
+	m_splines.clear();
+	m_texts.clear();
+	m_current_block = current_block;
+	m_layer = CurrentLayer();
+	m_ucs = (int)(m_ucs_matrices.size() / 16) - 1;
 }
 
 	#define Slice(str, start, end) (str.Mid(start, end))
@@ -302,6 +476,23 @@ void HeeksDxfRead::OnReadEllipse(const double* c, double major_radius, double mi
 
 void HeeksDxfRead::OnReadText(const double *point, const double height,  const char* text, int hj, int vj)
 {
+	double values[4] = {point[0], point[1], point[2], height};
+	m_texts.push_back(text);
+	Entity &entity = NewEntity(EntityText, values, 4);
+	entity.m_text = &m_texts.back();
+	entity.m_ints[0] = hj;
+	entity.m_ints[1] = vj;
+}
+
+void HeeksDxfRead::AddText(const Entity& entity)
+{
+	const double* point = &m_values[entity.m_values];
+	double height = m_values[entity.m_values + 3];
+	const char* text = entity.m_text->c_str();
+	int hj = entity.m_ints[0];
+	int vj = entity.m_ints[1];
+	Aci_t aci = entity.m_aci;
+
 	gp_Trsf trsf;
 	trsf.SetTranslation( gp_Vec( gp_Pnt(0,0,0), gp_Pnt(point[0], point[1], point[2]) ) );
 	trsf.SetScaleFactor( height * 1.7 );
@@ -324,7 +515,7 @@ void HeeksDxfRead::OnReadText(const double *point, const double height,  const c
 
 	for(unsigned int i = 0; i<retArray.GetCount(); i++)
 	{
-		HText *new_object = new HText(trsf, retArray[i], ActiveColorPtr(m_aci),
+		HText *new_object = new HText(trsf, retArray[i], ActiveColorPtr(aci),
 #ifndef WIN32
 			NULL, 
 #endif
@@ -336,7 +527,16 @@ void HeeksDxfRead::OnReadText(const double *point, const double height,  const c
 
 void HeeksDxfRead::OnReadDimension(int dimension_type, double angle, double angle2, double angle3, double radius_leader_length, const double *def_point, const double *mid, const double *p1, const double *p2, const double *p3, const double *p4, const double *p5)
 {
-	int type = (dimension_type & 0x07);
+	double values[7] = {angle, def_point[0], def_point[1], def_point[2], mid[0], mid[1], mid[2]};
+	NewEntity(EntityDimension, values, 7).m_ints[0] = dimension_type;
+}
+
+void HeeksDxfRead::AddDimension(const Entity& entity)
+{
+	int type = (entity.m_ints[0] & 0x07);
+	double angle = m_values[entity.m_values];
+	const double* def_point = &m_values[entity.m_values + 1];
+	const double* mid = &m_values[entity.m_values + 4];
 
 	gp_Pnt d = make_point(def_point);
 	gp_Pnt m = make_point(mid);
@@ -401,7 +601,7 @@ bool HeeksDxfRead::IsValidLayerName( const wxString layer_name ) const
 
 void HeeksDxfRead::AddObject(HeeksObj *object)
 {
-	if (! IsValidLayerName(LayerName()))
+	if (! m_layers[m_layer].m_valid)
 	{
 		// This is one of the forbidden layer names.  Discard the
 		// graphics object and move on.
@@ -410,34 +610,43 @@ void HeeksDxfRead::AddObject(HeeksObj *object)
 		return;
 	}
 
-	if(wxGetApp().m_in_OpenFile && wxGetApp().m_file_open_matrix)
+	TransformObject(object, m_current_block, m_ucs);
+	PlaceObject(object);
+}
+
+void HeeksDxfRead::TransformObject(HeeksObj *object, const CSketch* block, int ucs)const
+{
+	if(m_file_open_matrix)
 	{
-		object->ModifyByMatrix(wxGetApp().m_file_open_matrix);
+		object->ModifyByMatrix(m_file_open_matrix);
 	}
 
+	if(block == NULL)object->ModifyByMatrix(&m_ucs_matrices[ucs * 16]);
+}
+
+void HeeksDxfRead::PlaceObject(HeeksObj *object)
+{
+	const LayerName_t &layer_name = m_layers[m_layer].m_name;
+
 	if(m_make_as_sketch)
 	{
 		// Check to see if we've already added a sketch for the current layer name.  If not
 		// then add one now.
 
-		if (m_sketches.find(LayerName()) == m_sketches.end())
+		Sketches_t::iterator FindIt = m_sketches.find(layer_name);
+		if (FindIt == m_sketches.end())
 		{
-			m_sketches.insert( std::make_pair( LayerName(), new CSketch() ) );
+			FindIt = m_sketches.insert( std::make_pair( layer_name, new CSketch() ) ).first;
 		}
 
 		if(m_current_block)m_current_block->Add(object, NULL);
-		else
-		{
-			object->ModifyByMatrix(m_ucs_matrix);
-			m_sketches[LayerName()]->Add( object, NULL );
-		}
+		else FindIt->second->Add( object, NULL );
 	}
 	else
 	{
 		if(m_current_block)m_current_block->Add(object, NULL);
 		else
 		{
-			object->ModifyByMatrix(m_ucs_matrix);
 			if(m_undoable)wxGetApp().AddUndoably(object, NULL, NULL);
 			else wxGetApp().Add( object, NULL );
 		}
@@ -446,6 +655,8 @@ void HeeksDxfRead::AddObject(HeeksObj *object)
 
 void HeeksDxfRead::AddGraphics()
 {
+	AddEntities();
+
 	// add one insert of any blocks which haven't been added at all
 	for(Blocks_t::const_iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
 	{
@@ -468,7 +679,7 @@ void HeeksDxfRead::AddGraphics()
 			if (pSketch->GetNumChildren() > 0)
 			{
 				((CSketch *)l_itSketch->second)->OnEditString( l_itSketch->first.c_str() );
-				l_itSketch->second->ModifyByMatrix(m_ucs_matrix);
+				l_itSketch->second->ModifyByMatrix(&m_ucs_matrices[m_ucs * 16]);
 				if(m_undoable)wxGetApp().AddUndoably(l_itSketch->second, NULL, NULL );
 				else wxGetApp().Add( l_itSketch->second, NULL );
 			} // End if - then
@@ -43,12 +43,69 @@ private:
 	Blocks_t m_blocks;
 	std::set<BlockName_t> inserted_blocks;
 	CSketch* m_current_block;
-	double m_ucs_matrix[16];
 	bool m_undoable;
 
+	enum EntityType
+	{
+		EntityLine,
+		EntityPoint,
+		EntityArc,
+		EntityCircle,
+		EntityEllipse,
+		EntitySpline,
+		EntityText,
+		EntityDimension,
+		EntityInsert
+	};
+
+	// an entity as it was read from the file; the objects are made from these once the whole file has been read
+	struct Entity
+	{
+		EntityType m_type;
+		int m_layer; // index into m_layers
+		int m_ucs; // index of the UCS matrix in m_ucs_matrices
+		CSketch* m_block; // the block it was read in, or NULL
+		Aci_t m_aci;
+		bool m_hidden;
+		bool m_dir;
+		int m_values; // index of its first number in m_values
+		int m_ints[2]; // hj and vj for text, the type for a dimension
+		const SplineData* m_spline;
+		const std::string* m_text;
+		CSketch* m_inserted_block;
+		HeeksObj* m_object; // made by MakeObjects
+		bool m_failed; // Open CASCADE failed to make the object
+	};
+
+	struct Layer
+	{
+		LayerName_t m_name;
+		bool m_valid; // not one of m_layer_name_suffixes_to_discard
+	};
+
+	std::vector<Entity> m_entities;
+	std::vector<double> m_values;
+	std::list<SplineData> m_splines;
+	std::list<std::string> m_texts;
+	std::vector<Layer> m_layers;
+	std::map<LayerName_t, int> m_layer_indexes;
+	std::vector<double> m_ucs_matrices; // 16 numbers for each UCS read
+	int m_layer; // the layer of the objects being added
+	int m_ucs; // the UCS of the objects being added
+	const double* m_file_open_matrix;
+
 	HeeksColor DecodeACI(const int aci);
-	void OnReadSpline(TColgp_Array1OfPnt &control, TColStd_Array1OfReal &weight, TColStd_Array1OfReal &knot,TColStd_Array1OfInteger &mult, int degree, bool periodic, bool rational);
+	HeeksObj* MakeSpline(const SplineData& sd, const HeeksColor* col)const;
 	bool IsValidLayerName( const wxString layer_name ) const;
+	int CurrentLayer();
+	Entity& NewEntity(EntityType type, const double* values, int num_values);
+	HeeksObj* MakeObject(const Entity& entity)const;
+	void TransformObject(HeeksObj *object, const CSketch* block, int ucs)const;
+	void PlaceObject(HeeksObj *object);
+	void AddText(const Entity& entity);
+	void AddDimension(const Entity& entity);
+	void AddInsert(const Entity& entity);
+	void AddEntities();
 
 protected:
 	HeeksColor *ActiveColorPtr(Aci_t & aci);
@@ -77,4 +134,6 @@ public:
 
 	void AddObject(HeeksObj *object);
 	void AddGraphics();
+
+	void MakeObjects(size_t begin, size_t end); // makes the objects for entities begin to end; this is done on worker threads
 };
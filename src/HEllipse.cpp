@@ -111,7 +111,20 @@ void HEllipse::GetSegments(void(*callbackfunc)(const double *p), double pixels_p
     }
 }
 
-static void glVertexFunction(const double *p){glVertex3d(p[0], p[1], p[2]);}
+
+const CCurvePolyline& HEllipse::GetPolyline()const
+{
+	std::vector<double> &key = CCurvePolyline::NewKey();
+	CCurvePolyline::AddToKey(key, C.XYZ());
+	CCurvePolyline::AddToKey(key, m_xdir.XYZ());
+	CCurvePolyline::AddToKey(key, m_zdir.XYZ());
+	key.push_back(m_majr);
+	key.push_back(m_minr);
+	key.push_back(m_start);
+	key.push_back(m_end);
+	m_polyline.Update(this, key);
+	return m_polyline;
+}
 
 void HEllipse::glCommands(bool select, bool marked, bool no_color){
 	if(!no_color){
@@ -124,9 +137,7 @@ void HEllipse::glCommands(bool select, bool marked, bool no_color){
 		glLineWidth(2);
 	}
 
-	glBegin(GL_LINE_STRIP);
-	GetSegments(glVertexFunction, wxGetApp().GetPixelScale());
-	glEnd();
+	GetPolyline().glCommands();
 
 	if(marked){
 		glLineWidth(1);
@@ -6,10 +6,12 @@
 
 #include "../interface/HeeksObj.h"
 #include "../interface/HeeksColor.h"
+#include "CurvePolyline.h"
 
 class HEllipse: public HeeksObj{
 private:
 	HeeksColor color;
+	mutable CCurvePolyline m_polyline;
 
 public:
 	gp_Pnt C;
@@ -53,5 +55,6 @@ public:
 	void WriteXML(TiXmlNode *root);
 	int Intersects(const HeeksObj *object, std::list< double > *rl)const;
 	static HeeksObj* ReadFromXMLElement(TiXmlElement* pElem);
+	const CCurvePolyline& GetPolyline()const;
 };
 
@@ -147,6 +147,15 @@ void HLine::GetTools(std::list<Tool*>* t_list, const wxPoint* p)
 	}
 }
 
+const CCurvePolyline& HLine::GetPolyline()const
+{
+	std::vector<double> &key = CCurvePolyline::NewKey();
+	CCurvePolyline::AddToKey(key, A.XYZ());
+	CCurvePolyline::AddToKey(key, B.XYZ());
+	m_polyline.Update(this, key);
+	return m_polyline;
+}
+
 void HLine::glCommands(bool select, bool marked, bool no_color){
 	if(!no_color){
 		wxGetApp().glColorEnsuringContrast(color);
@@ -157,10 +166,7 @@ void HLine::glCommands(bool select, bool marked, bool no_color){
 		glDepthRange(0, 0);
 		glLineWidth(2);
 	}
-	glBegin(GL_LINES);
-	glVertex3d(A.X(), A.Y(), A.Z());
-	glVertex3d(B.X(), B.Y(), B.Z());
-	glEnd();
+	GetPolyline().glCommands();
 	if(marked){
 		glLineWidth(1);
 		glDepthRange(save_depth_range[0], save_depth_range[1]);
@@ -5,8 +5,11 @@
 #pragma once
 
 #include "EndedObject.h"
+#include "CurvePolyline.h"
 
 class HLine: public EndedObject{
+	mutable CCurvePolyline m_polyline;
+
 public:
 	~HLine(void);
 	HLine(const gp_Pnt &a, const gp_Pnt &b, const HeeksColor* col);
@@ -40,4 +43,5 @@ public:
 	bool Intersects(const gp_Pnt &pnt)const;
 	gp_Vec GetSegmentVector(double fraction);
 	void Reverse();
+	const CCurvePolyline& GetPolyline()const;
 };
@@ -151,7 +151,25 @@ void HSpline::GetSegments(void(*callbackfunc)(const double *p), double pixels_pe
     } 
 }
 
-static void glVertexFunction(const double *p){glVertex3d(p[0], p[1], p[2]);}
+
+const CCurvePolyline& HSpline::GetPolyline()const
+{
+	// the spline can be changed in place, so the key is everything which defines it
+	std::vector<double> &key = CCurvePolyline::NewKey();
+	key.push_back(m_spline->Degree());
+	for(int i = 1; i <= m_spline->NbPoles(); i++)
+	{
+		CCurvePolyline::AddToKey(key, m_spline->Pole(i).XYZ());
+		if(m_spline->IsRational())key.push_back(m_spline->Weight(i));
+	}
+	for(int i = 1; i <= m_spline->NbKnots(); i++)
+	{
+		key.push_back(m_spline->Knot(i));
+		key.push_back(m_spline->Multiplicity(i));
+	}
+	m_polyline.Update(this, key);
+	return m_polyline;
+}
 
 void HSpline::glCommands(bool select, bool marked, bool no_color){
 	if(!no_color){
@@ -164,9 +182,7 @@ void HSpline::glCommands(bool select, bool marked, bool no_color){
 		glLineWidth(2);
 	}
 
-	glBegin(GL_LINE_STRIP);
-	GetSegments(glVertexFunction, wxGetApp().GetPixelScale());
-	glEnd();
+	GetPolyline().glCommands();
 
 	if(marked){
 		glLineWidth(1);
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "EndedObject.h"
+#include "CurvePolyline.h"
 
 // CTangentialArc is used to calculate an arc given desired start ( p0 ), end ( p1 ) and start direction ( v0 )
 class CTangentialArc
@@ -23,6 +24,8 @@ public:
 };
 
 class HSpline: public EndedObject{
+	mutable CCurvePolyline m_polyline;
+
 public:
 	Handle(Geom_BSplineCurve) m_spline;
 
@@ -59,4 +62,5 @@ public:
 	void ToBiarcs(std::list<HeeksObj*> &new_spans, double tolerance)const;
 	static void ToBiarcs(const Handle_Geom_BSplineCurve s, std::list<HeeksObj*> &new_spans, double tolerance, double first_parameter, double last_parameter);
 	void Reverse();
+	const CCurvePolyline& GetPolyline()const;
 };
@@ -0,0 +1,99 @@
+// HeeksBinaryFile.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "HeeksBinaryFile.h"
+
+static const char file_identifier[16] = "HeeksCAD binary";
+
+CBinaryFileWriter::CBinaryFileWriter(const wxChar* filepath):m_chunk_size_pos(0)
+{
+#ifdef __WXMSW__
+	m_ofs.open(filepath, ios::binary);
+#else
+	m_ofs.open(Ttc(filepath), ios::binary);
+#endif
+	if(!m_ofs)return;
+
+	Write(file_identifier, 16);
+	WriteInt(HEEKS_BINARY_FILE_VERSION);
+}
+
+void CBinaryFileWriter::BeginChunk(int type)
+{
+	WriteInt(type);
+	m_chunk_size_pos = m_ofs.tellp();
+	long long size = 0;
+	Write(&size, sizeof(long long));
+}
+
+void CBinaryFileWriter::EndChunk()
+{
+	std::streampos end_pos = m_ofs.tellp();
+	long long size = (long long)(end_pos - m_chunk_size_pos) - (long long)sizeof(long long);
+	m_ofs.seekp(m_chunk_size_pos);
+	Write(&size, sizeof(long long));
+	m_ofs.seekp(end_pos);
+}
+
+void CBinaryFileWriter::WriteString(const std::string &s)
+{
+	WriteInt((int)(s.size()));
+	Write(s.c_str(), s.size());
+}
+
+CBinaryFileReader::CBinaryFileReader(const wxChar* filepath):m_file(filepath), m_version(0), m_pos(0), m_chunk_end(0), m_chunk_type(0)
+{
+	if(!m_file.IsOpen())return;
+	if(m_file.Size() < 16 + sizeof(int))return;
+	if(memcmp(m_file.Data(), file_identifier, 16) != 0)return;
+	int version;
+	memcpy(&version, m_file.Data() + 16, sizeof(int));
+	if(version < 1 || version > HEEKS_BINARY_FILE_VERSION)return;
+	m_version = version;
+	m_pos = 16 + sizeof(int);
+	m_chunk_end = m_pos;
+}
+
+bool CBinaryFileReader::NextChunk()
+{
+	if(m_version == 0)return false;
+
+	// skip whatever wasn't read of the last chunk
+	m_pos = m_chunk_end;
+
+	if(m_file.Size() - m_pos < sizeof(int) + sizeof(long long))return false;
+	memcpy(&m_chunk_type, m_file.Data() + m_pos, sizeof(int));
+	long long size;
+	memcpy(&size, m_file.Data() + m_pos + sizeof(int), sizeof(long long));
+	m_pos += sizeof(int) + sizeof(long long);
+	if(size < 0 || (unsigned long long)size > m_file.Size() - m_pos)return false;
+	m_chunk_end = m_pos + (size_t)size;
+	return true;
+}
+
+const char* CBinaryFileReader::Read(size_t size)
+{
+	if(size > m_chunk_end - m_pos)return NULL;
+	const char* data = m_file.Data() + m_pos;
+	m_pos += size;
+	return data;
+}
+
+bool CBinaryFileReader::Read(void* data, size_t size)
+{
+	const char* p = Read(size);
+	if(p == NULL)return false;
+	memcpy(data, p, size);
+	return true;
+}
+
+bool CBinaryFileReader::ReadString(std::string &s)
+{
+	int size;
+	if(!ReadInt(size) || size < 0)return false;
+	const char* p = Read(size);
+	if(p == NULL)return false;
+	s.assign(p, size);
+	return true;
+}
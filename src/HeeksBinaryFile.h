@@ -0,0 +1,60 @@
+// HeeksBinaryFile.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "MappedFile.h"
+
+// a binary HeeksCAD file is a header, then a list of chunks, each of which is a 4 byte type, an 8 byte size, then the data.
+// numbers are written in the byte order of the machine, like binary STL files; chunks of an unknown type are skipped.
+
+#define HEEKS_BINARY_FILE_VERSION 1
+
+enum BinaryChunkType
+{
+	BinaryChunkXML = 1,	// an object written by WriteXML, as text
+	BinaryChunkStlSolid,	// an STL solid's vertex and index arrays
+	BinaryChunkBREP,	// an index map, as XML text, then a BREP of all the solids
+};
+
+class CBinaryFileWriter
+{
+	ofstream m_ofs;
+	std::streampos m_chunk_size_pos;
+
+public:
+	CBinaryFileWriter(const wxChar* filepath);
+
+	bool IsOpen(){return m_ofs.good();}
+	void BeginChunk(int type);
+	void EndChunk(); // goes back to write the size of the chunk
+	void Write(const void* data, size_t size){m_ofs.write((const char*)data, size);}
+	void WriteInt(int i){Write(&i, sizeof(int));}
+	void WriteString(const std::string &s);
+};
+
+class CBinaryFileReader
+{
+	CMappedFile m_file;
+	int m_version;
+	size_t m_pos;
+	size_t m_chunk_end;
+	int m_chunk_type;
+
+public:
+	CBinaryFileReader(const wxChar* filepath);
+
+	bool IsOpen()const{return m_version != 0;} // false if the file couldn't be read or isn't a binary HeeksCAD file
+	int GetVersion()const{return m_version;}
+
+	bool NextChunk(); // moves to the start of the next chunk, returning false at the end of the file
+	int GetChunkType()const{return m_chunk_type;}
+
+	// these read from the current chunk, and return false, or NULL, if there isn't enough data left in it
+	const char* Read(size_t size); // returns a pointer into the file, valid while the reader exists
+	bool Read(void* data, size_t size);
+	bool ReadInt(int &i){return Read(&i, sizeof(int));}
+	bool ReadString(std::string &s);
+	size_t BytesLeftInChunk()const{return m_chunk_end - m_pos;}
+};
@@ -75,6 +75,10 @@
 #include "Sketch.h"
 #include "BezierCurve.h"
 #include "StlSolid.h"
+#include "WorkerPool.h"
+#include "FaceTools.h"
+#include "XmlElementReader.h"
+#include "HeeksBinaryFile.h"
 #include "HDxf.h"
 #include "svg.h"
 #include "CoordinateSystem.h"
@@ -82,12 +86,12 @@
 #include "HeeksPrintout.h"
 #include "HeeksConfig.h"
 #include "Group.h"
+#include "Instance.h"
 #include "RS274X.h"
 #ifndef WIN32
 #include "CxfFont.h"
 #endif
 #include "AutoSave.h"
-#include <wx/progdlg.h>
 #include "OrientationModifier.h"
 #include "MenuSeparator.h"
 #include "HGear.h"
@@ -186,6 +190,7 @@ HeeksCADapp::HeeksCADapp(): ObjList()
 	m_marked_list = new MarkedList;
 	history = new MainHistory;
 	m_doing_rollback = false;
+	m_changes_held = 0;
 	mouse_wheel_forward_away = true;
 	m_mouse_move_highlighting = true;
 	ctrl_does_rotate = false;
@@ -194,7 +199,8 @@ HeeksCADapp::HeeksCADapp(): ObjList()
 	m_show_datum_coords_system = true;
 	m_datum_coords_system_solid_arrows = true;
 	m_in_OpenFile = false;
-	m_transform_gl_list = 0;
+	m_transform_drag = false;
+	m_transform_drag_grippers = false;
 	m_current_coordinate_system = NULL;
 	m_mark_newly_added_objects = false;
 	m_show_grippers_on_drag = true;
@@ -224,10 +230,12 @@ HeeksCADapp::HeeksCADapp(): ObjList()
 	m_pVectorFont = NULL;	// Default to internal (OpenGL) font.
 #endif
 	m_stl_facet_tolerance = 0.1;
+	m_stl_weld_tolerance = 0.0;
 	m_icon_texture_number = 0;
 	m_extrude_to_solid = true;
 	m_revolve_angle = 360.0;
 	m_stl_save_as_binary = true;
+	m_save_for_older_versions = false;
 	m_mouse_move_highlighting = true;
 	m_highlight_color = HeeksColor(128, 255, 0);
 
@@ -285,6 +293,12 @@ bool HeeksCADapp::OnInit()
 
 	InitialiseLocale();
 
+#ifndef PYHEEKSCAD
+	bool converting = m_batch_convert.ReadCommandLine(argc, argv);
+#else
+	bool converting = false;
+#endif
+
 #ifdef __WXMSW__
 #ifdef _DEBUG
 	wxCrtSetDbgFlag(_CRTDBG_LEAK_CHECK_DF);
@@ -404,9 +418,10 @@ bool HeeksCADapp::OnInit()
 	config.Read(_T("FontPaths"), &m_font_paths, _T("/usr/share/qcad/fonts"));
 #endif
 	config.Read(_T("STLFacetTolerance"), &m_stl_facet_tolerance, 0.1);
+	config.Read(_T("STLWeldTolerance"), &m_stl_weld_tolerance, 0.0);
 
 	config.Read(_T("AutoSaveInterval"), (int *) &m_auto_save_interval, 0);
-	if (m_auto_save_interval > 0)
+	if (m_auto_save_interval > 0 && !converting)
 	{
 		m_pAutoSave = std::auto_ptr<CAutoSave>(new CAutoSave(m_auto_save_interval));
 	} // End if - then
@@ -417,6 +432,7 @@ bool HeeksCADapp::OnInit()
 	config.Read(_T("InputUsesModalDialog"), &m_input_uses_modal_dialog, true);
 	config.Read(_T("DraggingMovesObjects"), &m_dragging_moves_objects, true);
 	config.Read(_T("STLSaveBinary"), &m_stl_save_as_binary, true);
+	config.Read(_T("SaveForOlderVersions"), &m_save_for_older_versions, false);
 	config.Read(_T("MouseMoveHighlighting"), &m_mouse_move_highlighting, true);
 	{
 		int color = HeeksColor(128, 255, 0).COLORREF_color();
@@ -433,6 +449,13 @@ bool HeeksCADapp::OnInit()
 
 	wxImage::AddHandler(new wxPNGHandler);
 	m_current_viewport = NULL;
+
+	if(converting)
+	{
+		// no frame and no graphics; OnRun converts the files and returns
+		m_frame = NULL;
+		return TRUE;
+	}
 #ifdef PYHEEKSCAD
 	m_frame = NULL;
 #else
@@ -594,11 +617,13 @@ void HeeksCADapp::WriteConfig()
 	config.Write(_T("FontPaths"), m_font_paths);
 #endif
 	config.Write(_T("STLFacetTolerance"), m_stl_facet_tolerance);
+	config.Write(_T("STLWeldTolerance"), m_stl_weld_tolerance);
 	config.Write(_T("AutoSaveInterval"), m_auto_save_interval);
 	config.Write(_T("ExtrudeToSolid"), m_extrude_to_solid);
 	config.Write(_T("RevolveAngle"), m_revolve_angle);
 	config.Write(_T("SolidViewMode"), (int)m_solid_view_mode);
 	config.Write(_T("STLSaveBinary"), m_stl_save_as_binary);
+	config.Write(_T("SaveForOlderVersions"), m_save_for_older_versions);
 
 	config.Write(_T("MouseMoveHighlighting"), m_mouse_move_highlighting);
 	config.Write(_T("HighlightColor"), m_highlight_color.COLORREF_color());
@@ -619,7 +644,8 @@ int HeeksCADapp::OnExit(){
 		m_pAutoSave = std::auto_ptr<CAutoSave>(NULL);
 	}
 
-    WriteConfig();
+	// copies converting files leave the settings alone
+	if(!m_batch_convert.Requested())WriteConfig();
 
 	delete history;
 	history = NULL;
@@ -691,6 +717,8 @@ void HeeksCADapp::DestroyLights(void)
 }
 
 void HeeksCADapp::Reset(){
+	m_view_culler.Invalidate();
+	m_snap_index.Clear();
 	m_marked_list->Clear(true);
 	m_marked_list->Reset();
 	std::set<Observer*>::iterator It;
@@ -709,6 +737,7 @@ void HeeksCADapp::Reset(){
 	m_project_filename.Clear();
 	m_project_title.Clear();
 	m_hidden_for_drag.clear();
+	m_transform_drag = false;
 	m_show_grippers_on_drag = true;
 	*m_ruler = HRuler();
 	SetInputMode(m_select_mode);
@@ -719,78 +748,127 @@ void HeeksCADapp::Reset(){
 static bool undoably_for_ReadSTEPFileFromXMLElement = false;
 static HeeksObj* paste_into_for_ReadSTEPFileFromXMLElement = NULL;
 
-static HeeksObj* ReadSTEPFileFromXMLElement(TiXmlElement* pElem)
+static wxString GetTempSTEPFilePath()
+{
+#if wxCHECK_VERSION(3, 0, 0)
+	wxStandardPaths& sp = wxStandardPaths::Get();
+#else
+	wxStandardPaths sp;
+#endif
+	wxFileName temp_file( sp.GetTempDir().c_str(), _T("temp_HeeksCAD_STEP_file.step") );
+	return temp_file.GetFullPath();
+}
+
+static void ReadIndexMap(TiXmlElement* index_map_element, std::map<int, CShapeData> &index_map)
+{
+	// loop through all the child elements, looking for index_pair items
+	for(TiXmlElement* pairElem = TiXmlHandle(index_map_element).FirstChildElement().Element(); pairElem; pairElem = pairElem->NextSiblingElement())
+	{
+		std::string name(pairElem->Value());
+		if(name == std::string("index_pair"))
+		{
+			int index = -1;
+			CShapeData shape_data;
+
+			// get the attributes
+			for(TiXmlAttribute* a = pairElem->FirstAttribute(); a; a = a->Next())
+			{
+				std::string attr_name(a->Name());
+				if(attr_name == std::string("index")){index = a->IntValue();}
+				else if(attr_name == std::string("id")){shape_data.m_id = a->IntValue();}
+				else if(attr_name == std::string("title")){shape_data.m_title.assign(Ctt(a->Value()));}
+				else if(attr_name == std::string("title_from_id")){shape_data.m_title_made_from_id = (a->IntValue() != 0);}
+				else if(attr_name == std::string("solid_type")){shape_data.m_solid_type = (SolidTypeEnum)(a->IntValue());}
+				else if(attr_name == std::string("vis")){shape_data.m_visible = (a->IntValue() != 0);}
+				else shape_data.m_xml_element.SetAttribute(a->Name(), a->Value());
+			}
+
+			// get face ids
+			for(TiXmlElement* faceElem = TiXmlHandle(pairElem).FirstChildElement("face").Element(); faceElem; faceElem = faceElem->NextSiblingElement("face"))
+			{
+				int id = 0;
+				faceElem->Attribute("id", &id);
+				shape_data.m_face_ids.push_back(id);
+			}
+
+			// get edge ids
+			for(TiXmlElement* edgeElem = TiXmlHandle(pairElem).FirstChildElement("edge").Element(); edgeElem; edgeElem = edgeElem->NextSiblingElement("edge"))
+			{
+				int id = 0;
+				edgeElem->Attribute("id", &id);
+				shape_data.m_edge_ids.push_back(id);
+			}
+
+			// get vertex ids
+			for(TiXmlElement* vertexElem = TiXmlHandle(pairElem).FirstChildElement("vertex").Element(); vertexElem; vertexElem = vertexElem->NextSiblingElement("vertex"))
+			{
+				int id = 0;
+				vertexElem->Attribute("id", &id);
+				shape_data.m_vertex_ids.push_back(id);
+			}
+
+			if(index != -1)index_map.insert(std::pair<int, CShapeData>(index, shape_data));
+		}
+	}
+}
+
+// lets OpenCASCADE read from text which is already in memory, without copying it
+class CMemoryStreamBuf: public std::streambuf
+{
+public:
+	CMemoryStreamBuf(const char* data, size_t size)
+	{
+		char* p = const_cast<char*>(data);
+		setg(p, p, p + size);
+	}
+};
+
+static HeeksObj* ReadBREPFileFromXMLElement(TiXmlElement* pElem)
 {
 	std::map<int, CShapeData> index_map;
+	const char* file_text = NULL;
 
-	// get the children ( an index map)
 	for(TiXmlElement* subElem = TiXmlHandle(pElem).FirstChildElement().Element(); subElem; subElem = subElem->NextSiblingElement())
 	{
 		std::string subname(subElem->Value());
 		if(subname == std::string("index_map"))
 		{
-			// loop through all the child elements, looking for index_pair items
-			for(TiXmlElement* subsubElem = TiXmlHandle(subElem).FirstChildElement().Element(); subsubElem; subsubElem = subsubElem->NextSiblingElement())
-			{
-				std::string subsubname(subsubElem->Value());
-				if(subsubname == std::string("index_pair"))
-				{
-					int index = -1;
-					CShapeData shape_data;
-
-					// get the attributes
-					for(TiXmlAttribute* a = subsubElem->FirstAttribute(); a; a = a->Next())
-					{
-						std::string attr_name(a->Name());
-						if(attr_name == std::string("index")){index = a->IntValue();}
-						else if(attr_name == std::string("id")){shape_data.m_id = a->IntValue();}
-						else if(attr_name == std::string("title")){shape_data.m_title.assign(Ctt(a->Value()));}
-						else if(attr_name == std::string("title_from_id")){shape_data.m_title_made_from_id = (a->IntValue() != 0);}
-						else if(attr_name == std::string("solid_type")){shape_data.m_solid_type = (SolidTypeEnum)(a->IntValue());}
-						else if(attr_name == std::string("vis")){shape_data.m_visible = (a->IntValue() != 0);}
-						else shape_data.m_xml_element.SetAttribute(a->Name(), a->Value());
-					}
+			ReadIndexMap(subElem, index_map);
+		}
+		else if(subname == std::string("file_text"))
+		{
+			file_text = subElem->GetText();
+		}
+	}
 
-					// get face ids
-					for(TiXmlElement* faceElem = TiXmlHandle(subsubElem).FirstChildElement("face").Element(); faceElem; faceElem = faceElem->NextSiblingElement("face"))
-					{
-						int id = 0;
-						faceElem->Attribute("id", &id);
-						shape_data.m_face_ids.push_back(id);
-					}
+	if(file_text)
+	{
+		CMemoryStreamBuf buf(file_text, strlen(file_text));
+		std::istream is(&buf);
+		CShape::ImportSolidsBREP(is, undoably_for_ReadSTEPFileFromXMLElement, &index_map, paste_into_for_ReadSTEPFileFromXMLElement);
+	}
 
-					// get edge ids
-					for(TiXmlElement* edgeElem = TiXmlHandle(subsubElem).FirstChildElement("edge").Element(); edgeElem; edgeElem = edgeElem->NextSiblingElement("edge"))
-					{
-						int id = 0;
-						edgeElem->Attribute("id", &id);
-						shape_data.m_edge_ids.push_back(id);
-					}
+	return NULL;
+}
 
-					// get vertex ids
-					for(TiXmlElement* vertexElem = TiXmlHandle(subsubElem).FirstChildElement("vertex").Element(); vertexElem; vertexElem = vertexElem->NextSiblingElement("vertex"))
-					{
-						int id = 0;
-						vertexElem->Attribute("id", &id);
-						shape_data.m_vertex_ids.push_back(id);
-					}
+static HeeksObj* ReadSTEPFileFromXMLElement(TiXmlElement* pElem)
+{
+	std::map<int, CShapeData> index_map;
 
-					if(index != -1)index_map.insert(std::pair<int, CShapeData>(index, shape_data));
-				}
-			}
+	// get the children ( an index map)
+	for(TiXmlElement* subElem = TiXmlHandle(pElem).FirstChildElement().Element(); subElem; subElem = subElem->NextSiblingElement())
+	{
+		std::string subname(subElem->Value());
+		if(subname == std::string("index_map"))
+		{
+			ReadIndexMap(subElem, index_map);
 		}
 		else if(subname == std::string("file_text"))
 		{
 			const char* file_text = subElem->GetText();
 			if(file_text)
 			{
-#if wxCHECK_VERSION(3, 0, 0)
-				wxStandardPaths& sp = wxStandardPaths::Get();
-#else
-				wxStandardPaths sp;
-#endif
-				sp.GetTempDir();
-				wxFileName temp_file(sp.GetTempDir().c_str(), _T("temp_HeeksCAD_STEP_file.step") );
+				wxFileName temp_file(GetTempSTEPFilePath());
 				{
 #if wxUSE_UNICODE
 #ifdef __WXMSW__
@@ -814,13 +892,7 @@ static HeeksObj* ReadSTEPFileFromXMLElement(TiXmlElement* pElem)
 		std::string name(a->Name());
 		if(name == "text")
 		{
-#if wxCHECK_VERSION(3, 0, 0)
-			wxStandardPaths& sp = wxStandardPaths::Get();
-#else
-			wxStandardPaths sp;
-#endif
-			sp.GetTempDir();
-			wxFileName temp_file( sp.GetTempDir().c_str(), _T("temp_HeeksCAD_STEP_file.step") );
+			wxFileName temp_file(GetTempSTEPFilePath());
 			{
 				ofstream ofs(Ttc(temp_file.GetFullPath().c_str()));
 				ofs<<a->Value();
@@ -845,6 +917,7 @@ void HeeksCADapp::InitializeXMLFunctions()
 		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "Image", HImage::ReadFromXMLElement ) );
 		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "Sketch", CSketch::ReadFromXMLElement ) );
 		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "STEP_file", ReadSTEPFileFromXMLElement ) );
+		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "BREP_file", ReadBREPFileFromXMLElement ) );
 		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "STLSolid", CStlSolid::ReadFromXMLElement ) );
 		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "CoordinateSystem", CoordinateSystem::ReadFromXMLElement ) );
 		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "Text", HText::ReadFromXMLElement ) );
@@ -855,6 +928,7 @@ void HeeksCADapp::InitializeXMLFunctions()
 		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "OrientationModifier", COrientationModifier::ReadFromXMLElement ) );
 		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "Gear", HGear::ReadFromXMLElement ) );
 		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "Area", HArea::ReadFromXMLElement ) );
+		xml_read_fn_map.insert( std::pair< std::string, HeeksObj*(*)(TiXmlElement* pElem) > ( "Instance", CInstance::ReadFromXMLElement ) );
 	}
 }
 
@@ -882,6 +956,11 @@ HeeksObj* HeeksCADapp::ReadXMLElement(TiXmlElement* pElem)
 		object = HXml::ReadFromXMLElement(pElem);
 	}
 
+	return UseExistingObject(object);
+}
+
+HeeksObj* HeeksCADapp::UseExistingObject(HeeksObj* object)
+{
 	if (object != NULL)
 	{
 		// Check to see if we already have an object for this type/id pair.  If so, use the existing one instead.
@@ -930,48 +1009,128 @@ void HeeksCADapp::ObjectReadBaseXML(HeeksObj *object, TiXmlElement* element)
 
 void HeeksCADapp::OpenXMLFile(const wxChar *filepath, HeeksObj* paste_into, HeeksObj* paste_before, bool undoably)
 {
-	TiXmlDocument doc(Ttc(filepath));
-	if (!doc.LoadFile())
+	// read one object element at a time, rather than loading the whole document into memory first
+	CXmlElementReader reader(filepath);
+	if(!reader.IsOpen())
 	{
-		if(doc.Error())
-		{
-			wxString msg(filepath);
-			msg << wxT(": ") << Ctt(doc.ErrorDesc());
-			wxMessageBox(msg);
-		}
+		wxString msg(filepath);
+		msg << wxT(": ") << reader.GetError();
+		ReportError(msg);
 		return;
 	}
 
 	undoably_for_ReadSTEPFileFromXMLElement = undoably;
 	paste_into_for_ReadSTEPFileFromXMLElement = paste_into;
+	CInstance::BeginReading();
 
-	TiXmlHandle hDoc(&doc);
-	TiXmlElement* pElem;
-	TiXmlNode* root = &doc;
+	char oldlocale[1000];
+	strcpy(oldlocale, setlocale(LC_NUMERIC, "C"));
 
-	pElem=hDoc.FirstChildElement().Element();
-	if (!pElem) return;
-	std::string name(pElem->Value());
-	if(name == "HeeksCAD_Document")
+	std::list<HeeksObj*> objects;
+	while(TiXmlElement* pElem = reader.NextElement())
+	{
+		HeeksObj* object = ReadXMLElement(pElem);
+		if(object)
+		{
+			objects.push_back(object);
+		}
+	}
+
+	if(!reader.GetError().IsEmpty())
+	{
+		// keep the objects read before the error
+		wxString msg(filepath);
+		msg << wxT(": ") << reader.GetError();
+		ReportError(msg);
+	}
+
+	if(reader.GetDocumentVersion() > HEEKSCAD_DOCUMENT_VERSION)
 	{
-		root = pElem;
+		wxString msg(filepath);
+		msg << wxT(": ") << _("this file was saved by a newer version of HeeksCAD, so some of it may be missing");
+		ReportError(msg);
 	}
 
-	ObjectReferences_t unique_set;
+	AddObjectsFromFile(objects, paste_into, paste_before);
+	setlocale(LC_NUMERIC, oldlocale);
+
+	CGroup::MoveSolidsToGroupsById(this);
+}
+
+void HeeksCADapp::OpenBinaryFile(const wxChar *filepath, HeeksObj* paste_into, HeeksObj* paste_before, bool undoably)
+{
+	CBinaryFileReader reader(filepath);
+	if(!reader.IsOpen())
+	{
+		wxString msg(filepath);
+		msg << wxT(": ") << _("not a HeeksCAD binary file");
+		ReportError(msg);
+		return;
+	}
+
+	undoably_for_ReadSTEPFileFromXMLElement = undoably;
+	paste_into_for_ReadSTEPFileFromXMLElement = paste_into;
+	CInstance::BeginReading();
 
 	char oldlocale[1000];
 	strcpy(oldlocale, setlocale(LC_NUMERIC, "C"));
 
 	std::list<HeeksObj*> objects;
-	for(pElem = root->FirstChildElement(); pElem;	pElem = pElem->NextSiblingElement())
+	while(reader.NextChunk())
 	{
-		HeeksObj* object = ReadXMLElement(pElem);
-		if(object)
+		switch(reader.GetChunkType())
 		{
-			objects.push_back(object);
+		case BinaryChunkXML:
+			{
+				size_t size = reader.BytesLeftInChunk();
+				std::string text(reader.Read(size), size);
+				TiXmlDocument doc;
+				doc.Parse(text.c_str(), 0, TIXML_ENCODING_UTF8);
+				for(TiXmlElement* pElem = doc.FirstChildElement(); pElem; pElem = pElem->NextSiblingElement())
+				{
+					HeeksObj* object = ReadXMLElement(pElem);
+					if(object)objects.push_back(object);
+				}
+			}
+			break;
+
+		case BinaryChunkStlSolid:
+			{
+				HeeksObj* object = UseExistingObject(CStlSolid::ReadFromBinary(reader));
+				if(object)objects.push_back(object);
+			}
+			break;
+
+		case BinaryChunkBREP:
+			{
+				std::map<int, CShapeData> index_map;
+				std::string index_map_text;
+				if(!reader.ReadString(index_map_text))break;
+				TiXmlDocument doc;
+				doc.Parse(index_map_text.c_str(), 0, TIXML_ENCODING_UTF8);
+				if(doc.FirstChildElement())ReadIndexMap(doc.FirstChildElement(), index_map);
+
+				size_t size = reader.BytesLeftInChunk();
+				CMemoryStreamBuf buf(reader.Read(size), size);
+				std::istream is(&buf);
+				CShape::ImportSolidsBREP(is, undoably, &index_map, paste_into);
+			}
+			break;
+
+		default:
+			// written by a later version; skip it
+			break;
 		}
 	}
 
+	AddObjectsFromFile(objects, paste_into, paste_before);
+	setlocale(LC_NUMERIC, oldlocale);
+
+	CGroup::MoveSolidsToGroupsById(this);
+}
+
+void HeeksCADapp::AddObjectsFromFile(const std::list<HeeksObj*> &objects, HeeksObj* paste_into, HeeksObj* paste_before)
+{
 	if(objects.size() > 0)
 	{
 		HeeksObj* add_to = this;
@@ -980,7 +1139,7 @@ void HeeksCADapp::OpenXMLFile(const wxChar *filepath, HeeksObj* paste_into, Heek
 		{
 			HeeksObj* object = *It;
 			object->ReloadPointers();
-
+	
 			while(1)
 			{
 				if(add_to->CanAdd(object) && object->CanAddTo(add_to))
@@ -1021,9 +1180,6 @@ void HeeksCADapp::OpenXMLFile(const wxChar *filepath, HeeksObj* paste_into, Heek
 			}
 		}
 	}
-	setlocale(LC_NUMERIC, oldlocale);
-
-	CGroup::MoveSolidsToGroupsById(this);
 }
 
 /* static */ void HeeksCADapp::OpenSVGFile(const wxChar *filepath)
@@ -1057,10 +1213,18 @@ void HeeksCADapp::OpenXMLFile(const wxChar *filepath, HeeksObj* paste_into, Heek
 		dxf_file.DoRead(HeeksDxfRead::m_ignore_errors);
 	} catch(Standard_Failure)
 	{
-		int response = wxMessageBox(_("OpenCascade failures occured during DXF read processing.  Would you like to import again and ignore the errors?"), _("DXF Read"), wxYES_NO);
-		if (response == wxYES)
+		if(wxGetApp().m_frame == NULL)
 		{
-			try_again = true;
+			// converting files; the errors were already being ignored
+			wxGetApp().ReportError(_("OpenCascade failure occured during DXF read processing"));
+		}
+		else
+		{
+			int response = wxMessageBox(_("OpenCascade failures occured during DXF read processing.  Would you like to import again and ignore the errors?"), _("DXF Read"), wxYES_NO);
+			if (response == wxYES)
+			{
+				try_again = true;
+			}
 		}
 	}
 
@@ -1213,7 +1377,7 @@ bool HeeksCADapp::OpenFile(const wxChar *filepath, bool import_not_open, HeeksOb
 	bool history_started = false;
 	if(import_not_open && paste_into == NULL)
 	{
-		StartHistory();
+		StartTransaction();
 		history_started = true;
 	}
 
@@ -1241,6 +1405,13 @@ bool HeeksCADapp::OpenFile(const wxChar *filepath, bool import_not_open, HeeksOb
 			m_file_open_or_import_type = FileImportTypeHeeks;
 		OpenXMLFile(filepath, paste_into, paste_before, history_started);
 	}
+	else if(wf.EndsWith(_T(".heeksb")))
+	{
+		m_file_open_or_import_type = FileOpenTypeHeeks;
+		if(import_not_open)
+			m_file_open_or_import_type = FileImportTypeHeeks;
+		OpenBinaryFile(filepath, paste_into, paste_before, history_started);
+	}
 	else if(m_fileopen_handlers.find(extension) != m_fileopen_handlers.end())
 	{
 		(m_fileopen_handlers[extension])(filepath);
@@ -1309,7 +1480,7 @@ bool HeeksCADapp::OpenFile(const wxChar *filepath, bool import_not_open, HeeksOb
 	m_file_open_matrix = NULL;
 	m_in_OpenFile = false;
 
-	if(history_started)EndHistory();
+	if(history_started)EndTransaction();
 
 	return open_succeeded;
 }
@@ -1369,6 +1540,14 @@ static void WriteDXFEntity(HeeksObj* object, CDxfWrite& dxf_file, const wxString
 			dxf_file.WriteEllipse(c, maj_r, min_r, rot, 0, 2 * M_PI, dir, Ttc(layer_name.c_str()));
                 }
 		break;
+	case InstanceType:
+		{
+			// written as a copy of its source
+			HeeksObj* copy = ((CInstance*)object)->MakeRealCopy();
+			WriteDXFEntity(copy, dxf_file, parent_layer_name);
+			delete copy;
+		}
+		break;
         case CircleType:
                 {
 			HCircle* cir = (HCircle*)object;
@@ -1413,7 +1592,7 @@ void HeeksCADapp::SaveDXFFile(const wxChar *filepath)
 	if(dxf_file.Failed())
 	{
 		wxString str = wxString(_("couldn't open file")) + filepath;
-		wxMessageBox(str);
+		ReportError(str);
 		return;
 	}
 
@@ -1468,20 +1647,215 @@ static void write_cpp_triangle(const double* x, const double* n)
 	}
 }
 
-class NineFloatsThreeFloats
+// makes the triangles of one object, for writing to a binary STL file
+class CStlTrianglesTask: public CWorkerTask
 {
 public:
-	float x[9];
-	float n[3];
+	HeeksObj* m_object;
+	HeeksObj* m_solid; // the object, or an instance's source
+	const gp_Trsf* m_trsf; // the instance's matrix, or NULL
+	double m_facet_tolerance;
+	std::vector<float> m_corners; // nine floats per triangle
+	bool m_failed;
+
+	CStlTrianglesTask(HeeksObj* object, double facet_tolerance):m_object(object), m_solid(object), m_trsf(NULL), m_facet_tolerance(facet_tolerance), m_failed(false)
+	{
+		if(object->GetType() == InstanceType)
+		{
+			m_solid = ((CInstance*)object)->Source();
+			m_trsf = &((CInstance*)object)->m_trsf;
+		}
+	}
+
+	// solids and STL solids, and instances of them, can be done on any thread, once the solids have been meshed
+	bool CanRunOnAnyThread()const{return m_solid->GetType() == SolidType || m_solid->GetType() == StlSolidType;}
+
+	void Run()
+	{
+		try
+		{
+			if(CanRunOnAnyThread())
+			{
+				if(m_solid->GetType() == StlSolidType)
+				{
+					((CStlSolid*)m_solid)->GetTriangleCorners(m_corners);
+				}
+				else
+				{
+					for(TopExp_Explorer explorer(((CShape*)m_solid)->Shape(), TopAbs_FACE); explorer.More(); explorer.Next())
+					{
+						GetFaceTriangles(TopoDS::Face(explorer.Current()), m_corners);
+					}
+				}
+
+				if(m_trsf)
+				{
+					for(size_t i = 0; i + 2 < m_corners.size(); i += 3)
+					{
+						gp_Pnt p(m_corners[i], m_corners[i+1], m_corners[i+2]);
+						p.Transform(*m_trsf);
+						m_corners[i] = (float)p.X();
+						m_corners[i+1] = (float)p.Y();
+						m_corners[i+2] = (float)p.Z();
+					}
+				}
+			}
+			else
+			{
+				// anything else only has GetTriangles, which uses a callback without any context, so must be on the main thread
+				corners_for_write_binary_triangle = &m_corners;
+				m_object->GetTriangles(write_binary_triangle, m_facet_tolerance);
+				corners_for_write_binary_triangle = NULL;
+			}
+		}
+		catch(...)
+		{
+			m_corners.clear();
+			m_failed = true;
+		}
+	}
+
+	static std::vector<float>* corners_for_write_binary_triangle;
+
+	static void write_binary_triangle(const double* x, const double* n)
+	{
+		for(int i = 0; i<9; i++)corners_for_write_binary_triangle->push_back((float)(x[i]));
+	}
 };
-static std::list<NineFloatsThreeFloats> binary_triangles;
 
-static void write_binary_triangle(const double* x, const double* n)
+std::vector<float>* CStlTrianglesTask::corners_for_write_binary_triangle = NULL;
+
+// meshes a solid's shape, ready for its triangles to be collected
+// meshes some shapes, one after the other.
+// meshing writes triangulations onto the faces and polygons onto the edges, so shapes which share a face or an edge have to be on the same task
+class CMeshShapeTask: public CWorkerTask
+{
+	double m_facet_tolerance;
+
+public:
+	std::vector<TopoDS_Shape> m_shapes;
+	int m_num_failed;
+
+	CMeshShapeTask(double facet_tolerance):m_facet_tolerance(facet_tolerance), m_num_failed(0){}
+
+	void Run()
+	{
+		// clean them all first, so a face shared by two of them isn't meshed twice
+		for(std::vector<TopoDS_Shape>::iterator It = m_shapes.begin(); It != m_shapes.end(); It++)
+		{
+			BRepTools::Clean(*It);
+		}
+
+		for(std::vector<TopoDS_Shape>::iterator It = m_shapes.begin(); It != m_shapes.end(); It++)
+		{
+			try
+			{
+				BRepMesh::Mesh(*It, m_facet_tolerance);
+			}
+			catch(...)
+			{
+				m_num_failed++;
+			}
+		}
+	}
+};
+
+static int FindMeshGroup(std::vector<int> &group, int i)
+{
+	while(group[i] != i)
+	{
+		group[i] = group[group[i]];
+		i = group[i];
+	}
+	return i;
+}
+
+// puts shape i in the same group as the first shape found using sub_shape
+static void JoinMeshGroups(std::vector<int> &group, std::map<const TopoDS_TShape*, int> &first_user, const TopoDS_Shape &sub_shape, int i)
+{
+	const TopoDS_TShape* t = sub_shape.TShape().operator->();
+	std::map<const TopoDS_TShape*, int>::iterator FindIt = first_user.find(t);
+	if(FindIt == first_user.end())
+	{
+		first_user.insert(std::make_pair(t, i));
+		return;
+	}
+
+	int a = FindMeshGroup(group, FindIt->second);
+	int b = FindMeshGroup(group, i);
+	if(a != b)group[b] = a;
+}
+
+static void AddStlTrianglesTasks(HeeksObj* object, double facet_tolerance, std::vector<CStlTrianglesTask*> &tasks)
+{
+	if(object->GetType() == GroupType)
+	{
+		for(HeeksObj* child = object->GetFirstChild(); child; child = object->GetNextChild())
+			AddStlTrianglesTasks(child, facet_tolerance, tasks);
+	}
+	else
+	{
+		tasks.push_back(new CStlTrianglesTask(object, facet_tolerance));
+	}
+}
+
+// works out unit normals from the corners of each facet.
+// these are plain loops over floats, without gp_Vec or exceptions, so the compiler can vectorise them
+static void CalculateFacetNormals(const float* corners, float* normals, unsigned int num_facets)
+{
+	for(unsigned int i = 0; i<num_facets; i++)
+	{
+		const float* t = &corners[i*9];
+		float ax = t[3] - t[0], ay = t[4] - t[1], az = t[5] - t[2];
+		float bx = t[6] - t[0], by = t[7] - t[1], bz = t[8] - t[2];
+		float nx = ay * bz - az * by;
+		float ny = az * bx - ax * bz;
+		float nz = ax * by - ay * bx;
+		float len_sq = nx * nx + ny * ny + nz * nz;
+		float f = (len_sq > 1.0e-30f) ? (1.0f / sqrt(len_sq)) : 0.0f;
+		normals[i*3] = nx * f;
+		normals[i*3+1] = ny * f;
+		normals[i*3+2] = nz * f;
+	}
+}
+
+// writes the facets in chunks of 50 byte records; returns the number written
+static unsigned int WriteBinaryFacets(ofstream &ofs, const std::vector<float> &corners, const double* scale)
 {
-	NineFloatsThreeFloats t;
-	for(int i = 0; i<9; i++)t.x[i] = (float)(x[i]);
-	for(int i = 0; i<3; i++)t.n[i] = (float)(n[i]);
-	binary_triangles.push_back(t);
+	const unsigned int facets_per_chunk = 4096;
+	unsigned int num_facets = (unsigned int)(corners.size() / 9);
+	std::vector<float> normals(facets_per_chunk * 3);
+	std::vector<char> records(facets_per_chunk * 50, 0);
+
+	for(unsigned int first = 0; first < num_facets; first += facets_per_chunk)
+	{
+		unsigned int n = num_facets - first;
+		if(n > facets_per_chunk)n = facets_per_chunk;
+
+		const float* t = &corners[first * 9];
+		CalculateFacetNormals(t, &normals[0], n);
+
+		for(unsigned int i = 0; i<n; i++, t += 9)
+		{
+			char* record = &records[i * 50];
+			memcpy(record, &normals[i*3], 12);
+			if(scale)
+			{
+				float x[9];
+				for(int j = 0; j<9; j++)x[j] = (float)(t[j] * (*scale));
+				memcpy(&record[12], x, 36);
+			}
+			else
+			{
+				memcpy(&record[12], t, 36);
+			}
+			// the last two bytes, the attribute, are always zero
+		}
+
+		ofs.write(&records[0], n * 50);
+	}
+
+	return num_facets;
 }
 
 void HeeksCADapp::SaveSTLFileBinary(const std::list<HeeksObj*>& objects, const wxChar *filepath, double facet_tolerance, double* scale)
@@ -1491,50 +1865,109 @@ void HeeksCADapp::SaveSTLFileBinary(const std::list<HeeksObj*>& objects, const w
 #else
 	ofstream ofs(Ttc(filepath), ios::binary);
 #endif
+	if(!ofs)
+	{
+		wxString str = wxString(_("couldn't open file")) + _T(" - ") + filepath;
+		ReportError(str);
+		return;
+	}
+
+	if(facet_tolerance < 0)facet_tolerance = m_stl_facet_tolerance;
 
 	// write 80 characters ( could be anything )
 	char header[80] = "Binary STL file made with HeeksCAD                                     ";
 	ofs.write(header, 80);
 
-	// get all the triangles
+	// the number of facets is written again at the end, once it is known
+	unsigned int num_facets = 0;
+	ofs.write((char*)(&num_facets), 4);
+
+	std::vector<CStlTrianglesTask*> tasks;
 	for(std::list<HeeksObj*>::const_iterator It = objects.begin(); It != objects.end(); It++)
 	{
-		HeeksObj* object = *It;
-		object->GetTriangles(write_binary_triangle, facet_tolerance < 0 ? m_stl_facet_tolerance : facet_tolerance);
+		AddStlTrianglesTasks(*It, facet_tolerance, tasks);
 	}
 
-	// write the number of facets
-	unsigned int num_facets = binary_triangles.size();
-	ofs.write((char*)(&num_facets), 4);
+	int num_failed = 0;
 
-	for(std::list<NineFloatsThreeFloats>::iterator It = binary_triangles.begin(); It != binary_triangles.end(); It++)
+	// mesh all the solids on all the processors; copies of a solid share its shape, so only mesh that once
 	{
-		NineFloatsThreeFloats t = *It;
+		std::vector<TopoDS_Shape> shapes;
+		std::set<const TopoDS_TShape*> shapes_added;
+		for(std::vector<CStlTrianglesTask*>::iterator It = tasks.begin(); It != tasks.end(); It++)
+		{
+			HeeksObj* object = (*It)->m_solid;
+			if(object->GetType() != SolidType)continue;
+			const TopoDS_Shape &shape = ((CShape*)object)->Shape();
+			if(shape.IsNull())continue;
+			if(!shapes_added.insert(shape.TShape().operator->()).second)continue;
+			shapes.push_back(shape);
+		}
 
-		gp_Pnt p0(t.x[0], t.x[1], t.x[2]);
-		gp_Pnt p1(t.x[3], t.x[4], t.x[5]);
-		gp_Pnt p2(t.x[6], t.x[7], t.x[8]);
-		gp_Vec v1(p0, p1);
-		gp_Vec v2(p0, p2);
-		float n[3] = {0.0f, 0.0f, 1.0f};
-		try
+		// different solids can still share faces and edges, for example the result of a boolean and its inputs, so group those together
+		std::vector<int> group(shapes.size());
+		for(int i = 0; i < (int)shapes.size(); i++)group[i] = i;
+		std::map<const TopoDS_TShape*, int> first_user;
+		for(int i = 0; i < (int)shapes.size(); i++)
 		{
-			gp_Vec norm = (v1 ^ v2).Normalized();
-			n[0] = (float)(norm.X());
-			n[1] = (float)(norm.Y());
-			n[2] = (float)(norm.Z());
+			for(TopExp_Explorer explorer(shapes[i], TopAbs_FACE); explorer.More(); explorer.Next())JoinMeshGroups(group, first_user, explorer.Current(), i);
+			for(TopExp_Explorer explorer(shapes[i], TopAbs_EDGE); explorer.More(); explorer.Next())JoinMeshGroups(group, first_user, explorer.Current(), i);
 		}
-		catch(...)
+
+		std::map<int, CMeshShapeTask*> group_tasks;
+		std::vector<CWorkerTask*> mesh_tasks;
+		for(int i = 0; i < (int)shapes.size(); i++)
 		{
+			int g = FindMeshGroup(group, i);
+			std::map<int, CMeshShapeTask*>::iterator FindIt = group_tasks.find(g);
+			if(FindIt == group_tasks.end())
+			{
+				FindIt = group_tasks.insert(std::make_pair(g, new CMeshShapeTask(facet_tolerance))).first;
+				mesh_tasks.push_back(FindIt->second);
+			}
+			FindIt->second->m_shapes.push_back(shapes[i]);
 		}
 
-		ofs.write((char*)(n), 12);
-		ofs.write((char*)(t.x), 36);
-		short attr = 0;
-		ofs.write((char*)(&attr), 2);
+		CWorkerPool::Run(mesh_tasks);
+		for(std::vector<CWorkerTask*>::iterator It = mesh_tasks.begin(); It != mesh_tasks.end(); It++)
+		{
+			num_failed += ((CMeshShapeTask*)(*It))->m_num_failed;
+			delete *It;
+		}
 	}
 
-	binary_triangles.clear();
+	// collect the triangles a few objects at a time, and write them in the order of the objects, so the whole model is never in memory
+	unsigned int batch_size = CWorkerPool::NumThreads() * 2;
+	for(size_t batch_start = 0; batch_start < tasks.size(); batch_start += batch_size)
+	{
+		size_t batch_end = batch_start + batch_size;
+		if(batch_end > tasks.size())batch_end = tasks.size();
+
+		std::vector<CWorkerTask*> parallel_tasks;
+		for(size_t i = batch_start; i < batch_end; i++)
+		{
+			if(tasks[i]->CanRunOnAnyThread())parallel_tasks.push_back(tasks[i]);
+		}
+		CWorkerPool::Run(parallel_tasks);
+
+		for(size_t i = batch_start; i < batch_end; i++)
+		{
+			CStlTrianglesTask* task = tasks[i];
+			if(!task->CanRunOnAnyThread())task->Run();
+			if(task->m_failed)num_failed++;
+			num_facets += WriteBinaryFacets(ofs, task->m_corners, scale);
+			delete task;
+		}
+	}
+
+	ofs.seekp(80);
+	ofs.write((char*)(&num_facets), 4);
+
+	if(num_failed > 0)
+	{
+		wxString str = wxString::Format(_("%d objects couldn't be made into triangles, so some of them will be missing from %s"), num_failed, filepath);
+		ReportError(str);
+	}
 }
 
 void HeeksCADapp::SaveSTLFileAscii(const std::list<HeeksObj*>& objects, const wxChar *filepath, double facet_tolerance, double* scale)
@@ -1547,7 +1980,7 @@ void HeeksCADapp::SaveSTLFileAscii(const std::list<HeeksObj*>& objects, const wx
 	if(!ofs)
 	{
 		wxString str = wxString(_("couldn't open file")) + _T(" - ") + filepath;
-		wxMessageBox(str);
+		ReportError(str);
 		return;
 	}
 	ofs.imbue(std::locale("C"));
@@ -1583,7 +2016,7 @@ void HeeksCADapp::SaveCPPFile(const std::list<HeeksObj*>& objects, const wxChar
 	if(!ofs)
 	{
 		wxString str = wxString(_("couldn't open file")) + _T(" - ") + filepath;
-		wxMessageBox(str);
+		ReportError(str);
 		return;
 	}
 	ofs.imbue(std::locale("C"));
@@ -1611,7 +2044,7 @@ void HeeksCADapp::SavePyFile(const std::list<HeeksObj*>& objects, const wxChar *
 	if(!ofs)
 	{
 		wxString str = wxString(_("couldn't open file")) + _T(" - ") + filepath;
-		wxMessageBox(str);
+		ReportError(str);
 		return;
 	}
 	ofs.imbue(std::locale("C"));
@@ -1627,6 +2060,55 @@ void HeeksCADapp::SavePyFile(const std::list<HeeksObj*>& objects, const wxChar *
 	}
 }
 
+static void WriteIndexMap(TiXmlElement* index_map_element, std::map<int, CShapeData> &index_map)
+{
+	for(std::map<int, CShapeData>::iterator It = index_map.begin(); It != index_map.end(); It++)
+	{
+		TiXmlElement *index_pair_element = new TiXmlElement( "index_pair" );
+		index_map_element->LinkEndChild( index_pair_element );
+		int index = It->first;
+		CShapeData& shape_data = It->second;
+		index_pair_element->SetAttribute("index", index);
+		index_pair_element->SetAttribute("id", shape_data.m_id);
+		index_pair_element->SetAttribute("title", Ttc(shape_data.m_title));
+		index_pair_element->SetAttribute("title_from_id", (shape_data.m_title_made_from_id?1:0));
+		index_pair_element->SetAttribute("vis", shape_data.m_visible ? 1:0);
+		if(shape_data.m_solid_type != SOLID_TYPE_UNKNOWN)index_pair_element->SetAttribute("solid_type", shape_data.m_solid_type);
+		// get the CShapeData attributes
+		for(TiXmlAttribute* a = shape_data.m_xml_element.FirstAttribute(); a; a = a->Next())
+		{
+			index_pair_element->SetAttribute(a->Name(), a->Value());
+		}
+
+		// write the face ids
+		for(std::list<int>::iterator It = shape_data.m_face_ids.begin(); It != shape_data.m_face_ids.end(); It++)
+		{
+			int id = *It;
+			TiXmlElement *face_id_element = new TiXmlElement( "face" );
+			index_pair_element->LinkEndChild( face_id_element );
+			face_id_element->SetAttribute("id", id);
+		}
+
+		// write the edge ids
+		for(std::list<int>::iterator It = shape_data.m_edge_ids.begin(); It != shape_data.m_edge_ids.end(); It++)
+		{
+			int id = *It;
+			TiXmlElement *edge_id_element = new TiXmlElement( "edge" );
+			index_pair_element->LinkEndChild( edge_id_element );
+			edge_id_element->SetAttribute("id", id);
+		}
+
+		// write the vertex ids
+		for(std::list<int>::iterator It = shape_data.m_vertex_ids.begin(); It != shape_data.m_vertex_ids.end(); It++)
+		{
+			int id = *It;
+			TiXmlElement *vertex_id_element = new TiXmlElement( "vertex" );
+			index_pair_element->LinkEndChild( vertex_id_element );
+			vertex_id_element->SetAttribute("id", id);
+		}
+	}
+}
+
 void HeeksCADapp::SaveXMLFile(const std::list<HeeksObj*>& objects, const wxChar *filepath, bool for_clipboard)
 {
 	// write an xml file
@@ -1641,26 +2123,28 @@ void HeeksCADapp::SaveXMLFile(const std::list<HeeksObj*>& objects, const wxChar
 	TiXmlNode* root = &doc;
 	if(!for_clipboard)
 	{
-		root = new TiXmlElement( "HeeksCAD_Document" );
-		doc.LinkEndChild( root );
+		TiXmlElement* document_element = new TiXmlElement( "HeeksCAD_Document" );
+		document_element->SetAttribute("version", m_save_for_older_versions ? 1 : HEEKSCAD_DOCUMENT_VERSION);
+		doc.LinkEndChild( document_element );
+		root = document_element;
 	}
 
 	// loop through all the objects writing them
 	CShape::m_solids_found = false;
+	CInstance::BeginWriting();
 	for(std::list<HeeksObj*>::const_iterator It = objects.begin(); It != objects.end(); It++)
 	{
 		HeeksObj* object = *It;
 		object->WriteXML(root);
 	}
 
-	// write a step file for all the solids
-	if(CShape::m_solids_found){
+	// write all the solids to a STEP file, then copy that in, so versions without BREP_file can read them
+	if(CShape::m_solids_found && m_save_for_older_versions){
 #if wxCHECK_VERSION(3, 0, 0)
 		wxStandardPaths& sp = wxStandardPaths::Get();
 #else
 		wxStandardPaths sp;
 #endif
-		sp.GetTempDir();
 		wxFileName temp_file( sp.GetTempDir().c_str(), _T("temp_HeeksCAD_STEP_file.step") );
 		std::map<int, CShapeData> index_map;
 		CShape::ExportSolidsFile(objects, temp_file.GetFullPath(), &index_map);
@@ -1669,80 +2153,104 @@ void HeeksCADapp::SaveXMLFile(const std::list<HeeksObj*>& objects, const wxChar
 		root->LinkEndChild( step_file_element );
 
 		// write the index map as a child of step_file
-		{
-			TiXmlElement *index_map_element = new TiXmlElement( "index_map" );
-			step_file_element->LinkEndChild( index_map_element );
-			for(std::map<int, CShapeData>::iterator It = index_map.begin(); It != index_map.end(); It++)
-			{
-				TiXmlElement *index_pair_element = new TiXmlElement( "index_pair" );
-				index_map_element->LinkEndChild( index_pair_element );
-				int index = It->first;
-				CShapeData& shape_data = It->second;
-				index_pair_element->SetAttribute("index", index);
-				index_pair_element->SetAttribute("id", shape_data.m_id);
-				index_pair_element->SetAttribute("title", Ttc(shape_data.m_title));
-				index_pair_element->SetAttribute("title_from_id", (shape_data.m_title_made_from_id?1:0));
-				index_pair_element->SetAttribute("vis", shape_data.m_visible ? 1:0);
-				if(shape_data.m_solid_type != SOLID_TYPE_UNKNOWN)index_pair_element->SetAttribute("solid_type", shape_data.m_solid_type);
-				// get the CShapeData attributes
-				for(TiXmlAttribute* a = shape_data.m_xml_element.FirstAttribute(); a; a = a->Next())
-				{
-					index_pair_element->SetAttribute(a->Name(), a->Value());
-				}
+		TiXmlElement *index_map_element = new TiXmlElement( "index_map" );
+		step_file_element->LinkEndChild( index_map_element );
+		WriteIndexMap(index_map_element, index_map);
 
-				// write the face ids
-				for(std::list<int>::iterator It = shape_data.m_face_ids.begin(); It != shape_data.m_face_ids.end(); It++)
-				{
-					int id = *It;
-					TiXmlElement *face_id_element = new TiXmlElement( "face" );
-					index_pair_element->LinkEndChild( face_id_element );
-					face_id_element->SetAttribute("id", id);
-				}
+#ifdef __WXMSW__
+		ifstream ifs(temp_file.GetFullPath());
+#else
+		ifstream ifs(Ttc(temp_file.GetFullPath().c_str()));
+#endif
+		std::ostringstream step;
+		step << ifs.rdbuf();
+		ifs.close();
+		wxRemoveFile(temp_file.GetFullPath());
 
-				// write the edge ids
-				for(std::list<int>::iterator It = shape_data.m_edge_ids.begin(); It != shape_data.m_edge_ids.end(); It++)
-				{
-					int id = *It;
-					TiXmlElement *edge_id_element = new TiXmlElement( "edge" );
-					index_pair_element->LinkEndChild( edge_id_element );
-					edge_id_element->SetAttribute("id", id);
-				}
+		TiXmlElement *file_text_element = new TiXmlElement( "file_text" );
+		step_file_element->LinkEndChild( file_text_element );
+		TiXmlText *text = new TiXmlText(step.str().c_str());
+		text->SetCDATA(true);
+		file_text_element->LinkEndChild( text );
+	}
 
-				// write the vertex ids
-				for(std::list<int>::iterator It = shape_data.m_vertex_ids.begin(); It != shape_data.m_vertex_ids.end(); It++)
-				{
-					int id = *It;
-					TiXmlElement *vertex_id_element = new TiXmlElement( "vertex" );
-					index_pair_element->LinkEndChild( vertex_id_element );
-					vertex_id_element->SetAttribute("id", id);
-				}
-			}
-		}
+	// write all the solids as one BREP, in memory
+	else if(CShape::m_solids_found){
+		std::map<int, CShapeData> index_map;
+		std::ostringstream brep;
+		CShape::ExportSolidsBREP(objects, brep, &index_map);
 
-		// write the step file as a string attribute of step_file
-		ifstream ifs(Ttc(temp_file.GetFullPath().c_str()));
+		TiXmlElement *brep_file_element = new TiXmlElement( "BREP_file" );
+		root->LinkEndChild( brep_file_element );
 
-		if(!(!ifs)){
-			std::string fstr;
-			char str[1024];
-			while(!(ifs.eof())){
-				ifs.getline(str, 1022);
-				strcat(str, "\n");
-				fstr.append(str);
-				if(!ifs)break;
-			}
+		// write the index map as a child of brep_file
+		TiXmlElement *index_map_element = new TiXmlElement( "index_map" );
+		brep_file_element->LinkEndChild( index_map_element );
+		WriteIndexMap(index_map_element, index_map);
 
-			TiXmlElement *file_text_element = new TiXmlElement( "file_text" );
-			step_file_element->LinkEndChild( file_text_element );
-			TiXmlText *text = new TiXmlText(fstr.c_str());
-			text->SetCDATA(true);
-			file_text_element->LinkEndChild( text );
-		}
+		TiXmlElement *file_text_element = new TiXmlElement( "file_text" );
+		brep_file_element->LinkEndChild( file_text_element );
+		TiXmlText *text = new TiXmlText(brep.str().c_str());
+		text->SetCDATA(true);
+		file_text_element->LinkEndChild( text );
 	}
 
 	doc.SaveFile( Ttc(filepath) );
 }
 
+void HeeksCADapp::SaveBinaryFile(const std::list<HeeksObj*>& objects, const wxChar *filepath)
+{
+	CBinaryFileWriter writer(filepath);
+	if(!writer.IsOpen())
+	{
+		wxString str = wxString(_("couldn't open file")) + _T(" - ") + filepath;
+		ReportError(str);
+		return;
+	}
+
+	// STL solids are written as arrays; everything else is written as its XML text
+	CShape::m_solids_found = false;
+	CInstance::BeginWriting();
+	for(std::list<HeeksObj*>::const_iterator It = objects.begin(); It != objects.end(); It++)
+	{
+		HeeksObj* object = *It;
+		if(object->GetType() == StlSolidType)
+		{
+			((CStlSolid*)object)->WriteBinary(writer);
+			continue;
+		}
+
+		TiXmlDocument doc;
+		object->WriteXML(&doc);
+		if(doc.FirstChild() == NULL)continue;
+		TiXmlPrinter printer;
+		printer.SetStreamPrinting();
+		doc.Accept(&printer);
+		writer.BeginChunk(BinaryChunkXML);
+		writer.Write(printer.CStr(), printer.Size());
+		writer.EndChunk();
+	}
+
+	// write all the solids as one BREP
+	if(CShape::m_solids_found){
+		std::map<int, CShapeData> index_map;
+		std::ostringstream brep;
+		CShape::ExportSolidsBREP(objects, brep, &index_map);
+
+		TiXmlElement index_map_element( "index_map" );
+		WriteIndexMap(&index_map_element, index_map);
+		TiXmlPrinter printer;
+		printer.SetStreamPrinting();
+		index_map_element.Accept(&printer);
+
+		writer.BeginChunk(BinaryChunkBREP);
+		writer.WriteString(printer.Str());
+		const std::string &brep_text = brep.str();
+		writer.Write(brep_text.c_str(), brep_text.size());
+		writer.EndChunk();
+	}
+}
+
 bool HeeksCADapp::SaveProject(const bool force_dialog)
 {
 	if(GetProjectFileName().IsOk())
@@ -1779,6 +2287,17 @@ bool HeeksCADapp::SaveFile(const wxChar *filepath, bool use_dialog, bool update_
 
 		SaveXMLFile(filepath);
 	}
+	else if(wf.EndsWith(_T(".heeksb")))
+	{
+		// call external OnSave functions
+		for(std::list< void(*)(bool) >::iterator It = m_on_save_callbacks.begin(); It != m_on_save_callbacks.end(); It++)
+		{
+			void(*callbackfunc)(bool) = *It;
+			(*callbackfunc)(false);
+		}
+
+		SaveBinaryFile(m_objects, filepath);
+	}
 	else if(wf.EndsWith(_T(".dxf")))
 	{
 		SaveDXFFile(filepath);
@@ -1818,6 +2337,9 @@ bool HeeksCADapp::SaveFile(const wxChar *filepath, bool use_dialog, bool update_
 
 void HeeksCADapp::Repaint(bool soon)
 {
+	// something may have changed size
+	m_view_culler.Invalidate();
+
 #ifdef PYHEEKSCAD
 	if(m_current_viewport)
 	{
@@ -1825,6 +2347,7 @@ void HeeksCADapp::Repaint(bool soon)
 		if(soon)m_current_viewport->m_need_update = true;
 	}
 #else
+	if(m_frame == NULL)return; // converting files
 	if(soon)m_frame->m_graphics->RefreshSoon();
 	else m_frame->m_graphics->Refresh();
 #endif
@@ -1832,6 +2355,7 @@ void HeeksCADapp::Repaint(bool soon)
 
 void HeeksCADapp::RecalculateGLLists()
 {
+	m_view_culler.Invalidate();
 	for(HeeksObj* object = GetFirstChild(); object; object = GetNextChild()){
 		object->KillGLLists();
 	}
@@ -1898,11 +2422,18 @@ void HeeksCADapp::glCommandsAll(const CViewPoint &view_point)
 
 	std::list<HeeksObj*> after_others_objects;
 
+	// don't draw objects which are off the screen
+	m_view_culler.BeginDrawing(m_objects);
+
+	// solids make their finer levels of detail for a limited time in each frame
+	CShape::BeginLODFrame();
+
 	for(std::list<HeeksObj*>::iterator It=m_objects.begin(); It!=m_objects.end() ;It++)
 	{
 		HeeksObj* object = *It;
 		if(object->OnVisibleLayer() && object->m_visible)
 		{
+			if(m_view_culler.IsCulled(object))continue;
 			if(object->DrawAfterOthers())after_others_objects.push_back(object);
 			else
 			{
@@ -1918,6 +2449,8 @@ void HeeksCADapp::glCommandsAll(const CViewPoint &view_point)
 		object->glCommands(false, m_marked_list->ObjectMarked(object), false);
 	}
 
+	m_view_culler.EndDrawing();
+
 	glDisable(GL_POLYGON_OFFSET_FILL);
 	for(std::list< void(*)() >::iterator It = m_on_glCommands_list.begin(); It != m_on_glCommands_list.end(); It++)
 	{
@@ -1926,14 +2459,27 @@ void HeeksCADapp::glCommandsAll(const CViewPoint &view_point)
 	}
 	glEnable(GL_POLYGON_OFFSET_FILL);
 
-	input_mode_object->OnRender();
-	if(m_transform_gl_list)
+	if(input_mode_object)input_mode_object->OnRender(); // there is none when drawing pictures without a window
+	if(m_transform_drag)
 	{
+		// the dragged objects use their own display lists and vertex buffers, so nothing is remade while dragging
         glPushMatrix();
 		double m[16];
 		extract_transposed(m_drag_matrix, m);
 		glMultMatrixd(m);
-		glCallList(m_transform_gl_list);
+		for(std::list<HeeksObj*>::iterator It = m_hidden_for_drag.begin(); It != m_hidden_for_drag.end(); It++)
+		{
+			HeeksObj* object = *It;
+			object->m_visible = true;
+			object->glCommands(false, true, false);
+			object->m_visible = false;
+		}
+		if(m_transform_drag_grippers)
+		{
+			glDisable(GL_DEPTH_TEST);
+			m_marked_list->GrippersGLCommands(false, false);
+			glEnable(GL_DEPTH_TEST);
+		}
 		glPopMatrix();
 	}
 
@@ -2005,6 +2551,7 @@ void HeeksCADapp::glCommands(bool select, bool marked, bool no_color)
 		HeeksObj* object = *It;
 		if(object->OnVisibleLayer() && object->m_visible)
 		{
+			if(m_view_culler.IsCulled(object))continue;
 			if(select)glPushName(object->GetIndex());
 			object->glCommands(select, marked || m_marked_list->ObjectMarked(object), no_color);
 			if(select)glPopName();
@@ -2277,7 +2824,9 @@ void HeeksCADapp::DoUndoable(Undoable *u)
 bool HeeksCADapp::RollBack(void)
 {
 	m_doing_rollback = true;
+	HoldChanges();
 	bool result = history->InternalRollBack();
+	ReleaseChanges();
 	m_doing_rollback = false;
 	return result;
 }
@@ -2295,7 +2844,9 @@ bool HeeksCADapp::CanRedo(void)
 bool HeeksCADapp::RollForward(void)
 {
 	m_doing_rollback = true;
+	HoldChanges();
 	bool result = history->InternalRollForward();
+	ReleaseChanges();
 	m_doing_rollback = false;
 	return result;
 }
@@ -2310,6 +2861,88 @@ void HeeksCADapp::EndHistory(void)
 	history->EndHistory();
 }
 
+void HeeksCADapp::StartTransaction()
+{
+	StartHistory();
+	HoldChanges();
+}
+
+void HeeksCADapp::EndTransaction(void)
+{
+	EndHistory();
+	ReleaseChanges();
+}
+
+void HeeksCADapp::HoldChanges()
+{
+	if(m_changes_held == 0)ObserversFreeze();
+	m_changes_held++;
+}
+
+void HeeksCADapp::HoldChange(HeeksObj* object, HeldChange change)
+{
+	std::map<HeeksObj*, HeldChange>::iterator FindIt = m_held_changes.find(object);
+	if(FindIt == m_held_changes.end())
+	{
+		m_held_changes.insert(std::make_pair(object, change));
+		m_held_order.push_back(object);
+		return;
+	}
+
+	HeldChange &held = FindIt->second;
+	switch(change)
+	{
+	case HeldAdded:
+		if(held == HeldRemoved)held = HeldRemovedAndAdded;
+		else if(held == HeldModified)held = HeldAdded;
+		break;
+	case HeldRemoved:
+		if(held == HeldAdded)m_held_changes.erase(FindIt); // it came and went, so nobody needs to hear about it
+		else held = HeldRemoved;
+		break;
+	default:
+		// an object which has just been added, or which has gone, isn't modified as well
+		break;
+	}
+}
+
+void HeeksCADapp::ReleaseChanges()
+{
+	m_changes_held--;
+	if(m_changes_held > 0)return;
+
+	std::list<HeeksObj*> added, removed, modified;
+	for(std::vector<HeeksObj*>::iterator It = m_held_order.begin(); It != m_held_order.end(); It++)
+	{
+		std::map<HeeksObj*, HeldChange>::iterator FindIt = m_held_changes.find(*It);
+		if(FindIt == m_held_changes.end())continue;
+		switch(FindIt->second)
+		{
+		case HeldAdded:
+			added.push_back(*It);
+			break;
+		case HeldRemoved:
+			removed.push_back(*It);
+			break;
+		case HeldModified:
+			modified.push_back(*It);
+			break;
+		case HeldRemovedAndAdded:
+			removed.push_back(*It);
+			added.push_back(*It);
+			break;
+		}
+		m_held_changes.erase(FindIt);
+	}
+	m_held_order.clear();
+
+	if(added.size() > 0 || removed.size() > 0 || modified.size() > 0)
+	{
+		ObserversOnChange(added.size() > 0 ? &added : NULL, removed.size() > 0 ? &removed : NULL, modified.size() > 0 ? &modified : NULL);
+	}
+	ObserversThaw();
+}
+
 void HeeksCADapp::ClearRollingForward(void)
 {
 	history->ClearFromCurPos();
@@ -2327,6 +2960,16 @@ void HeeksCADapp::RemoveObserver(Observer* observer){
 }
 
 void HeeksCADapp::ObserversOnChange(const std::list<HeeksObj*>* added, const std::list<HeeksObj*>* removed, const std::list<HeeksObj*>* modified){
+	if(m_changes_held > 0)
+	{
+		if(removed)for(std::list<HeeksObj*>::const_iterator It = removed->begin(); It != removed->end(); It++)HoldChange(*It, HeldRemoved);
+		if(added)for(std::list<HeeksObj*>::const_iterator It = added->begin(); It != added->end(); It++)HoldChange(*It, HeldAdded);
+		if(modified)for(std::list<HeeksObj*>::const_iterator It = modified->begin(); It != modified->end(); It++)HoldChange(*It, HeldModified);
+		return;
+	}
+
+	m_view_culler.Invalidate();
+	m_snap_index.OnChanged(added, removed, modified);
 	std::set<Observer*>::iterator It;
 	for(It = observers.begin(); It != observers.end(); It++){
 		Observer *ov = *It;
@@ -2409,7 +3052,16 @@ void HeeksCADapp::Remove(HeeksObj* object)
 
 void HeeksCADapp::Remove(std::list<HeeksObj*> objects)
 {
-	ObjList::Remove(objects);
+	// objects which belong to something else are removed from their owner, as in Remove(HeeksObj*)
+	std::list<HeeksObj*> top_level;
+	for(std::list<HeeksObj*>::iterator It = objects.begin(); It != objects.end(); It++)
+	{
+		HeeksObj* object = *It;
+		if(object->m_owner == this)top_level.push_back(object);
+		else Remove(object);
+	}
+	RemoveInOnePass(top_level);
+	if(m_current_coordinate_system && std::find(top_level.begin(), top_level.end(), (HeeksObj*)m_current_coordinate_system) != top_level.end())m_current_coordinate_system = NULL;
 }
 
 void HeeksCADapp::AddUndoably(HeeksObj *object, HeeksObj* owner, HeeksObj* prev_object)
@@ -2849,6 +3501,11 @@ void on_set_stl_save_binary(bool value, HeeksObj* object)
 	wxGetApp().m_stl_save_as_binary = value;
 }
 
+void on_set_save_for_older_versions(bool value, HeeksObj* object)
+{
+	wxGetApp().m_save_for_older_versions = value;
+}
+
 void on_set_reverse_zooming(bool value, HeeksObj* object)
 {
 	ViewZooming::m_reversed = value;
@@ -3058,6 +3715,10 @@ void on_stl_facet_tolerance(double value, HeeksObj* object){
 	wxGetApp().m_stl_facet_tolerance = value;
 }
 
+void on_stl_weld_tolerance(double value, HeeksObj* object){
+	wxGetApp().m_stl_weld_tolerance = value;
+}
+
 void on_set_auto_save_interval(int value, HeeksObj* object){
 	wxGetApp().m_auto_save_interval = value;
 
@@ -3371,8 +4032,10 @@ void HeeksCADapp::GetOptions(std::list<Property *> *list)
 	PropertyList* stl_options = new PropertyList(_("STL"));
 	stl_options->m_list.push_back(new PropertyDouble(_("stl save facet tolerance"), m_stl_facet_tolerance, NULL, on_stl_facet_tolerance));
 	stl_options->m_list.push_back( new PropertyCheck(_("STL save binary"), m_stl_save_as_binary, NULL, on_set_stl_save_binary));
+	stl_options->m_list.push_back(new PropertyDouble(_("stl import weld tolerance"), m_stl_weld_tolerance, NULL, on_stl_weld_tolerance));
 	file_options->m_list.push_back(stl_options);
 	file_options->m_list.push_back(new PropertyInt(_("auto save interval (in minutes)"), m_auto_save_interval, NULL, on_set_auto_save_interval));
+	file_options->m_list.push_back(new PropertyCheck(_("save files which older versions can read"), m_save_for_older_versions, NULL, on_set_save_for_older_versions));
 	list->push_back(file_options);
 
 #ifndef WIN32
@@ -3418,7 +4081,7 @@ const wxChar* HeeksCADapp::GetKnownFilesWildCardString(bool open, bool import_ex
 {
 	if(!import_export)
 	{
-		known_file_ext = wxString(_("Heeks files")) + _T(" |*.heeks;*.HEEKS");
+		known_file_ext = wxString(_("Heeks files")) + _T(" |*.heeks;*.HEEKS;*.heeksb;*.HEEKSB|") + _("Heeks XML files") + _T(" (*.heeks)|*.heeks;*.HEEKS|") + _("Heeks binary files") + _T(" (*.heeksb)|*.heeksb;*.HEEKSB");
 		return known_file_ext.c_str();
 	}
 
@@ -3447,12 +4110,12 @@ const wxChar* HeeksCADapp::GetKnownFilesWildCardString(bool open, bool import_ex
 		    registeredExtensions << _T(";*.") << itHandler->first;
 		}
 
-		known_file_ext = wxString(_("Known Files")) + _T(" |*.heeks;*.HEEKS;*.igs;*.IGS;*.iges;*.IGES;*.stp;*.STP;*.step;*.STEP;*.dxf;*.DXF") + imageExtStr + registeredExtensions + _T("|") + _("Heeks files") + _T(" (*.heeks)|*.heeks;*.HEEKS|") + _("IGES files") + _T(" (*.igs *.iges)|*.igs;*.IGS;*.iges;*.IGES|") + _("STEP files") + _T(" (*.stp *.step)|*.stp;*.STP;*.step;*.STEP|") + _("STL files") + _T(" (*.stl)|*.stl;*.STL|") + _("Scalar Vector Graphics files") + _T(" (*.svg)|*.svg;*.SVG|") + _("DXF files") + _T(" (*.dxf)|*.dxf;*.DXF|") + _("RS274X/Gerber files") + _T(" (*.gbr,*.rs274x)|*.gbr;*.GBR;*.rs274x;*.RS274X;*.pho;*.PHO|") + _("Picture files") + _T(" (") + imageExtStr2 + _T(")|") + imageExtStr;
+		known_file_ext = wxString(_("Known Files")) + _T(" |*.heeks;*.HEEKS;*.heeksb;*.HEEKSB;*.igs;*.IGS;*.iges;*.IGES;*.stp;*.STP;*.step;*.STEP;*.dxf;*.DXF") + imageExtStr + registeredExtensions + _T("|") + _("Heeks files") + _T(" (*.heeks)|*.heeks;*.HEEKS|") + _("Heeks binary files") + _T(" (*.heeksb)|*.heeksb;*.HEEKSB|") + _("IGES files") + _T(" (*.igs *.iges)|*.igs;*.IGS;*.iges;*.IGES|") + _("STEP files") + _T(" (*.stp *.step)|*.stp;*.STP;*.step;*.STEP|") + _("STL files") + _T(" (*.stl)|*.stl;*.STL|") + _("Scalar Vector Graphics files") + _T(" (*.svg)|*.svg;*.SVG|") + _("DXF files") + _T(" (*.dxf)|*.dxf;*.DXF|") + _("RS274X/Gerber files") + _T(" (*.gbr,*.rs274x)|*.gbr;*.GBR;*.rs274x;*.RS274X;*.pho;*.PHO|") + _("Picture files") + _T(" (") + imageExtStr2 + _T(")|") + imageExtStr;
 		return known_file_ext.c_str();
 	}
 	else{
 		// file save
-		known_file_ext = wxString(_("Known Files")) + _T(" |*.heeks;*.igs;*.iges;*.stp;*.step;*.stl;*.dxf;*.cpp;*.py|") + _("Heeks files") + _T(" (*.heeks)|*.heeks|") + _("IGES files") + _T(" (*.igs *.iges)|*.igs;*.iges|") + _("STEP files") + _T(" (*.stp *.step)|*.stp;*.step|") + _("STL files") + _T(" (*.stl)|*.stl|") + _("DXF files") + _T(" (*.dxf)|*.dxf|") + _("CPP files") + _T(" (*.cpp)|*.cpp|") + _("OpenCAMLib python files") + _T(" (*.py)|*.py");
+		known_file_ext = wxString(_("Known Files")) + _T(" |*.heeks;*.heeksb;*.igs;*.iges;*.stp;*.step;*.stl;*.dxf;*.cpp;*.py|") + _("Heeks files") + _T(" (*.heeks)|*.heeks|") + _("Heeks binary files") + _T(" (*.heeksb)|*.heeksb|") + _("IGES files") + _T(" (*.igs *.iges)|*.igs;*.iges|") + _("STEP files") + _T(" (*.stp *.step)|*.stp;*.step|") + _("STL files") + _T(" (*.stl)|*.stl|") + _("DXF files") + _T(" (*.dxf)|*.dxf|") + _("CPP files") + _T(" (*.cpp)|*.cpp|") + _("OpenCAMLib python files") + _T(" (*.py)|*.py");
 		return known_file_ext.c_str();
 	}
 }
@@ -3460,11 +4123,11 @@ const wxChar* HeeksCADapp::GetKnownFilesWildCardString(bool open, bool import_ex
 const wxChar* HeeksCADapp::GetKnownFilesCommaSeparatedList(bool open, bool import_export)const
 {
 	if(!import_export)
-		return _T("heeks");
+		return _T("heeks, heeksb");
 
 	if(open){
 		wxList handlers = wxImage::GetHandlers();
-		wxString known_ext_str = _T("heeks, igs, iges, stp, step, dxf");
+		wxString known_ext_str = _T("heeks, heeksb, igs, iges, stp, step, dxf");
 		for(wxList::iterator It = handlers.begin(); It != handlers.end(); It++)
 		{
 			wxImageHandler* handler = (wxImageHandler*)(*It);
@@ -3483,7 +4146,7 @@ const wxChar* HeeksCADapp::GetKnownFilesCommaSeparatedList(bool open, bool impor
 	}
 	else{
 		// file save
-		return _T("heeks, igs, iges, stp, step, stl, dxf");
+		return _T("heeks, heeksb, igs, iges, stp, step, stl, dxf");
 	}
 }
 
@@ -3789,8 +4452,36 @@ int HeeksCADapp::PickObjects(const wxChar* str, long marking_filter, bool just_o
 	return EndPickObjects();
 }
 
+bool HeeksCADapp::Initialize(int& argc, wxChar **argv)
+{
+	// converting files doesn't need a display, so don't start the GUI toolkit, which fails without one
+	if(CBatchConvert::InCommandLine(argc, argv))return wxAppConsole::Initialize(argc, argv);
+	return wxApp::Initialize(argc, argv);
+}
+
+bool HeeksCADapp::OnInitGui()
+{
+	if(CBatchConvert::InCommandLine(argc, argv))return true;
+	return wxApp::OnInitGui();
+}
+
+void HeeksCADapp::CleanUp()
+{
+	if(m_batch_convert.Requested())wxAppConsole::CleanUp();
+	else wxApp::CleanUp();
+}
+
+void HeeksCADapp::ReportError(const wxString &msg)
+{
+	// a message box, unless converting files without the main window, when it goes to stderr
+	if(m_frame)wxMessageBox(msg);
+	else wxLogError(_T("%s"), msg.c_str());
+}
+
 int HeeksCADapp::OnRun()
 {
+	if(m_batch_convert.Requested())return m_batch_convert.Run();
+
 	try
 	{
 		return wxApp::OnRun();
@@ -4030,30 +4721,18 @@ wxFileName HeeksCADapp::GetProjectFileName() const
 
 HeeksObj* HeeksCADapp::GetIDObject(int type, int id)
 {
-	UsedIds_t::iterator FindIt1 = used_ids.find(type);
-	if (FindIt1 == used_ids.end()) return(NULL);
-
-	IdsToObjects_t &ids = FindIt1->second;
-	IdsToObjects_t::iterator FindIt2 = ids.find(id);
-
-	if (FindIt2 == ids.end())return NULL;
-
-	std::list<HeeksObj*> &list = FindIt2->second;
-	return list.back();
+	UsedIds_t::iterator FindIt = used_ids.find(type);
+	if (FindIt == used_ids.end()) return(NULL);
+	return FindIt->second.Find(id);
 }
 
 std::list<HeeksObj*> HeeksCADapp::GetIDObjects(int type, int id)
 {
     std::list<HeeksObj *> results;
 
-	UsedIds_t::iterator FindIt1 = used_ids.find(type);
-	if (FindIt1 == used_ids.end()) return results;
-
-	IdsToObjects_t &ids = FindIt1->second;
-	IdsToObjects_t::iterator FindIt2 = ids.find(id);
-
-	if (FindIt2 == ids.end()) return results;
-	return FindIt2->second;
+	UsedIds_t::iterator FindIt = used_ids.find(type);
+	if (FindIt != used_ids.end())FindIt->second.FindAll(id, results);
+	return results;
 }
 
 void HeeksCADapp::SetObjectID(HeeksObj* object, int id)
@@ -4061,85 +4740,27 @@ void HeeksCADapp::SetObjectID(HeeksObj* object, int id)
 	if(object->UsesID())
 	{
 		object->m_id = id;
-		GroupId_t id_group_type = object->GetIDGroupType();
-
-		UsedIds_t::iterator FindIt1 = used_ids.find(id_group_type);
-		if(FindIt1 == used_ids.end())
-		{
-			// add a new map
-			std::list<HeeksObj*> empty_list;
-			empty_list.push_back(object);
-			IdsToObjects_t empty_map;
-			empty_map.insert( std::make_pair( id, empty_list ) );
-			FindIt1 = used_ids.insert( std::make_pair( id_group_type, empty_map )).first;
-		}
-		else
-		{
-
-			IdsToObjects_t &map = FindIt1->second;
-			IdsToObjects_t::iterator FindIt2 = map.find(id);
-			if(FindIt2 == map.end())
-			{
-				std::list<HeeksObj*> empty_list;
-				empty_list.push_back(object);
-				map.insert( std::make_pair(id, empty_list) );
-			}
-			else
-			{
-				std::list<HeeksObj*> &list = FindIt2->second;
-				list.push_back(object);
-			}
-		}
+		used_ids[object->GetIDGroupType()].Add(id, object);
 	}
 }
 
 int HeeksCADapp::GetNextID(int id_group_type)
 {
-	UsedIds_t::iterator FindIt1 = used_ids.find(id_group_type);
-	if(FindIt1 == used_ids.end())return 1;
-
-	std::map< int, int >::iterator FindIt2 = next_id_map.find(id_group_type);
-
-	IdsToObjects_t &map = FindIt1->second;
-
-	if(FindIt2 == next_id_map.end())
-	{
-		// add a new int
-		int next_id = map.begin()->first + 1;
-		FindIt2 = next_id_map.insert( std::make_pair(id_group_type, next_id) ).first;
-	}
-
-	int &next_id = FindIt2->second;
-
-	while(map.find(next_id) != map.end())next_id++;
-	return next_id;
+	UsedIds_t::iterator FindIt = used_ids.find(id_group_type);
+	if(FindIt == used_ids.end())return 1;
+	return FindIt->second.GetNextID();
 }
 
 void HeeksCADapp::RemoveID(HeeksObj* object)
 {
-	int id_group_type = object->GetIDGroupType();
-
-	UsedIds_t::iterator FindIt1 = used_ids.find(id_group_type);
-	if(FindIt1 == used_ids.end())return;
-	std::map< int, int >::iterator FindIt2 = next_id_map.find(id_group_type);
-
-	IdsToObjects_t &map = FindIt1->second;
-	if (FindIt2 != next_id_map.end())
-	{
-		IdsToObjects_t::iterator FindIt3 = map.find(object->m_id);
-		if(FindIt3 != map.end())
-		{
-			std::list<HeeksObj*> &list = FindIt3->second;
-			list.remove(object);
-			if(list.size() == 0)map.erase(object->m_id);
-		}
-	} // End if - then
+	UsedIds_t::iterator FindIt = used_ids.find(object->GetIDGroupType());
+	if(FindIt == used_ids.end())return;
+	FindIt->second.Remove(object->m_id, object);
 }
 
 void HeeksCADapp::ResetIDs()
 {
 	used_ids.clear();
-	next_id_map.clear();
 }
 
 void HeeksCADapp::RegisterOnGLCommands( void(*callbackfunc)() )
@@ -4182,26 +4803,27 @@ void HeeksCADapp::RegisterIsModifiedFn( bool(*callbackfunc)() )
 	m_is_modified_callbacks.push_back(callbackfunc);
 }
 
-void HeeksCADapp::CreateTransformGLList(const std::list<HeeksObj*>& list, bool show_grippers_on_drag){
-	DestroyTransformGLList();
-	m_transform_gl_list = glGenLists(1);
-	glNewList(m_transform_gl_list, GL_COMPILE);
-	std::list<HeeksObj *>::const_iterator It;
-	for(It = list.begin(); It != list.end(); It++){
-		(*It)->glCommands(false, true, false);
+void HeeksCADapp::StartTransformDrag(const std::list<HeeksObj*>& list, bool show_grippers_on_drag){
+	EndTransformDrag();
+
+	// hide the objects where they are, and draw them moved by m_drag_matrix instead
+	m_drag_matrix = gp_Trsf();
+	for(std::list<HeeksObj*>::const_iterator It = list.begin(); It != list.end(); It++){
+		HeeksObj* object = *It;
+		if(object->m_visible)m_hidden_for_drag.push_back(object);
+		object->m_visible = false;
 	}
-	glDisable(GL_DEPTH_TEST);
-	if(show_grippers_on_drag)m_marked_list->GrippersGLCommands(false, false);
-	glEnable(GL_DEPTH_TEST);
-	glEndList();
+	m_transform_drag = true;
+	m_transform_drag_grippers = show_grippers_on_drag;
 }
 
-void HeeksCADapp::DestroyTransformGLList(){
-	if (m_transform_gl_list)
-	{
-		glDeleteLists(m_transform_gl_list, 1);
+void HeeksCADapp::EndTransformDrag(){
+	for(std::list<HeeksObj*>::iterator It = m_hidden_for_drag.begin(); It != m_hidden_for_drag.end(); It++){
+		HeeksObj* object = *It;
+		object->m_visible = true;
 	}
-	m_transform_gl_list = 0;
+	m_hidden_for_drag.clear();
+	m_transform_drag = false;
 }
 
 bool HeeksCADapp::IsPasteReady()
@@ -4527,19 +5149,11 @@ std::auto_ptr<VectorFonts>	& HeeksCADapp::GetAvailableFonts(const bool force_rea
     {
         if (m_pVectorFonts.get() == NULL)
         {
+            // This only reads the font names; each font's glyphs are read when it's first used.
             std::vector<wxString> paths = Tokens( m_font_paths, _T(";") );
 
-            wxProgressDialog progress(	wxString(_T("Reading Vector Font Definition Files")),
-							wxString(_T("Reading Vector Font Definition Files")),
-							paths.size(),
-							NULL,
-							wxPD_APP_MODAL | wxPD_ELAPSED_TIME | wxPD_ESTIMATED_TIME | wxPD_REMAINING_TIME | wxPD_AUTO_HIDE );
-
-            int i=0;
             for (std::vector<wxString>::const_iterator l_itPath = paths.begin(); l_itPath != paths.end(); l_itPath++)
             {
-                progress.Update(i++);
-
                 if (m_pVectorFonts.get() == NULL)
                 {
                     m_pVectorFonts = std::auto_ptr<VectorFonts>(new VectorFonts(*l_itPath, m_word_space_percentage, m_character_space_percentage));
@@ -4753,6 +5367,7 @@ wxString HeeksCADType(const int type)
         case OrientationModifierType:   return(_("OrientationModifier"));
         case HoleType:   return(_("Hole"));
         case HolePositionsType:   return(_("Positions"));
+        case InstanceType:   return(_("Instance"));
         case ObjectMaximumType:   return(_("ObjectMaximum"));
         default:    return(_T("")); // Indicate that this routine could not find a conversion.
     } // End switch
@@ -14,8 +14,16 @@
 #ifndef WIN32
 #include "CxfFont.h"
 #endif
+#include "IdRegistry.h"
+#include "ViewCuller.h"
+#include "SnapIndex.h"
+#include "BatchConvert.h"
 
 #include <memory>
+
+// written on HeeksCAD_Document elements. version 2 files keep their solids in a BREP_file element, which version 1 readers ignore
+#define HEEKSCAD_DOCUMENT_VERSION 2
+
 class MagDragWindow;
 class ViewRotating;
 class ViewZooming;
@@ -89,14 +97,25 @@ class HeeksCADapp : public wxApp, public ObjList
 		std::set<Observer*> observers;
 		MainHistory *history;
 
-		typedef std::map< int, std::list<HeeksObj*> > IdsToObjects_t;
-		typedef int GroupId_t;
-		typedef std::map< GroupId_t, IdsToObjects_t > UsedIds_t;
+		// while a transaction or an undo is running, the changes are collected here and the observers are told once at the end
+		enum HeldChange
+		{
+			HeldAdded,
+			HeldRemoved,
+			HeldModified,
+			HeldRemovedAndAdded
+		};
+		int m_changes_held;
+		std::map<HeeksObj*, HeldChange> m_held_changes;
+		std::vector<HeeksObj*> m_held_order; // the order the objects first changed in
+		void HoldChanges();
+		void ReleaseChanges();
+		void HoldChange(HeeksObj* object, HeldChange change);
 
-		UsedIds_t	used_ids;
+		typedef int GroupId_t;
+		typedef std::map< GroupId_t, CIdTable > UsedIds_t;
 
-		// std::map< int, std::map<int, HeeksObj*> > used_ids; // map of group type ( usually same as object type ) to "map of ID to object"
-		std::map< int, int > next_id_map;
+		UsedIds_t	used_ids; // map of group type ( usually same as object type ) to table of ID to objects
 		std::map< std::string, HeeksObj*(*)(TiXmlElement* pElem) > xml_read_fn_map;
 
 		void render_screen_text2(const wxChar* str);
@@ -141,6 +160,7 @@ class HeeksCADapp : public wxApp, public ObjList
 		bool m_allow_opengl_stippling;
 		SolidViewMode m_solid_view_mode;
 		bool m_stl_save_as_binary;
+		bool m_save_for_older_versions; // write version 1 documents, with solids in a STEP_file element and STL solids as separate triangles
 		bool m_mouse_move_highlighting;
 		HeeksColor m_highlight_color;
 
@@ -161,6 +181,9 @@ class HeeksCADapp : public wxApp, public ObjList
 		CHeeksFrame *m_frame;
 		CViewport *m_current_viewport;
 		MarkedList *m_marked_list;
+		CViewCuller m_view_culler;
+		CSnapIndex m_snap_index;
+		CBatchConvert m_batch_convert;
 		bool m_doing_rollback;
 
 		// Project
@@ -198,7 +221,8 @@ class HeeksCADapp : public wxApp, public ObjList
 		std::list< void(*)() > m_beforeframedelete_callbacks;
 		std::list< void(*)(std::list<Tool*>&) > m_markedlisttools_callbacks;
 		std::list< void(*)() > m_on_restore_defaults_callbacks;
-		int m_transform_gl_list;
+		bool m_transform_drag; // m_hidden_for_drag are drawn moved by m_drag_matrix
+		bool m_transform_drag_grippers;
 		gp_Trsf m_drag_matrix;
 		bool m_extrude_removes_sketches;
 		bool m_loft_removes_sketches;
@@ -231,6 +255,7 @@ class HeeksCADapp : public wxApp, public ObjList
 		double m_character_space_percentage; // Font
 #endif
 		double m_stl_facet_tolerance;
+		double m_stl_weld_tolerance; // vertices of an imported STL file closer than this are merged
 
 		int m_auto_save_interval;	// In minutes
 		std::auto_ptr<CAutoSave> m_pAutoSave;
@@ -268,6 +293,9 @@ class HeeksCADapp : public wxApp, public ObjList
 		bool m_settings_restored;
 
 		//WxApp override
+		bool Initialize(int& argc, wxChar **argv);
+		bool OnInitGui();
+		void CleanUp();
 		int OnRun();
 		bool OnExceptionInMainLoop();
 
@@ -280,6 +308,7 @@ class HeeksCADapp : public wxApp, public ObjList
 		virtual bool OnInit();
 		int OnExit();
 		void WriteConfig();
+		void ReportError(const wxString &msg);
 		void CreateLights(void);
 		void DestroyLights(void);
 		void FindMarkedObject(const wxPoint &point, MarkedObject* marked_object);
@@ -304,6 +333,8 @@ class HeeksCADapp : public wxApp, public ObjList
 		bool CanRedo(void);
 		void StartHistory();
 		void EndHistory(void);
+		void StartTransaction(); // like StartHistory, but the observers are only told about the changes at EndTransaction
+		void EndTransaction(void);
 		void ClearRollingForward(void);
 		bool Add(HeeksObj* object, HeeksObj* prev_object);
 		void Remove(HeeksObj* object);
@@ -311,10 +342,13 @@ class HeeksCADapp : public wxApp, public ObjList
 		void Transform(std::list<HeeksObj*> objects, double *m);
 		void Reset();
 		HeeksObj* ReadXMLElement(TiXmlElement* pElem);
+		HeeksObj* UseExistingObject(HeeksObj* object);
 		void ObjectWriteBaseXML(HeeksObj *object, TiXmlElement *element);
 		void ObjectReadBaseXML(HeeksObj *object, TiXmlElement* element);
 		void InitializeXMLFunctions();
 		void OpenXMLFile(const wxChar *filepath,HeeksObj* paste_into = NULL, HeeksObj* paste_before = NULL, bool undoably = false);
+		void OpenBinaryFile(const wxChar *filepath,HeeksObj* paste_into = NULL, HeeksObj* paste_before = NULL, bool undoably = false);
+		void AddObjectsFromFile(const std::list<HeeksObj*> &objects, HeeksObj* paste_into, HeeksObj* paste_before);
 		static void OpenSVGFile(const wxChar *filepath);
 		static void OpenSTLFile(const wxChar *filepath);
 		static void OpenDXFFile(const wxChar *filepath);
@@ -331,6 +365,7 @@ class HeeksCADapp : public wxApp, public ObjList
 		void SavePyFile(const std::list<HeeksObj*>& objects, const wxChar *filepath, double facet_tolerance = -1.0);
 		void SaveXMLFile(const std::list<HeeksObj*>& objects, const wxChar *filepath, bool for_clipboard = false);
 		void SaveXMLFile(const wxChar *filepath){SaveXMLFile(m_objects, filepath);}
+		void SaveBinaryFile(const std::list<HeeksObj*>& objects, const wxChar *filepath);
 		bool SaveProject(const bool force_dialog = false);
 		bool SaveFile(const wxChar *filepath, bool use_dialog = false, bool update_recent_file_list = true, bool set_app_caption = true);
 		void AddUndoably(HeeksObj *object, HeeksObj* owner, HeeksObj* prev_object);
@@ -402,8 +437,8 @@ class HeeksCADapp : public wxApp, public ObjList
 		void RemoveOnMouseFn( void(*callbackfunc)(wxMouseEvent&) );
 		void RegisterOnSaveFn( void(*callbackfunc)(bool) );
 		void RegisterIsModifiedFn( bool(*callbackfunc)() );
-		void CreateTransformGLList(const std::list<HeeksObj*>& list, bool show_grippers_on_drag);
-		void DestroyTransformGLList();
+		void StartTransformDrag(const std::list<HeeksObj*>& list, bool show_grippers_on_drag);
+		void EndTransformDrag();
 		bool IsPasteReady();
 		void EnableBlend();
 		void DisableBlend();
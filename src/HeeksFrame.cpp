@@ -42,6 +42,7 @@
 #include "MenuSeparator.h"
 #include "HGear.h"
 #include "HPoint.h"
+#include "Instance.h"
 #ifdef USING_RIBBON
 #include "HeeksRibbon.h"
 #endif
@@ -815,7 +816,7 @@ void OnUpdatePaste( wxUpdateUIEvent& event )
 
 void OnSubtractButton( wxCommandEvent& event )
 {
-	if(!wxGetApp().CheckForNOrMore(wxGetApp().m_marked_list->list(), 2, SolidType, FaceType, _("Pick two or more faces or solids, the first one will be cut by the others"), _("Subtract Solids")))return;
+	if(!wxGetApp().CheckForNOrMore(CInstance::Sources(wxGetApp().m_marked_list->list()), 2, SolidType, FaceType, _("Pick two or more faces or solids, the first one will be cut by the others"), _("Subtract Solids")))return;
 	wxGetApp().StartHistory();
 	CShape::CutShapes(wxGetApp().m_marked_list->list());
 	wxGetApp().EndHistory();
@@ -823,7 +824,7 @@ void OnSubtractButton( wxCommandEvent& event )
 
 void OnFuseButton( wxCommandEvent& event )
 {
-	if(!wxGetApp().CheckForNOrMore(wxGetApp().m_marked_list->list(), 2, SolidType, _("Pick two or more solids to be fused together"), _("Fuse Solids")))return;
+	if(!wxGetApp().CheckForNOrMore(CInstance::Sources(wxGetApp().m_marked_list->list()), 2, SolidType, _("Pick two or more solids to be fused together"), _("Fuse Solids")))return;
 	wxGetApp().StartHistory();
 	CShape::FuseShapes(wxGetApp().m_marked_list->list());
 	wxGetApp().EndHistory();
@@ -831,7 +832,7 @@ void OnFuseButton( wxCommandEvent& event )
 
 void OnCommonButton( wxCommandEvent& event )
 {
-	if(!wxGetApp().CheckForNOrMore(wxGetApp().m_marked_list->list(), 2, SolidType, _("Pick two or more solids, only the shape that is contained by all of them will remain"), _("Intersection of Solids")))return;
+	if(!wxGetApp().CheckForNOrMore(CInstance::Sources(wxGetApp().m_marked_list->list()), 2, SolidType, _("Pick two or more solids, only the shape that is contained by all of them will remain"), _("Intersection of Solids")))return;
 	wxGetApp().StartHistory();
 	CShape::CommonShapes(wxGetApp().m_marked_list->list());
 	wxGetApp().m_marked_list->Clear(true);
@@ -0,0 +1,140 @@
+// IdRegistry.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "IdRegistry.h"
+#include <functional>
+
+static const int initial_bits = 4;
+
+CIdTable::CIdTable():m_size(0), m_shift(32 - initial_bits), m_next_id(0)
+{
+	Entry empty = {0, NULL};
+	m_entries.resize(1 << initial_bits, empty);
+}
+
+void CIdTable::Insert(int id, HeeksObj* object)
+{
+	// objects with the same ID go further along the same run, so they stay in the order they were added
+	size_t i = Home(id);
+	while(m_entries[i].m_object)i = (i + 1) & Mask();
+	m_entries[i].m_id = id;
+	m_entries[i].m_object = object;
+}
+
+void CIdTable::Grow()
+{
+	std::vector<Entry> old_entries;
+	old_entries.swap(m_entries);
+	Entry empty = {0, NULL};
+	m_entries.resize(old_entries.size() * 2, empty);
+	m_shift--;
+
+	// re-insert in probe order from the start of a run, so entries with the same ID keep their order
+	size_t start = 0;
+	while(start < old_entries.size() && old_entries[start].m_object)start++;
+	for(size_t n = 0; n < old_entries.size(); n++)
+	{
+		const Entry &e = old_entries[(start + n) & (old_entries.size() - 1)];
+		if(e.m_object)Insert(e.m_id, e.m_object);
+	}
+}
+
+void CIdTable::Add(int id, HeeksObj* object)
+{
+	// keep the table no more than half full, so runs stay short
+	if((m_size + 1) * 2 > m_entries.size())Grow();
+	Insert(id, object);
+	m_size++;
+}
+
+void CIdTable::RemoveAt(size_t i)
+{
+	// move later entries of the run back into the gap, instead of leaving a marker, so lookups never get slower
+	size_t j = i;
+	while(1)
+	{
+		j = (j + 1) & Mask();
+		if(m_entries[j].m_object == NULL)break;
+		size_t k = Home(m_entries[j].m_id);
+		bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+		if(stays)continue;
+		m_entries[i] = m_entries[j];
+		i = j;
+	}
+	m_entries[i].m_object = NULL;
+	m_size--;
+}
+
+void CIdTable::Remove(int id, HeeksObj* object)
+{
+	bool removed = false;
+	size_t i = Home(id);
+	while(m_entries[i].m_object)
+	{
+		if(m_entries[i].m_id == id && m_entries[i].m_object == object)
+		{
+			RemoveAt(i);
+			removed = true;
+			// look at the same slot again, something else may have moved into it
+			continue;
+		}
+		i = (i + 1) & Mask();
+	}
+
+	// GetNextID's search has gone past this ID, so remember it for GetNextID to give out again
+	if(removed && id > 0 && id < m_next_id && !Contains(id))
+	{
+		m_free_ids.push_back(id);
+		std::push_heap(m_free_ids.begin(), m_free_ids.end(), std::greater<int>());
+	}
+}
+
+HeeksObj* CIdTable::Find(int id)const
+{
+	HeeksObj* found = NULL;
+	for(size_t i = Home(id); m_entries[i].m_object; i = (i + 1) & Mask())
+	{
+		if(m_entries[i].m_id == id)found = m_entries[i].m_object;
+	}
+	return found;
+}
+
+void CIdTable::FindAll(int id, std::list<HeeksObj*> &objects)const
+{
+	for(size_t i = Home(id); m_entries[i].m_object; i = (i + 1) & Mask())
+	{
+		if(m_entries[i].m_id == id)objects.push_back(m_entries[i].m_object);
+	}
+}
+
+int CIdTable::GetNextID()
+{
+	if(m_next_id == 0)
+	{
+		// start one after the lowest used ID
+		bool found = false;
+		int lowest = 0;
+		for(std::vector<Entry>::const_iterator It = m_entries.begin(); It != m_entries.end(); It++)
+		{
+			if(It->m_object && (!found || It->m_id < lowest))
+			{
+				lowest = It->m_id;
+				found = true;
+			}
+		}
+		m_next_id = found ? lowest + 1 : 1;
+	}
+
+	// IDs which have been used again since they were released are thrown away when they get to the top
+	while(m_free_ids.size() > 0)
+	{
+		int id = m_free_ids.front();
+		if(!Contains(id))return id;
+		std::pop_heap(m_free_ids.begin(), m_free_ids.end(), std::greater<int>());
+		m_free_ids.pop_back();
+	}
+
+	while(Contains(m_next_id))m_next_id++;
+	return m_next_id;
+}
@@ -0,0 +1,41 @@
+// IdRegistry.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+class HeeksObj;
+
+// the objects using each ID, for one ID group.
+// an open addressing hash table, so adding, removing and finding are all constant time; it can hold more than one object with the same ID.
+class CIdTable
+{
+	struct Entry
+	{
+		int m_id;
+		HeeksObj* m_object; // NULL for an empty slot
+	};
+
+	std::vector<Entry> m_entries;
+	size_t m_size;
+	int m_shift;
+	int m_next_id; // 0 until GetNextID is first called
+	std::vector<int> m_free_ids; // a min-heap of the IDs below m_next_id whose objects have all been removed; some may have been used again since
+
+	size_t Home(int id)const{return (size_t)(((unsigned int)id * 2654435769u) >> m_shift);}
+	size_t Mask()const{return m_entries.size() - 1;}
+	void Insert(int id, HeeksObj* object);
+	void Grow();
+	void RemoveAt(size_t i);
+
+public:
+	CIdTable();
+
+	void Add(int id, HeeksObj* object);
+	void Remove(int id, HeeksObj* object); // removes all the entries for object with this ID
+	HeeksObj* Find(int id)const; // the last object added with this ID
+	void FindAll(int id, std::list<HeeksObj*> &objects)const; // in the order they were added
+	bool Contains(int id)const{return Find(id) != NULL;}
+	int GetNextID(); // the lowest released ID, or else the lowest unused ID from where the last search ended, starting one after the lowest used ID
+	size_t Size()const{return m_size;}
+};
@@ -0,0 +1,362 @@
+// Instance.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "Instance.h"
+#include "Shape.h"
+#include "PropertyTrsf.h"
+#include "../interface/Tool.h"
+#include <TopLoc_Location.hxx>
+
+std::map<CInstanceSource*, int> CInstance::m_sources_written;
+std::map<int, CInstanceSource*> CInstance::m_sources_read;
+
+CInstance::CInstance(CInstanceSource* source, const gp_Trsf &trsf):m_source(source), m_trsf(trsf)
+{
+	m_source->AddUser();
+}
+
+CInstance::CInstance(const CInstance &i):HeeksObj(i), m_source(i.m_source), m_trsf(i.m_trsf)
+{
+	m_source->AddUser();
+}
+
+CInstance::~CInstance()
+{
+	m_source->RemoveUser();
+}
+
+const CInstance& CInstance::operator=(const CInstance &i)
+{
+	HeeksObj::operator=(i);
+	i.m_source->AddUser();
+	m_source->RemoveUser();
+	m_source = i.m_source;
+	m_trsf = i.m_trsf;
+	return *this;
+}
+
+void CInstance::glCommands(bool select, bool marked, bool no_color)
+{
+	glPushMatrix();
+	double m[16];
+	extract_transposed(m_trsf, m);
+	glMultMatrixd(m);
+
+	// the source is drawn without names, so the instance is picked as a whole
+	m_source->Object()->glCommands(false, marked, no_color);
+
+	glPopMatrix();
+}
+
+void CInstance::KillGLLists(void)
+{
+	// the lists are the source's, which isn't in the document, so wouldn't be told otherwise
+	m_source->Object()->KillGLLists();
+}
+
+void CInstance::GetBox(CBox &box)
+{
+	CBox source_box;
+	m_source->Object()->GetBox(source_box);
+	if(!source_box.m_valid)return;
+
+	for(int i = 0; i < 8; i++)
+	{
+		gp_Pnt p((i & 1) ? source_box.MaxX() : source_box.MinX(), (i & 2) ? source_box.MaxY() : source_box.MinY(), (i & 4) ? source_box.MaxZ() : source_box.MinZ());
+		p.Transform(m_trsf);
+		box.Insert(p.X(), p.Y(), p.Z());
+	}
+}
+
+HeeksObj *CInstance::MakeACopy(void)const
+{
+	return new CInstance(*this);
+}
+
+void CInstance::ModifyByMatrix(const double *m)
+{
+	gp_Trsf mat = make_matrix(m);
+	m_trsf = mat * m_trsf;
+}
+
+static void on_set_trsf(const gp_Trsf &trsf, HeeksObj* object){
+	((CInstance*)object)->m_trsf = trsf;
+	wxGetApp().Repaint();
+}
+
+void CInstance::GetProperties(std::list<Property *> *list)
+{
+	list->push_back(new PropertyTrsf(_("orientation"), m_trsf, this, on_set_trsf));
+
+	HeeksObj::GetProperties(list);
+}
+
+static CInstance* instance_for_tools = NULL;
+
+class MakeInstanceReal: public Tool
+{
+public:
+	void Run()
+	{
+		HeeksObj* copy = instance_for_tools->MakeRealCopy();
+		wxGetApp().StartHistory();
+		wxGetApp().AddUndoably(copy, instance_for_tools->m_owner, instance_for_tools);
+		wxGetApp().DeleteUndoably(instance_for_tools);
+		wxGetApp().EndHistory();
+	}
+	const wxChar* GetTitle(){return _("Make a separate copy");}
+	wxString BitmapPath(){return _T("copy");}
+};
+
+static MakeInstanceReal make_instance_real;
+
+void CInstance::GetTools(std::list<Tool*>* t_list, const wxPoint* p)
+{
+	instance_for_tools = this;
+	t_list->push_back(&make_instance_real);
+}
+
+static const gp_Trsf* trsf_for_callback = NULL;
+static void(*triangle_callback)(const double* x, const double* n) = NULL;
+static bool one_normal_for_callback = true;
+static void(*segment_callback)(const double *p) = NULL;
+
+static void transformed_triangle(const double* x, const double* n)
+{
+	double tx[9], tn[9];
+	for(int i = 0; i < 3; i++)
+	{
+		gp_Pnt p(x[i*3], x[i*3+1], x[i*3+2]);
+		p.Transform(*trsf_for_callback);
+		extract(p, &tx[i*3]);
+	}
+
+	int num_normals = one_normal_for_callback ? 1 : 3;
+	for(int i = 0; i < num_normals; i++)
+	{
+		gp_Vec v(n[i*3], n[i*3+1], n[i*3+2]);
+		v.Transform(*trsf_for_callback);
+		if(v.Magnitude() > 0.0)v.Normalize();
+		extract(v, &tn[i*3]);
+	}
+
+	(*triangle_callback)(tx, tn);
+}
+
+static void transformed_segment_point(const double *p)
+{
+	gp_Pnt tp(p[0], p[1], p[2]);
+	tp.Transform(*trsf_for_callback);
+	double t[3];
+	extract(tp, t);
+	(*segment_callback)(t);
+}
+
+void CInstance::GetTriangles(void(*callbackfunc)(const double* x, const double* n), double cusp, bool just_one_average_normal)
+{
+	trsf_for_callback = &m_trsf;
+	triangle_callback = callbackfunc;
+	one_normal_for_callback = just_one_average_normal;
+	m_source->Object()->GetTriangles(transformed_triangle, cusp, just_one_average_normal);
+}
+
+void CInstance::GetSegments(void(*callbackfunc)(const double *p), double pixels_per_mm, bool want_start_point)const
+{
+	trsf_for_callback = &m_trsf;
+	segment_callback = callbackfunc;
+	m_source->Object()->GetSegments(transformed_segment_point, pixels_per_mm, want_start_point);
+}
+
+HeeksObj* CInstance::MakeRealCopy()const
+{
+	HeeksObj* copy = m_source->Object()->MakeACopy();
+	double m[16];
+	extract(m_trsf, m);
+	copy->ModifyByMatrix(m);
+	return copy;
+}
+
+TopoDS_Shape CInstance::GetTransformedShape()const
+{
+	const TopoDS_Shape &shape = ((CShape*)(m_source->Object()))->Shape();
+
+	// a location can only move and turn it; anything else makes new geometry
+	if(fabs(m_trsf.ScaleFactor() - 1.0) < 1.0e-09)return shape.Moved(TopLoc_Location(m_trsf));
+	return BRepBuilderAPI_Transform(shape, m_trsf, Standard_True).Shape();
+}
+
+// static
+HeeksObj* CInstance::MakeCopy(HeeksObj* object, std::map<HeeksObj*, CInstanceSource*> &sources)
+{
+	int type = object->GetType();
+	if(!CShape::IsTypeAShape(type) && type != StlSolidType)return object->MakeACopy();
+
+	std::map<HeeksObj*, CInstanceSource*>::iterator FindIt = sources.find(object);
+	if(FindIt == sources.end())FindIt = sources.insert(std::make_pair(object, new CInstanceSource(object->MakeACopy()))).first;
+	return new CInstance(FindIt->second);
+}
+
+// static
+std::list<HeeksObj*> CInstance::MakeRealUndoably(const std::list<HeeksObj*> &list)
+{
+	std::list<HeeksObj*> real_list;
+	for(std::list<HeeksObj*>::const_iterator It = list.begin(); It != list.end(); It++)
+	{
+		HeeksObj* object = *It;
+		if(object->GetType() == InstanceType && CShape::IsTypeAShape(((CInstance*)object)->Source()->GetType()))
+		{
+			HeeksObj* copy = ((CInstance*)object)->MakeRealCopy();
+			wxGetApp().AddUndoably(copy, object->m_owner, object);
+			wxGetApp().DeleteUndoably(object);
+			object = copy;
+		}
+		real_list.push_back(object);
+	}
+	return real_list;
+}
+
+// static
+std::list<HeeksObj*> CInstance::Sources(const std::list<HeeksObj*> &list)
+{
+	std::list<HeeksObj*> sources;
+	for(std::list<HeeksObj*>::const_iterator It = list.begin(); It != list.end(); It++)
+	{
+		HeeksObj* object = *It;
+		if(object->GetType() == InstanceType)object = ((CInstance*)object)->Source();
+		sources.push_back(object);
+	}
+	return sources;
+}
+
+void CInstance::WriteXML(TiXmlNode *root)
+{
+	TiXmlElement * element = new TiXmlElement( "Instance" );
+	root->LinkEndChild( element );
+
+	double m[16];
+	extract(m_trsf, m);
+	element->SetDoubleAttribute("m0", m[0] );
+	element->SetDoubleAttribute("m1", m[1] );
+	element->SetDoubleAttribute("m2", m[2] );
+	element->SetDoubleAttribute("m3", m[3] );
+	element->SetDoubleAttribute("m4", m[4] );
+	element->SetDoubleAttribute("m5", m[5] );
+	element->SetDoubleAttribute("m6", m[6] );
+	element->SetDoubleAttribute("m7", m[7] );
+	element->SetDoubleAttribute("m8", m[8] );
+	element->SetDoubleAttribute("m9", m[9] );
+	element->SetDoubleAttribute("ma", m[10]);
+	element->SetDoubleAttribute("mb", m[11]);
+
+	std::map<CInstanceSource*, int>::iterator FindIt = m_sources_written.find(m_source);
+	if(FindIt != m_sources_written.end())
+	{
+		element->SetAttribute("source", FindIt->second);
+	}
+	else
+	{
+		int number = (int)m_sources_written.size() + 1;
+		m_sources_written.insert(std::make_pair(m_source, number));
+		element->SetAttribute("source", number);
+
+		HeeksObj* source = m_source->Object();
+		if(CShape::IsTypeAShape(source->GetType()))
+		{
+			// solids are usually written all together, after the other objects; the source isn't in the document, so is written here
+			CShape* shape = (CShape*)source;
+			TiXmlElement *shape_element = new TiXmlElement( "Shape" );
+			element->LinkEndChild( shape_element );
+			shape_element->SetAttribute("title", shape->m_title.utf8_str());
+			shape_element->SetAttribute("solid_type", (int)CShapeData(shape).m_solid_type);
+			shape->SetXMLElement(shape_element);
+
+			char oldlocale[1000];
+			strcpy(oldlocale, setlocale(LC_NUMERIC, "C"));
+			std::ostringstream brep;
+			std::list<CShape*> shapes;
+			shapes.push_back(shape);
+			CShape::WriteBREP(shape->Shape(), shapes, brep);
+			setlocale(LC_NUMERIC, oldlocale);
+
+			TiXmlText *text = new TiXmlText(brep.str().c_str());
+			text->SetCDATA(true);
+			shape_element->LinkEndChild( text );
+		}
+		else
+		{
+			// without its id, so reading it doesn't find an object in the document with the same id instead
+			source->WriteXML(element);
+			TiXmlElement* source_element = TiXmlHandle(element).FirstChildElement().Element();
+			if(source_element)source_element->RemoveAttribute("id");
+		}
+	}
+
+	WriteBaseXML(element);
+}
+
+static HeeksObj* ReadSourceShape(TiXmlElement* pElem)
+{
+	const char* brep_text = pElem->GetText();
+	if(brep_text == NULL)return NULL;
+
+	char oldlocale[1000];
+	strcpy(oldlocale, setlocale(LC_NUMERIC, "C"));
+	TopoDS_Shape shape;
+	BRep_Builder builder;
+	std::istringstream is(brep_text);
+	BRepTools::Read(shape, is, builder);
+	setlocale(LC_NUMERIC, oldlocale);
+
+	int solid_type = SOLID_TYPE_UNKNOWN;
+	pElem->Attribute("solid_type", &solid_type);
+	wxString title;
+	if(pElem->Attribute("title"))title = Ctt(pElem->Attribute("title"));
+
+	HeeksObj* object = CShape::MakeObject(shape, title.c_str(), (SolidTypeEnum)solid_type, HeeksColor(191, 191, 191), 1.0f);
+	if(object)((CShape*)object)->SetFromXMLElement(pElem);
+	return object;
+}
+
+// static
+HeeksObj* CInstance::ReadFromXMLElement(TiXmlElement* pElem)
+{
+	double m[16];
+	int number = 0;
+
+	for(TiXmlAttribute* a = pElem->FirstAttribute(); a; a = a->Next())
+	{
+		std::string name(a->Name());
+		if(name == "source"){number = a->IntValue();}
+		else if(name == "m0"){m[0] = a->DoubleValue();}
+		else if(name == "m1"){m[1] = a->DoubleValue();}
+		else if(name == "m2"){m[2] = a->DoubleValue();}
+		else if(name == "m3"){m[3] = a->DoubleValue();}
+		else if(name == "m4"){m[4] = a->DoubleValue();}
+		else if(name == "m5"){m[5] = a->DoubleValue();}
+		else if(name == "m6"){m[6] = a->DoubleValue();}
+		else if(name == "m7"){m[7] = a->DoubleValue();}
+		else if(name == "m8"){m[8] = a->DoubleValue();}
+		else if(name == "m9"){m[9] = a->DoubleValue();}
+		else if(name == "ma"){m[10]= a->DoubleValue();}
+		else if(name == "mb"){m[11]= a->DoubleValue();}
+	}
+
+	// the first instance of each source has it as its child
+	TiXmlElement* source_element = TiXmlHandle(pElem).FirstChildElement().Element();
+	if(source_element)
+	{
+		HeeksObj* source = NULL;
+		if(std::string(source_element->Value()) == "Shape")source = ReadSourceShape(source_element);
+		else source = wxGetApp().ReadXMLElement(source_element);
+		if(source == NULL)return NULL;
+		m_sources_read[number] = new CInstanceSource(source);
+	}
+
+	std::map<int, CInstanceSource*>::iterator FindIt = m_sources_read.find(number);
+	if(FindIt == m_sources_read.end())return NULL;
+
+	CInstance* new_object = new CInstance(FindIt->second, make_matrix(m));
+	new_object->ReadBaseXML(pElem);
+	return new_object;
+}
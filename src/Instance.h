@@ -0,0 +1,72 @@
+// Instance.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "../interface/HeeksObj.h"
+
+// an object which isn't in the document, shared by the instances of it, and deleted with the last of them
+class CInstanceSource
+{
+	HeeksObj* m_object;
+	int m_num_users;
+
+public:
+	CInstanceSource(HeeksObj* object):m_object(object), m_num_users(0){}
+	~CInstanceSource(){delete m_object;}
+
+	HeeksObj* Object()const{return m_object;}
+	void AddUser(){m_num_users++;}
+	void RemoveUser(){if(--m_num_users == 0)delete this;}
+};
+
+// a copy of an object which only has its own position; the geometry, and its display lists and buffers, belong to the source.
+// used for many copies of a solid or an STL solid, so they don't each copy all the geometry.
+class CInstance: public HeeksObj
+{
+	CInstanceSource* m_source;
+
+	static std::map<CInstanceSource*, int> m_sources_written; // the number each source was written with, in this file
+	static std::map<int, CInstanceSource*> m_sources_read; // the sources read, by their number in the file
+
+public:
+	gp_Trsf m_trsf; // from the source to this
+
+	CInstance(CInstanceSource* source, const gp_Trsf &trsf = gp_Trsf());
+	CInstance(const CInstance &i);
+	~CInstance();
+
+	const CInstance& operator=(const CInstance &i);
+
+	int GetType()const{return InstanceType;}
+	long GetMarkingMask()const{return m_source->Object()->GetMarkingMask();}
+	const wxChar* GetTypeString(void)const{return _("Instance");}
+	const wxChar* GetShortString(void)const{return m_source->Object()->GetShortStringOrTypeString();}
+	const wxBitmap &GetIcon(){return m_source->Object()->GetIcon();}
+	void glCommands(bool select, bool marked, bool no_color);
+	void KillGLLists(void);
+	void GetBox(CBox &box);
+	HeeksObj *MakeACopy(void)const;
+	void ModifyByMatrix(const double *m);
+	void GetProperties(std::list<Property *> *list);
+	void GetTools(std::list<Tool*>* t_list, const wxPoint* p);
+	void GetTriangles(void(*callbackfunc)(const double* x, const double* n), double cusp, bool just_one_average_normal = true);
+	void GetSegments(void(*callbackfunc)(const double *p), double pixels_per_mm, bool want_start_point = true)const;
+	void WriteXML(TiXmlNode *root);
+
+	HeeksObj* Source()const{return m_source->Object();}
+	HeeksObj* MakeRealCopy()const; // a copy of the source, moved to here, for exporting and for the "make real" tool
+	TopoDS_Shape GetTransformedShape()const; // the source's shape moved to here, sharing its geometry; only for sources which are shapes
+
+	// copies object; solids and STL solids are copied as instances of a copy of them, which sources keeps for the next copy
+	static HeeksObj* MakeCopy(HeeksObj* object, std::map<HeeksObj*, CInstanceSource*> &sources);
+
+	// for the tools which need a solid's own geometry, like the booleans; instances of shapes are replaced undoably by separate copies
+	static std::list<HeeksObj*> MakeRealUndoably(const std::list<HeeksObj*> &list);
+	static std::list<HeeksObj*> Sources(const std::list<HeeksObj*> &list); // instances replaced by their sources, for checking the types picked
+
+	static void BeginWriting(){m_sources_written.clear();} // each source is written once in each file, with its first instance
+	static void BeginReading(){m_sources_read.clear();}
+	static HeeksObj* ReadFromXMLElement(TiXmlElement* pElem);
+};
@@ -0,0 +1,85 @@
+// MappedFile.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "MappedFile.h"
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+CMappedFile::CMappedFile(const wxChar* filepath):m_data(NULL), m_size(0)
+{
+#ifdef WIN32
+	m_mapping_handle = NULL;
+	m_file_handle = CreateFile(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(m_file_handle == INVALID_HANDLE_VALUE)
+	{
+		m_file_handle = NULL;
+		return;
+	}
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(m_file_handle, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return;
+	}
+	m_size = (size_t)size.QuadPart;
+
+	m_mapping_handle = CreateFileMapping(m_file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(m_mapping_handle == NULL)
+	{
+		Close();
+		return;
+	}
+
+	m_data = (const char*)MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	if(m_data == NULL)Close();
+#else
+	m_fd = open(Ttc(filepath), O_RDONLY);
+	if(m_fd < 0)return;
+
+	struct stat st;
+	if(fstat(m_fd, &st) != 0 || st.st_size == 0)
+	{
+		Close();
+		return;
+	}
+	m_size = (size_t)st.st_size;
+
+	void* p = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+	if(p == MAP_FAILED)
+	{
+		Close();
+		return;
+	}
+	m_data = (const char*)p;
+	madvise(p, m_size, MADV_SEQUENTIAL);
+#endif
+}
+
+CMappedFile::~CMappedFile()
+{
+	Close();
+}
+
+void CMappedFile::Close()
+{
+#ifdef WIN32
+	if(m_data)UnmapViewOfFile(m_data);
+	if(m_mapping_handle)CloseHandle(m_mapping_handle);
+	if(m_file_handle)CloseHandle(m_file_handle);
+	m_mapping_handle = NULL;
+	m_file_handle = NULL;
+#else
+	if(m_data)munmap((void*)m_data, m_size);
+	if(m_fd >= 0)close(m_fd);
+	m_fd = -1;
+#endif
+	m_data = NULL;
+	m_size = 0;
+}
@@ -0,0 +1,31 @@
+// MappedFile.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// read-only view of a whole file, mapped into memory, so big files can be parsed in place without copying
+class CMappedFile
+{
+	const char* m_data;
+	size_t m_size;
+#ifdef WIN32
+	void* m_file_handle;
+	void* m_mapping_handle;
+#else
+	int m_fd;
+#endif
+
+	// not copyable
+	CMappedFile(const CMappedFile&);
+	CMappedFile& operator=(const CMappedFile&);
+
+public:
+	CMappedFile(const wxChar* filepath);
+	~CMappedFile();
+
+	bool IsOpen()const{return m_data != NULL;}
+	const char* Data()const{return m_data;}
+	size_t Size()const{return m_size;}
+	void Close();
+};
@@ -16,6 +16,8 @@
 #include "ConversionTools.h"
 #include "SolidTools.h"
 #include "MenuSeparator.h"
+#include "Picker.h"
+#include "Ruler.h"
 using namespace std;
 
 MarkedList::MarkedList(){
@@ -111,6 +113,63 @@ void MarkedList::GrippersGLCommands(bool select, bool no_color){
 	}
 }
 
+void MarkedList::DrawForSelection(CPicker &picker){
+	// only the objects whose boxes are in the pick window are looked at
+	wxGetApp().m_view_culler.BeginDrawing(wxGetApp().m_objects);
+
+	// the types the picker knows are found on the CPU, anything else is drawn for GL_SELECT, as HeeksCADapp::glCommands would
+	for(std::list<HeeksObj*>::iterator It = wxGetApp().m_objects.begin(); It != wxGetApp().m_objects.end(); It++)
+	{
+		HeeksObj* object = *It;
+		if(!object->OnVisibleLayer() || !object->m_visible)continue;
+		if(wxGetApp().m_view_culler.IsCulled(object))continue;
+		bool marked = ObjectMarked(object);
+		if(CPicker::CanPick(object))
+		{
+			picker.PushName(object);
+			picker.Pick(object, marked);
+			picker.PopName();
+		}
+		else
+		{
+			glPushName(object->GetIndex());
+			object->glCommands(true, marked, false);
+			glPopName();
+		}
+	}
+
+	if(wxGetApp().m_show_ruler)
+	{
+		glPushName(wxGetApp().m_ruler->GetIndex());
+		wxGetApp().m_ruler->glCommands(true, false, false);
+		glPopName();
+	}
+
+	wxGetApp().m_view_culler.EndDrawing();
+
+	if(size()>0){
+		create_grippers();
+		for(std::list<Gripper*>::iterator It = move_grips.begin(); It != move_grips.end(); It++){
+			picker.PushName(*It);
+			picker.PickGripper((*It)->m_data);
+			picker.PopName();
+		}
+	}
+}
+
+void MarkedList::AddHitObject(MarkedObject* &current_found_object, bool &ignore_coords_only_found, HeeksObj* object, unsigned int min_depth, int window_size, unsigned int num_custom_names, unsigned int *custom_names){
+	if(ignore_coords_only_found || current_found_object == NULL)return;
+
+	if(ignore_coords_only && wxGetApp().m_digitizing->OnlyCoords(object)){
+		ignore_coords_only_found = true;
+	}
+	else{
+		if((object->GetType() == GripperType) || ((object->GetMarkingMask() & m_filter) && (object->GetMarkingMask() != 0))){
+			current_found_object = current_found_object->Add(object, min_depth, window_size, num_custom_names, custom_names);
+		}
+	}
+}
+
 void MarkedList::ObjectsInWindow( wxRect window, MarkedObject* marked_object, bool single_picking){
 	int buffer_length = 16384;
 	GLuint *data = (GLuint *)malloc( buffer_length * sizeof(GLuint) );
@@ -134,6 +193,7 @@ void MarkedList::ObjectsInWindow( wxRect window, MarkedObject* marked_object, bo
 			window.height = window_size * 2;
 		}
 	    GLint num_hits = -1;
+		CPicker picker;
 		while(num_hits < 0){
 			glSelectBuffer(buffer_length, data);
 			glRenderMode(GL_SELECT);
@@ -141,8 +201,8 @@ void MarkedList::ObjectsInWindow( wxRect window, MarkedObject* marked_object, bo
 			wxGetApp().m_current_viewport->SetViewport();
 			wxGetApp().m_current_viewport->m_view_point.SetPickProjection(window);
 			wxGetApp().m_current_viewport->m_view_point.SetModelview();
-			wxGetApp().glCommands(true, false, false);
-			GrippersGLCommands(true, false);
+			picker.SetFromGL();
+			DrawForSelection(picker);
 			glFlush();
 			num_hits = glRenderMode(GL_RENDER);
 			if(num_hits<0){
@@ -152,8 +212,18 @@ void MarkedList::ObjectsInWindow( wxRect window, MarkedObject* marked_object, bo
 				if(data == NULL)return;
 			}
 		}
+		int window_size = window.width;
+		for(std::list<CPicker::Hit>::iterator It = picker.m_hits.begin(); It != picker.m_hits.end(); It++)
+		{
+			MarkedObject* current_found_object = marked_object;
+			bool ignore_coords_only_found = false;
+			for(std::vector<HeeksObj*>::iterator NameIt = It->m_names.begin(); NameIt != It->m_names.end(); NameIt++)
+			{
+				AddHitObject(current_found_object, ignore_coords_only_found, *NameIt, It->m_min_depth, window_size, 0, NULL);
+			}
+		}
+
 		int pos = 0;
-		bool added = false;
 		for(unsigned i=0; i<(unsigned int)num_hits; i++)
 		{
 			unsigned int names = data[pos];
@@ -166,21 +236,7 @@ void MarkedList::ObjectsInWindow( wxRect window, MarkedObject* marked_object, bo
 			for(unsigned int j=0; j<names; j++, pos++){
 				HeeksObj *object = m_name_index.find(data[pos]);
 				bool custom_names = object->UsesCustomSubNames();
-				if(!ignore_coords_only_found && current_found_object != NULL){
-
-
-					if(ignore_coords_only && wxGetApp().m_digitizing->OnlyCoords(object)){
-						ignore_coords_only_found = true;
-					}
-					else{
-						if((object->GetType() == GripperType) || ((object->GetMarkingMask() & m_filter) && (object->GetMarkingMask() != 0))){
-							int window_size = window.width;
-							current_found_object = current_found_object->Add(object, min_depth, window_size, custom_names ? (names - 1 - j) : 0, custom_names ? (&data[pos+1]):NULL);
-							added = true;
-						}
-					}
-
-				}
+				AddHitObject(current_found_object, ignore_coords_only_found, object, min_depth, window_size, custom_names ? (names - 1 - j) : 0, custom_names ? (&data[pos+1]):NULL);
 				if(custom_names)
 				{
 					pos+=(names-j);
@@ -10,6 +10,7 @@
 
 class Gripper;
 class PointOrWindow;
+class CPicker;
 
 class MarkedList{
 private:
@@ -24,6 +25,8 @@ private:
 	void render_move_grips(bool select, bool no_color);
 	void OnChangedAdded(HeeksObj* object);
 	void OnChangedRemoved(HeeksObj* object);
+	void DrawForSelection(CPicker &picker);
+	void AddHitObject(MarkedObject* &current_found_object, bool &ignore_coords_only_found, HeeksObj* object, unsigned int min_depth, int window_size, unsigned int num_custom_names, unsigned int *custom_names);
 
 public:
 	PointOrWindow *point_or_window;
@@ -0,0 +1,94 @@
+// OffscreenRender.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "OffscreenRender.h"
+#include "GraphicsCanvas.h"
+#include "Shape.h"
+#ifdef HAVE_OSMESA
+#include <GL/osmesa.h>
+#endif
+
+bool OffscreenRenderAvailable()
+{
+#ifdef HAVE_OSMESA
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool RenderImage(wxImage &image, int width, int height, const gp_Vec &unitY, const gp_Vec &unitZ)
+{
+#ifdef HAVE_OSMESA
+	if(width <= 0 || height <= 0)return false;
+
+	OSMesaContext context = OSMesaCreateContextExt(OSMESA_RGBA, 24, 0, 0, NULL);
+	if(context == NULL)return false;
+
+	std::vector<unsigned char> pixels(width * height * 4);
+	if(!OSMesaMakeCurrent(context, &pixels[0], GL_UNSIGNED_BYTE, width, height))
+	{
+		OSMesaDestroyContext(context);
+		return false;
+	}
+
+	CViewport* old_viewport = wxGetApp().m_current_viewport;
+	{
+		CViewport viewport(width, height);
+		viewport.m_view_point.SetView(unitY, unitZ, 6);
+
+		// the solids are drawn coarsely first, then finer each time, like when the window is idle
+		for(int i = 0; i < 100; i++)
+		{
+			CShape::m_lod_refinement_pending = false;
+			viewport.glCommands();
+			if(!CShape::m_lod_refinement_pending)break;
+		}
+		glFinish();
+
+		// the display lists and buffers belong to this context
+		wxGetApp().RecalculateGLLists();
+	}
+	wxGetApp().m_current_viewport = old_viewport;
+	OSMesaDestroyContext(context);
+
+	// OSMesa's rows go from the bottom up
+	image.Create(width, height, false);
+	unsigned char* data = image.GetData();
+	for(int y = 0; y < height; y++)
+	{
+		const unsigned char* row = &pixels[(height - 1 - y) * width * 4];
+		for(int x = 0; x < width; x++, data += 3, row += 4)
+		{
+			data[0] = row[0];
+			data[1] = row[1];
+			data[2] = row[2];
+		}
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool GetStandardView(const wxString &name, gp_Vec &unitY, gp_Vec &unitZ)
+{
+	// the same as CGraphicsCanvas::OnMagXY etc.
+	wxString n = name.Lower();
+	if(n == _T("xy")){unitY = gp_Vec(0, 1, 0); unitZ = gp_Vec(0, 0, 1);}
+	else if(n == _T("xym")){unitY = gp_Vec(0, 1, 0); unitZ = gp_Vec(0, 0, -1);}
+	else if(n == _T("xz")){unitY = gp_Vec(0, 0, -1); unitZ = gp_Vec(0, 1, 0);}
+	else if(n == _T("xzm")){unitY = gp_Vec(0, 0, 1); unitZ = gp_Vec(0, -1, 0);}
+	else if(n == _T("yz")){unitY = gp_Vec(0, 1, 0); unitZ = gp_Vec(1, 0, 0);}
+	else if(n == _T("yzm")){unitY = gp_Vec(0, 1, 0); unitZ = gp_Vec(-1, 0, 0);}
+	else if(n == _T("xyz"))
+	{
+		double s = 0.5773502691896257;
+		unitY = gp_Vec(-s, s, s);
+		unitZ = gp_Vec(s, -s, s);
+	}
+	else return false;
+	return true;
+}
@@ -0,0 +1,15 @@
+// OffscreenRender.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// draws the document into an image without a window, for thumbnails.
+// it uses OSMesa, so it needs HeeksCAD built with HEEKSCAD_OSMESA; without that RenderImage returns false.
+bool OffscreenRenderAvailable();
+
+// the view is looked at like View->XY, View->XYZ etc., with everything fitted in it
+bool RenderImage(wxImage &image, int width, int height, const gp_Vec &unitY, const gp_Vec &unitZ);
+
+// "xy", "xym", "xz", "xzm", "yz", "yzm" or "xyz", like the view menu
+bool GetStandardView(const wxString &name, gp_Vec &unitY, gp_Vec &unitZ);
@@ -0,0 +1,276 @@
+// Picker.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "Picker.h"
+#include "CurvePolyline.h"
+
+// planes 0 and 1 are x = -w and x = w, 2 and 3 are for y, 4 and 5 for z; inside is where the distance isn't negative
+static double PlaneDistance(const double* c, int plane)
+{
+	int axis = plane / 2;
+	return (plane % 2 == 0) ? (c[3] + c[axis]) : (c[3] - c[axis]);
+}
+
+// a bit for each plane the point is outside of
+static int OutCode(const double* c)
+{
+	int code = 0;
+	for(int plane = 0; plane<6; plane++)
+	{
+		if(PlaneDistance(c, plane) < 0)code |= (1 << plane);
+	}
+	return code;
+}
+
+void CPicker::SetFromGL()
+{
+	double p[16], m[16];
+	glGetDoublev(GL_PROJECTION_MATRIX, p);
+	glGetDoublev(GL_MODELVIEW_MATRIX, m);
+
+	// the matrices are in column order
+	for(int col = 0; col<4; col++)
+	{
+		for(int row = 0; row<4; row++)
+		{
+			m_clip[col*4+row] = p[row] * m[col*4] + p[4+row] * m[col*4+1] + p[8+row] * m[col*4+2] + p[12+row] * m[col*4+3];
+		}
+	}
+
+	m_names.clear();
+	m_hits.clear();
+	m_hit = false;
+	m_depth_zero = false;
+}
+
+void CPicker::ToClip(const double* p, double* c)const
+{
+	for(int i = 0; i<4; i++)c[i] = m_clip[i] * p[0] + m_clip[4+i] * p[1] + m_clip[8+i] * p[2] + m_clip[12+i];
+}
+
+void CPicker::AddDepth(const double* c)
+{
+	// the window depth, with the default depth range, scaled to an unsigned int, as the selection buffer has it
+	unsigned int depth = 0;
+	if(!m_depth_zero && c[3] > 0.0)
+	{
+		double z = (c[2] / c[3]) * 0.5 + 0.5;
+		if(z < 0.0)z = 0.0;
+		if(z > 1.0)z = 1.0;
+		depth = (unsigned int)(z * 4294967295.0);
+	}
+
+	if(!m_hit || depth < m_min_depth)m_min_depth = depth;
+	m_hit = true;
+}
+
+void CPicker::AddHit()
+{
+	// OpenGL writes a hit record when the name stack changes, if anything was hit since it last changed
+	if(!m_hit)return;
+	m_hits.push_back(Hit());
+	m_hits.back().m_names = m_names;
+	m_hits.back().m_min_depth = m_min_depth;
+	m_hit = false;
+}
+
+void CPicker::PushName(HeeksObj* object)
+{
+	AddHit();
+	m_names.push_back(object);
+}
+
+void CPicker::PopName()
+{
+	AddHit();
+	if(m_names.size() > 0)m_names.pop_back();
+}
+
+void CPicker::Point(const double* p)
+{
+	double c[4];
+	ToClip(p, c);
+	if(OutCode(c) == 0)AddDepth(c);
+}
+
+void CPicker::Triangle(const double* a, const double* b, const double* c)
+{
+	double ca[4], cb[4], cc[4];
+	ToClip(a, ca);
+	ToClip(b, cb);
+	ToClip(c, cc);
+	ClipTriangle(ca, cb, cc);
+}
+
+void CPicker::ClipTriangle(const double* a, const double* b, const double* c)
+{
+	int code_a = OutCode(a);
+	int code_b = OutCode(b);
+	int code_c = OutCode(c);
+
+	// all outside one plane
+	if(code_a & code_b & code_c)return;
+
+	// all inside
+	if((code_a | code_b | code_c) == 0)
+	{
+		AddDepth(a);
+		AddDepth(b);
+		AddDepth(c);
+		return;
+	}
+
+	// cut it by each plane in turn; each plane can only add one corner
+	double polygon[2][9][4];
+	memcpy(polygon[0][0], a, 4*sizeof(double));
+	memcpy(polygon[0][1], b, 4*sizeof(double));
+	memcpy(polygon[0][2], c, 4*sizeof(double));
+	int n = 3;
+	int current = 0;
+	for(int plane = 0; plane<6; plane++)
+	{
+		double (*in)[4] = polygon[current];
+		double (*out)[4] = polygon[1 - current];
+		int num_out = 0;
+		for(int i = 0; i<n; i++)
+		{
+			const double* p = in[i];
+			const double* q = in[(i + 1) % n];
+			double dp = PlaneDistance(p, plane);
+			double dq = PlaneDistance(q, plane);
+			if(dp >= 0)memcpy(out[num_out++], p, 4*sizeof(double));
+			if((dp >= 0) != (dq >= 0))
+			{
+				double t = dp / (dp - dq);
+				for(int j = 0; j<4; j++)out[num_out][j] = p[j] + (q[j] - p[j]) * t;
+				num_out++;
+			}
+		}
+		n = num_out;
+		current = 1 - current;
+		if(n == 0)return;
+	}
+
+	for(int i = 0; i<n; i++)AddDepth(polygon[current][i]);
+}
+
+void CPicker::LineStrip(const float* points, unsigned int num_points)
+{
+	double c[2][4];
+	for(unsigned int i = 0; i<num_points; i++)
+	{
+		double p[3] = {points[i*3], points[i*3+1], points[i*3+2]};
+		ToClip(p, c[i%2]);
+		if(i == 0)continue;
+
+		// clip the line from the last point to this one
+		const double* a = c[(i+1)%2];
+		const double* b = c[i%2];
+		double t0 = 0.0, t1 = 1.0;
+		bool outside = false;
+		for(int plane = 0; plane<6; plane++)
+		{
+			double da = PlaneDistance(a, plane);
+			double db = PlaneDistance(b, plane);
+			if(da < 0 && db < 0){outside = true; break;}
+			if(da < 0){double t = da / (da - db); if(t > t0)t0 = t;}
+			else if(db < 0){double t = da / (da - db); if(t < t1)t1 = t;}
+		}
+		if(outside || t0 > t1)continue;
+
+		double e[4];
+		for(int j = 0; j<4; j++)e[j] = a[j] + (b[j] - a[j]) * t0;
+		AddDepth(e);
+		for(int j = 0; j<4; j++)e[j] = a[j] + (b[j] - a[j]) * t1;
+		AddDepth(e);
+	}
+}
+
+// static
+bool CPicker::CanPick(HeeksObj* object)
+{
+	switch(object->GetType())
+	{
+	case SolidType:
+		return ((CShape*)object)->CanPick();
+
+	case SketchType:
+	case GroupType:
+		for(HeeksObj* child = object->GetFirstChild(); child; child = object->GetNextChild())
+		{
+			if(!CanPick(child))return false;
+		}
+		return true;
+
+	default:
+		return CSketch::GetCurvePolyline(object) != NULL;
+	}
+}
+
+void CPicker::Pick(HeeksObj* object, bool marked)
+{
+	switch(object->GetType())
+	{
+	case SolidType:
+		((CShape*)object)->Pick(*this);
+		break;
+
+	case SketchType:
+	case GroupType:
+		// as ObjList::glCommands draws them
+		if(!object->m_visible)break;
+		for(HeeksObj* child = object->GetFirstChild(); child; child = object->GetNextChild())
+		{
+			if(!child->OnVisibleLayer() || !child->m_visible)continue;
+			if(wxGetApp().m_view_culler.IsCulled(child))continue;
+			PushName(child);
+			Pick(child, marked || wxGetApp().m_marked_list->ObjectMarked(child));
+			PopName();
+		}
+		break;
+
+	default:
+		PickCurve(object, marked);
+		break;
+	}
+}
+
+void CPicker::PickCurve(HeeksObj* object, bool marked)
+{
+	const CCurvePolyline* polyline = CSketch::GetCurvePolyline(object);
+	if(polyline == NULL)return;
+	const std::vector<float> &vertices = polyline->Vertices();
+	if(vertices.size() < 6)return;
+
+	// marked curves are drawn in front of everything
+	m_depth_zero = marked;
+	LineStrip(&vertices[0], (unsigned int)(vertices.size() / 3));
+	m_depth_zero = false;
+}
+
+void CPicker::PickGripper(const GripData &data)
+{
+	double p[3] = {data.m_x, data.m_y, data.m_z};
+
+	if(!wxGetApp().m_dragging_moves_objects)
+	{
+		// a bitmap at the raster position
+		Point(p);
+		return;
+	}
+
+	// the cube Gripper::glCommands draws for selecting
+	double s = 5.0 / wxGetApp().GetPixelScale();
+	static const int signs[8][3] = {{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
+	static const int triangles[12][3] = {{0, 2, 1}, {0, 3, 2}, {0, 1, 5}, {0, 5, 4}, {3, 0, 4}, {3, 4, 7}, {4, 5, 6}, {4, 6, 7}, {3, 7, 6}, {3, 6, 2}, {2, 6, 5}, {2, 5, 1}};
+	double corners[8][3];
+	for(int i = 0; i<8; i++)
+	{
+		for(int j = 0; j<3; j++)corners[i][j] = p[j] + signs[i][j] * s;
+	}
+	for(int i = 0; i<12; i++)
+	{
+		Triangle(corners[triangles[i][0]], corners[triangles[i][1]], corners[triangles[i][2]]);
+	}
+}
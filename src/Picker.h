@@ -0,0 +1,49 @@
+// Picker.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// finds what is in the pick window without drawing it, for the types whose drawing it knows: solids' faces, edges and vertices, sketches of curves, groups of these, and grippers.
+// it clips their triangles, lines and points against the pick projection, as OpenGL selection does, and makes the same hits, with the same names and depths.
+// anything else must still be drawn with GL_SELECT
+class CPicker
+{
+public:
+	class Hit
+	{
+	public:
+		std::vector<HeeksObj*> m_names;
+		unsigned int m_min_depth;
+	};
+
+private:
+	double m_clip[16]; // projection * modelview, in column order
+	std::vector<HeeksObj*> m_names; // like the OpenGL name stack
+	bool m_hit; // something has been hit since the name stack last changed
+	unsigned int m_min_depth;
+	bool m_depth_zero; // like glDepthRange(0, 0), which marked curves are drawn with
+
+	void ToClip(const double* p, double* c)const;
+	void AddDepth(const double* c);
+	void AddHit();
+	void ClipTriangle(const double* a, const double* b, const double* c);
+	void PickCurve(HeeksObj* object, bool marked);
+
+public:
+	std::list<Hit> m_hits;
+
+	CPicker():m_hit(false), m_min_depth(0), m_depth_zero(false){}
+
+	void SetFromGL(); // uses the current OpenGL matrices, which should be a pick projection
+	static bool CanPick(HeeksObj* object); // false if the object, or anything in it, has to be drawn with GL_SELECT
+	void Pick(HeeksObj* object, bool marked); // like object->glCommands(true, marked, false)
+	void PickGripper(const GripData &data); // like Gripper::glCommands
+
+	// for the objects which pick themselves
+	void PushName(HeeksObj* object);
+	void PopName();
+	void Point(const double* p);
+	void Triangle(const double* a, const double* b, const double* c);
+	void LineStrip(const float* points, unsigned int num_points);
+};
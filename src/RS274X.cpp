@@ -13,6 +13,7 @@
 #include "../interface/Geom.h"
 #include "ConversionTools.h"
 #include "Sketch.h"
+#include "WorkerPool.h"
 
 #include <sstream>
 #include <fstream>
@@ -1187,10 +1188,12 @@ bool RS274X::AggregateFaces( const TopoDS_Face lhs, const TopoDS_Face rhs, TopoD
 	}
 
     TopoDS_Shape shape;
-    TopoDS_Shape lhs_shape = BRepPrimAPI_MakePrism(lhs, gp_Vec(0,0,1));
-    TopoDS_Shape rhs_shape = BRepPrimAPI_MakePrism(rhs, gp_Vec(0,0,1));
 
+    // This runs on worker threads, so nothing Open CASCADE throws may leave here.
     try {
+        TopoDS_Shape lhs_shape = BRepPrimAPI_MakePrism(lhs, gp_Vec(0,0,1));
+        TopoDS_Shape rhs_shape = BRepPrimAPI_MakePrism(rhs, gp_Vec(0,0,1));
+
         BRepAlgo_Fuse fused( lhs_shape, rhs_shape );
         fused.Build();
         if (fused.IsDone())
@@ -1230,7 +1233,6 @@ bool RS274X::AggregateFaces( const TopoDS_Face lhs, const TopoDS_Face rhs, TopoD
         } // End if - then
     }
     catch (Standard_Failure) {
-        Handle_Standard_Failure e = Standard_Failure::Caught();
         return(l_bFailure);
     }
 
@@ -1391,22 +1393,25 @@ RS274X::Bitmap RS274X::RenderToBitmap()
     // Define a blank bitmap to represent the printed circuit board.
 	Bitmap pcb( BoundingBox() );
 
-    // Expose the PCB to the traces and aperture flashes defined by the traces.
+    // Find the areas exposed by the traces and aperture flashes defined by the traces.
+	Exposures_t exposures;
 	for (Traces_t::iterator l_itTrace = m_traces.begin(); l_itTrace != m_traces.end(); l_itTrace++ )
 	{
-	    l_itTrace->ExposeFilm( pcb );
+	    l_itTrace->Expose( exposures );
 	}
 
-    // Expose the PCB to the filled areas made up by the boundary of traces.
+    // and by the filled areas made up by the boundary of traces.
 	for (FilledAreas_t::iterator l_itArea = m_filled_areas.begin(); l_itArea != m_filled_areas.end(); l_itArea++)
 	{
 		// TODO Fill in the filled area.
 		for (Traces_t::iterator l_itTrace = l_itArea->begin(); l_itTrace != l_itArea->end(); l_itTrace++)
 		{
-		    l_itTrace->ExposeFilm( pcb );
+		    l_itTrace->Expose( exposures );
 		}
 	}
 
+	pcb.Expose( exposures );
+
 	return(pcb);
 }
 
@@ -1511,15 +1516,63 @@ void RS274X::DrawCentrelines()
 }
 
 
+/**
+	Fuses two of the networks being formed by FormNetworks().  These are done on
+	worker threads as they don't involve any HeeksObj objects.
+ */
+class RS274X::FuseFacesTask : public CWorkerTask
+{
+public:
+	FuseFacesTask( const RS274X *rs274x, const int lhs, const int rhs, const TopoDS_Face & lhs_face, const TopoDS_Face & rhs_face ) :
+		m_rs274x(rs274x), m_lhs(lhs), m_rhs(rhs), m_lhs_face(lhs_face), m_rhs_face(rhs_face), m_success(false) { }
+
+	void Run()
+	{
+		m_success = m_rs274x->AggregateFaces( m_lhs_face, m_rhs_face, &m_result );
+	}
+
+	const RS274X *m_rs274x;
+	int m_lhs;
+	int m_rhs;
+	TopoDS_Face m_lhs_face;
+	TopoDS_Face m_rhs_face;
+	TopoDS_Face m_result;
+	bool m_success;
+};
+
+// A join between two networks whose faces couldn't be fused, and how many fuses each network had had then; see FormNetworks()
+class FailedJoin
+{
+public:
+	std::pair<int, int> m_join;
+	int m_lhs;
+	int m_rhs;
+	int m_lhs_fuses;
+	int m_rhs_fuses;
+
+	FailedJoin( const std::pair<int, int> & join, int lhs, int rhs, int lhs_fuses, int rhs_fuses ) :
+		m_join(join), m_lhs(lhs), m_rhs(rhs), m_lhs_fuses(lhs_fuses), m_rhs_fuses(rhs_fuses) { }
+};
+
+// returns the index of the face which represents the network that face_index is in; see FormNetworks()
+static int FindNetwork( std::vector<int> & networks, int face_index )
+{
+	while (networks[face_index] != face_index)
+	{
+		networks[face_index] = networks[networks[face_index]];
+		face_index = networks[face_index];
+	}
+
+	return(face_index);
+}
+
 int RS274X::FormNetworks()
 {
 	// Now aggregate the traces based on how they intersect each other.  We want all traces
 	// that touch to become one large object.
-    Faces_t faces;
+	std::vector<TopoDS_Face> faces;
     int number_of_networks = 0;
 
-    static std::list<HeeksObj *> objects;
-
     for (Traces_t::iterator l_itTrace = m_traces.begin(); l_itTrace != m_traces.end(); l_itTrace++ )
 	{
         faces.push_back(l_itTrace->Face());
@@ -1534,68 +1587,156 @@ int RS274X::FormNetworks()
 	    }
 	}
 
-    // We have a list of faces that represent all the copper areas we want.  We now need to intersect
-	// all the touching faces to produce a single (larger) face.  The ones that intersect each other
-	// should be replaced by the larger (combined) face.  We should repeat this until we find no
-	// further intersecting faces.
+    // We have a list of faces that represent all the copper areas we want.  We now need to find
+	// which faces touch each other.  Only faces whose bounding boxes overlap can touch, so we
+	// sweep across the board in X, keeping the faces whose boxes are under the sweep line, and
+	// only compare each face with those.  Faces that are already known to be in the same network
+	// don't need to be compared.
 
+	const int number_of_faces = int(faces.size());
+	std::vector<Bnd_Box> boxes(number_of_faces);
+	std::vector< std::pair<double, int> > sweep_order;	// min X and face index
+	for (int i=0; i<number_of_faces; i++)
+	{
+		BRepBndLib::Add(faces[i], boxes[i]);
+		if (boxes[i].IsVoid()) continue;
 
-    while (faces.size() > 1)
-    {
-        // Join all other faces to the first one.  Keep joining until we can't find any to join.
-        bool joins_made = false;
-        std::list<Faces_t::iterator> already_joined;
-        Faces_t::iterator itFace = faces.begin(); itFace++;
-        for ( ; (! joins_made) && (itFace != faces.end()); itFace++)
-        {
-            if (FacesIntersect( *(faces.begin()), *itFace ))
-            {
-                TopoDS_Face combination;
-                if (AggregateFaces(*(faces.begin()), *itFace, &combination))
-                {
-                    *(faces.begin()) = combination;
-                    joins_made = true;
-                    already_joined.push_back(itFace);
-                }
-            } // End if - then
-        } // End for
+		Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+		boxes[i].Get( xmin, ymin, zmin, xmax, ymax, zmax );
+		sweep_order.push_back( std::make_pair( xmin, i ) );
+	}
+	std::sort( sweep_order.begin(), sweep_order.end() );
 
-        for (std::list<Faces_t::iterator>::iterator itRemove = already_joined.begin(); itRemove != already_joined.end(); itRemove++)
-        {
-            faces.erase( *itRemove );
-        }
+	// Each face points to another in its network, ending with the face that represents the network.
+	std::vector<int> networks(number_of_faces);
+	for (int i=0; i<number_of_faces; i++) networks[i] = i;
 
-        if (joins_made == false)
-        {
-            // This is as big as it's ever going to get.
-			TopoDS_Face face(*(faces.begin()));
+	std::list< std::pair<int, int> > joins;	// The pairs of faces that joined two networks, in the order found.
+	std::list< std::pair<double, int> > active;	// max X and face index, for the faces under the sweep line.
+	for (std::vector< std::pair<double, int> >::iterator itFace = sweep_order.begin(); itFace != sweep_order.end(); itFace++)
+	{
+		const int face_index = itFace->second;
 
-            HeeksObj *sketch = this->Sketch( face );
-            for (int i=0; (((CSketch *)sketch)->GetSketchOrder() != SketchOrderTypeCloseCCW) && (i<4); i++)
-            {
-                ((CSketch *)sketch)->ReOrderSketch( SketchOrderTypeCloseCCW );  // At least try to make them all consistently oriented.
-            }
+		for (std::list< std::pair<double, int> >::iterator itActive = active.begin(); itActive != active.end(); )
+		{
+			if (itActive->first < itFace->first)
+			{
+				// This one is behind the sweep line now.
+				itActive = active.erase(itActive);
+				continue;
+			}
 
-			if (m_mirror_image)
+			const int other_index = itActive->second;
+			itActive++;
+
+			if (boxes[face_index].IsOut(boxes[other_index])) continue;
+
+			int network = FindNetwork( networks, face_index );
+			int other_network = FindNetwork( networks, other_index );
+			if (network == other_network) continue;
+
+			if (FacesIntersect( faces[other_index], faces[face_index] ))
 			{
-				double mirror[16];
-				gp_Ax1 mirror_axis = gp_Ax1(gp_Pnt(0,0,0), gp_Dir(1,0,0));
-				gp_Trsf rotation;
-				rotation.SetRotation( mirror_axis, M_PI );
-				extract(rotation, mirror);
-				sketch->ModifyByMatrix(mirror);
+				networks[std::max(network, other_network)] = std::min(network, other_network);
+				joins.push_back( std::make_pair( other_index, face_index ) );
 			}
+		}
 
-            wxGetApp().AddUndoably( sketch, NULL, NULL );
-            number_of_networks++;
+		Standard_Real xmin, ymin, zmin, xmax, ymax, zmax;
+		boxes[face_index].Get( xmin, ymin, zmin, xmax, ymax, zmax );
+		active.push_back( std::make_pair( xmax, face_index ) );
+	}
 
-            faces.erase( faces.begin() );
-        }
-    } // End while
+	// Now fuse the faces of each network together, in rounds.  In each round, every network
+	// fuses with at most one other, so the fusing is done in a balanced way, rather than adding
+	// one small face at a time to a large one, and the fusing in each round is done on all the
+	// processors.  If two networks can't be fused, their join is tried again once either of them
+	// has grown, as adding the faces to a network one at a time would have done.  If they still
+	// can't be fused when nothing else can, they stay separate, as they did before.
 
-	if (faces.size() > 0)
+	for (int i=0; i<number_of_faces; i++) networks[i] = i;
+	std::vector<int> fuses(number_of_faces, 0);	// The number of fuses made into each network's face.
+	std::list<FailedJoin> failed_joins;
+
+	while (joins.size() > 0)
+	{
+		std::set<int> fusing;
+		std::vector<CWorkerTask *> tasks;
+		std::vector< std::pair<int, int> > task_joins;
+
+		for (std::list< std::pair<int, int> >::iterator itJoin = joins.begin(); itJoin != joins.end(); )
+		{
+			int lhs = FindNetwork( networks, itJoin->first );
+			int rhs = FindNetwork( networks, itJoin->second );
+			if (lhs > rhs) std::swap( lhs, rhs );
+
+			if (lhs == rhs)
+			{
+				itJoin = joins.erase(itJoin);
+				continue;
+			}
+
+			if ((fusing.find(lhs) != fusing.end()) || (fusing.find(rhs) != fusing.end()))
+			{
+				// Leave this one for the next round.
+				itJoin++;
+				continue;
+			}
+
+			fusing.insert(lhs);
+			fusing.insert(rhs);
+			tasks.push_back( new FuseFacesTask( this, lhs, rhs, faces[lhs], faces[rhs] ) );
+			task_joins.push_back( *itJoin );
+			itJoin = joins.erase(itJoin);
+		}
+
+		CWorkerPool::Run(tasks);
+
+		for (unsigned int i=0; i<tasks.size(); i++)
+		{
+			FuseFacesTask *task = (FuseFacesTask *) tasks[i];
+			if (task->m_success)
+			{
+				faces[task->m_lhs] = task->m_result;
+				networks[task->m_rhs] = task->m_lhs;
+				fuses[task->m_lhs]++;
+			}
+			else
+			{
+				failed_joins.push_back( FailedJoin( task_joins[i], task->m_lhs, task->m_rhs, fuses[task->m_lhs], fuses[task->m_rhs] ) );
+			}
+			delete task;
+		}
+
+		if (joins.size() == 0)
+		{
+			// Try the failed joins again where either network has been fused with another since.
+			for (std::list<FailedJoin>::iterator itFailed = failed_joins.begin(); itFailed != failed_joins.end(); )
+			{
+				int lhs = FindNetwork( networks, itFailed->m_join.first );
+				int rhs = FindNetwork( networks, itFailed->m_join.second );
+				if (lhs > rhs) std::swap( lhs, rhs );
+
+				if (lhs == rhs)
+				{
+					itFailed = failed_joins.erase(itFailed);
+				}
+				else if ((lhs != itFailed->m_lhs) || (rhs != itFailed->m_rhs) || (fuses[lhs] != itFailed->m_lhs_fuses) || (fuses[rhs] != itFailed->m_rhs_fuses))
+				{
+					joins.push_back( itFailed->m_join );
+					itFailed = failed_joins.erase(itFailed);
+				}
+				else itFailed++;
+			}
+		}
+	}
+
+	// Each face that still represents a network is as big as it's ever going to get.
+	for (int face_index=0; face_index<number_of_faces; face_index++)
 	{
-		TopoDS_Face face(*(faces.begin()));
+		if (networks[face_index] != face_index) continue;
+
+		TopoDS_Face face(faces[face_index]);
 
 	    HeeksObj *sketch = this->Sketch( face );
 	    for (int i=0; (((CSketch *)sketch)->GetSketchOrder() != SketchOrderTypeCloseCCW) && (i<4); i++)
@@ -1615,7 +1756,6 @@ int RS274X::FormNetworks()
 
 		wxGetApp().AddUndoably( sketch, NULL, NULL );
 		number_of_networks++;
-        faces.erase( faces.begin() );
 	}
 
     return(number_of_networks);
@@ -2276,83 +2416,62 @@ TopoDS_Face RS274X::Trace::Face() const
 }
 
 
-void RS274X::Trace::ExposeFilm( RS274X::Bitmap & pcb )
+void RS274X::Trace::Expose( RS274X::Exposures_t & exposures ) const
 {
 	switch (Interpolation())
 	{
 		case eLinear:
 		{
-			//it's a line.  Expose the aperture at one-pixel spacing along the line's path.
-			unsigned int number_of_points = (unsigned int) (floor(Length() * Bitmap::PixelsPerMM()));
-			for (unsigned int i=0; i<number_of_points; i++)
-			{
-			    double x = (double(double(i) / double(number_of_points)) * (End().X() - Start().X())) + Start().X();
-			    double y = (double(double(i) / double(number_of_points)) * (End().Y() - Start().Y())) + Start().Y();
-
-				pcb.ExposeFilm( *(m_aperture.GetBitmap()), gp_Pnt( x, y, 0.0 ) );
-			} // End for
-
+			m_aperture.Expose( Start(), End(), exposures );
 			return;
 		}
 
 		case eCircular:
 		{
+			double start_angle, end_angle;
 			if ((abs(m_i_term) < m_tolerance) && (abs(m_j_term) < m_tolerance) && (Radius() > m_tolerance))
 			{
 				// It's a full circle.
-				unsigned int i = 0;
-				unsigned int number_of_points = (unsigned int) (floor(Length() * Bitmap::PixelsPerMM()));
-				double alpha = 3.1415926 * 2 / number_of_points;
-				while( i++ < number_of_points )
-				{
-					double theta = alpha * i;
-
-					double x = (cos( theta ) * Radius()) + Centre().X();
-					double y = (sin( theta ) * Radius()) + Centre().Y();
-
-					pcb.ExposeFilm( *(m_aperture.GetBitmap()), gp_Pnt( x, y, 0 ));
-				} // End while
-				return;
+				start_angle = 0.0;
+				end_angle = 2.0 * M_PI;
+			}
+			else if (Clockwise())
+			{
+			    // We're turning clockwise so the end_angle is smaller than the start_angle.
+				start_angle = EndAngle();
+				end_angle = StartAngle();
 			}
 			else
 			{
-				// It's an arc
-				if (Clockwise())
-				{
-				    // We're turning clockwise so we want the end_angle to be smaller than the start_angle.
-					double increment = (StartAngle() - EndAngle()) / (Length() * Bitmap::PixelsPerMM());
-					for (double angle = EndAngle(); angle <= StartAngle(); angle += increment)
-					{
-						double x = (cos( angle ) * Radius()) + Centre().X();
-						double y = (sin( angle ) * Radius()) + Centre().Y();
+				start_angle = StartAngle();
+				end_angle = EndAngle();
+			}
 
-						pcb.ExposeFilm( *(m_aperture.GetBitmap()), gp_Pnt( x, y, 0 ));
-					} // End for
-					return;
-				} // End if - then
-				else
-				{
-					// Counter-Clockwise
-					// We're turning clockwise so we want the start_angle to be smaller than the end_angle.
-					double increment = (EndAngle() - StartAngle()) / (Length() * Bitmap::PixelsPerMM());
-					for (double angle = StartAngle(); angle <= EndAngle(); angle += increment)
-					{
-						double x = (cos( angle ) * Radius()) + Centre().X();
-						double y = (sin( angle ) * Radius()) + Centre().Y();
+			// Split the arc into lines that are never more than a quarter of a pixel away from it.
+			double tolerance = 0.25 * Bitmap::MMPerPixel();
+			int number_of_lines = 1;
+			if (Radius() > tolerance)
+			{
+				double max_angle = 2.0 * acos( 1.0 - (tolerance / Radius()) );
+				number_of_lines = int(ceil( (end_angle - start_angle) / max_angle ));
+				if (number_of_lines < 1) number_of_lines = 1;
+			}
 
-						pcb.ExposeFilm( *(m_aperture.GetBitmap()), gp_Pnt( x, y, 0 ));
-					} // End for
-				} // End if - else
-				return;
+			gp_Pnt centre = Centre();
+			gp_Pnt previous( centre.X() + (cos( start_angle ) * Radius()), centre.Y() + (sin( start_angle ) * Radius()), 0.0 );
+			for (int i=1; i<=number_of_lines; i++)
+			{
+				double angle = start_angle + ((end_angle - start_angle) * double(i) / double(number_of_lines));
+				gp_Pnt point( centre.X() + (cos( angle ) * Radius()), centre.Y() + (sin( angle ) * Radius()), 0.0 );
+				m_aperture.Expose( previous, point, exposures );
+				previous = point;
 			}
-			break;
+			return;
 		}
 
 		case eFlash:
 		{
-			gp_Pnt point(Start());
-
-			pcb.ExposeFilm( *(m_aperture.GetBitmap()), point );
+			m_aperture.Expose( Start(), Start(), exposures );
 			return;
 		}
 	} // End switch
@@ -2361,60 +2480,42 @@ void RS274X::Trace::ExposeFilm( RS274X::Bitmap & pcb )
 
 
 
-const RS274X::Bitmap *RS274X::Aperture::GetBitmap()
+void RS274X::Aperture::Expose( const gp_Pnt & start, const gp_Pnt & end, RS274X::Exposures_t & exposures ) const
 {
-	if (m_pBitmap.get() != NULL)
-	{
-		return(m_pBitmap.get());
-	}
+	const bool moves = (start.Distance(end) > 0.0);
 
 	switch (m_type)
 	{
 		case eCircular:
 		{
-			m_pBitmap = std::auto_ptr<Bitmap>(new Bitmap( BoundingBox() ));
-
-			// We need to fill in a solid circle.  Start from the centre and a small radius
-			// and run around the circle marking pixels black.  Then increase the radius
-			// and repeat.  This goes all the way up to the final radius.  The number of
-			// steps around the circle and the increase in radius is all down to the resolution
-			// of the bitmap.
-
-			double radius = OutsideDiameter() / 2.0;
-			for (double x=-1.0 * radius; x<= radius; x += Bitmap::MMPerPixel())
-			{
-				for (double y=-1.0 * radius; y<= radius; y += Bitmap::MMPerPixel())
-				{
-					double distance = (double) sqrt( double(double(x * x) + double(y * y)) );
-					if (distance <= OutsideDiameter() / 2.0)
-					{
-						m_pBitmap->operator ()(x, y) = ~0;	// black.
-					} // End if - then
-				} // End for
-			} // End for
-
-			return(m_pBitmap.get());
+			Exposure exposure( OutsideDiameter() / 2.0 );
+			exposure.Add( start.X(), start.Y() );
+			if (moves) exposure.Add( end.X(), end.Y() );
+			exposures.push_back( exposure );
+			return;
 		}
 
 		case eRectangular:
 		{
-			m_pBitmap = std::auto_ptr<Bitmap>(new Bitmap( BoundingBox() ));
+			double half_width = XAxisOutsideDimension() / 2.0;
+			double half_height = YAxisOutsideDimension() / 2.0;
 
-			for (double x=-1.0 * XAxisOutsideDimension() / 2.0; x< +1.0 * XAxisOutsideDimension() / 2.0; x += Bitmap::MMPerPixel())
+			Exposure exposure( 0.0 );
+			for (int i=0; i<(moves ? 2 : 1); i++)
 			{
-				for (double y=-1.0 * YAxisOutsideDimension() / 2.0; y<+1.0 * YAxisOutsideDimension() / 2.0; y += Bitmap::MMPerPixel())
-				{
-					m_pBitmap->operator ()( x, y ) = ~0;	// Black.
-				} // End for
-			} // End for
-
-			return(m_pBitmap.get());
+				const gp_Pnt & location = (i == 0) ? start : end;
+				exposure.Add( location.X() - half_width, location.Y() - half_height );
+				exposure.Add( location.X() + half_width, location.Y() - half_height );
+				exposure.Add( location.X() + half_width, location.Y() + half_height );
+				exposure.Add( location.X() - half_width, location.Y() + half_height );
+			}
+			exposures.push_back( exposure );
+			return;
 		}
 
 		default:
-			printf("Unsupported aperture shape found\n");
-			m_pBitmap = std::auto_ptr<Bitmap>(new Bitmap( BoundingBox() ));
-			return(m_pBitmap.get());
+			// Unsupported aperture shape.
+			return;
 	} // End switch
 }
 
@@ -2570,14 +2671,17 @@ bool RS274X::Bitmap::Save( const wxString file_name ) const
 		return(failure);
 	}
 
-	for (int row=PixelsPerColumn(); row>=0; row--)  // Raster images have positive Y from the top down where we use bottom up.
+	std::vector<char> rgb( PixelsPerRow() * 3 );
+	for (int row=PixelsPerColumn()-1; row>=0; row--)  // Raster images have positive Y from the top down where we use bottom up.
 	{
+		const char *pixels = Row(row);
 	    for (int col=0; col < PixelsPerRow(); col++)
 	    {
-	        fputc( m_bitmap[ (row * PixelsPerRow()) + col ], fp );	// Red
-	        fputc( m_bitmap[ (row * PixelsPerRow()) + col ], fp );	// Green
-	        fputc( m_bitmap[ (row * PixelsPerRow()) + col ], fp );	// Blue
+	        rgb[(col * 3) + 0] = pixels[col];	// Red
+	        rgb[(col * 3) + 1] = pixels[col];	// Green
+	        rgb[(col * 3) + 2] = pixels[col];	// Blue
 	    }
+		if (rgb.size() > 0) fwrite( &rgb[0], 1, rgb.size(), fp );
 	}
 
 	fclose(fp);
@@ -2613,59 +2717,168 @@ bool RS274X::Bitmap::Save( const wxString file_name ) const
 } // End Save() method
 
 
-static double proportion( const double width, const int total_pixels, const int pixel )
+double RS274X::Exposure::MinY() const
 {
-    double _total_pixels(total_pixels);
-    double _pixel(pixel);
+	double min_y = m_y[0];
+	for (int i=1; i<m_number_of_points; i++) if (m_y[i] < min_y) min_y = m_y[i];
+	return(min_y - m_radius);
+}
 
-    return(((_total_pixels - _pixel) / _total_pixels) * width);
+double RS274X::Exposure::MaxY() const
+{
+	double max_y = m_y[0];
+	for (int i=1; i<m_number_of_points; i++) if (m_y[i] > max_y) max_y = m_y[i];
+	return(max_y + m_radius);
 }
 
+// Include where the line from a to b crosses y in the span.
+static void IncludeCrossing( const double ax, const double ay, const double bx, const double by, const double y, bool *pFound, double *pMinX, double *pMaxX )
+{
+	if ((y < ay) && (y < by)) return;
+	if ((y > ay) && (y > by)) return;
+
+	double x1 = ax, x2 = bx;
+	if (ay != by)
+	{
+		x1 = x2 = ax + ((y - ay) * (bx - ax) / (by - ay));
+	}
+
+	if (! *pFound)
+	{
+		*pMinX = x1; *pMaxX = x1;
+		*pFound = true;
+	}
 
+	if (x1 < *pMinX) *pMinX = x1;
+	if (x2 < *pMinX) *pMinX = x2;
+	if (x1 > *pMaxX) *pMaxX = x1;
+	if (x2 > *pMaxX) *pMaxX = x2;
+}
 
-bool RS274X::Bitmap::ExposeFilm( const Bitmap & pattern, const gp_Pnt & location )
+bool RS274X::Exposure::Span( const double y, double *pMinX, double *pMaxX ) const
 {
-    const bool success = true;
-    const bool failure = false;
+	// The edge of the exposure is made of the circles around the points and the edges of the
+	// lines between the points, grown by the radius, so the span is the furthest any of those
+	// go each way along the row.
+	bool found = false;
 
-    if ((pattern.Width() >= Width()) || (pattern.Height() >= Height()))
-    {
-        printf("Pattern is smaller than this bitmap\n");
-        return(failure);
-    }
+	for (int i=0; i<m_number_of_points; i++)
+	{
+		double dy = y - m_y[i];
+		if ((m_radius > 0.0) && (fabs(dy) <= m_radius))
+		{
+			double dx = sqrt((m_radius * m_radius) - (dy * dy));
+			IncludeCrossing( m_x[i] - dx, y, m_x[i] + dx, y, y, &found, pMinX, pMaxX );
+		}
 
-    // The real-world coordinates of 'this' bitmap have the 0,0 point at the bottom left
-    // corner while the 0,0 point of the rhs map is in the centre.  This assumes that the
-    // rhs bitmap represents an aperture while 'this' one represents the PCB.
+		for (int j=i+1; j<m_number_of_points; j++)
+		{
+			if (m_radius > 0.0)
+			{
+				double vx = m_x[j] - m_x[i];
+				double vy = m_y[j] - m_y[i];
+				double length = sqrt((vx * vx) + (vy * vy));
+				if (length <= 0.0) continue;
+
+				double nx = -vy * m_radius / length;
+				double ny = vx * m_radius / length;
+				IncludeCrossing( m_x[i] + nx, m_y[i] + ny, m_x[j] + nx, m_y[j] + ny, y, &found, pMinX, pMaxX );
+				IncludeCrossing( m_x[i] - nx, m_y[i] - ny, m_x[j] - nx, m_y[j] - ny, y, &found, pMinX, pMaxX );
+			}
+			else
+			{
+				IncludeCrossing( m_x[i], m_y[i], m_x[j], m_y[j], y, &found, pMinX, pMaxX );
+			}
+		}
+	}
 
-    for (int pattern_row = 0; pattern_row < pattern.PixelsPerRow(); pattern_row++)
-    {
-        for (int pattern_col = 0; pattern_col < pattern.PixelsPerColumn(); pattern_col++)
-        {
-            double pattern_offset_x = proportion( pattern.Width(), pattern.PixelsPerRow(), pattern_row ) - (0.5 * pattern.Width());
-            double pattern_offset_y = proportion( pattern.Height(), pattern.PixelsPerColumn(), pattern_col) - (0.5 * pattern.Height());
+	return(found);
+}
 
-            int row = int(floor(double((location.Y() + pattern_offset_y - m_box.MinY()) * PixelsPerMM()))) + Boarder();
-            int col = int(floor(double((location.X() + pattern_offset_x - m_box.MinX()) * PixelsPerMM()))) + Boarder();
 
-            int pixel = int(floor(double((PixelsPerRow() * row) + col)));
-            if ((pixel < 0) || (pixel > Size()-1))
-            {
-                printf("Pixel is out of range for bitmap\n");
-                return(false);
-            }
+/**
+	Exposes one band of a bitmap's rows to the exposures that cross it.  Each band has
+	its own rows so these can be run on all the processors at once.
+ */
+class RS274X::Bitmap::ExposeRowsTask : public CWorkerTask
+{
+public:
+	ExposeRowsTask( Bitmap *pBitmap, const Exposures_t *pExposures, const std::vector<int> *pIndexes, const int first_row, const int end_row ) :
+		m_pBitmap(pBitmap), m_pExposures(pExposures), m_pIndexes(pIndexes), m_first_row(first_row), m_end_row(end_row) { }
 
-            int pattern_pixel = (pattern.PixelsPerRow() * pattern_row) + pattern_col;
-            if ((pattern_pixel < 0) || (pattern_pixel > Size()-1))
-            {
-                printf("Pixel is out of range for pattern's bitmap\n");
-                return(false);
-            }
+	void Run()
+	{
+		const int pixels_per_row = m_pBitmap->PixelsPerRow();
+		const double min_x = m_pBitmap->m_box.MinX();
+		const double min_y = m_pBitmap->m_box.MinY();
 
-            m_bitmap[pixel] |= pattern.m_bitmap[ pattern_pixel ];
-        }
-    }
+		for (int row = m_first_row; row < m_end_row; row++)
+		{
+			// Each pixel is exposed if its centre is.
+			const double y = min_y + ((double(row) + 0.5) * MMPerPixel());
+			char *pixels = m_pBitmap->Row(row);
 
-    return(success);
-}
+			for (std::vector<int>::const_iterator l_itIndex = m_pIndexes->begin(); l_itIndex != m_pIndexes->end(); l_itIndex++)
+			{
+				double span_min_x, span_max_x;
+				if (! (*m_pExposures)[*l_itIndex].Span( y, &span_min_x, &span_max_x )) continue;
+
+				int first_col = int(ceil(((span_min_x - min_x) * PixelsPerMM()) - 0.5));
+				int last_col = int(floor(((span_max_x - min_x) * PixelsPerMM()) - 0.5));
+				if (first_col < 0) first_col = 0;
+				if (last_col > pixels_per_row - 1) last_col = pixels_per_row - 1;
+				if (first_col > last_col) continue;
+
+				memset( pixels + first_col, ~0, last_col - first_col + 1 );	// Black.
+			}
+		}
+	}
+
+private:
+	Bitmap *m_pBitmap;
+	const Exposures_t *m_pExposures;
+	const std::vector<int> *m_pIndexes;
+	int m_first_row;
+	int m_end_row;
+};
+
+void RS274X::Bitmap::Expose( const RS274X::Exposures_t & exposures )
+{
+	if (m_bitmap == NULL) return;
+
+	// Sort the exposures into bands of rows, so each band only looks at the ones that cross it.
+	const int rows_per_band = 64;
+	const int number_of_rows = PixelsPerColumn();
+	const int number_of_bands = (number_of_rows + rows_per_band - 1) / rows_per_band;
+	std::vector< std::vector<int> > bands(number_of_bands);
+
+	for (int i=0; i<int(exposures.size()); i++)
+	{
+		int first_row = int(floor(((exposures[i].MinY() - m_box.MinY()) * PixelsPerMM()) - 0.5));
+		int last_row = int(ceil(((exposures[i].MaxY() - m_box.MinY()) * PixelsPerMM()) - 0.5));
+		if (first_row < 0) first_row = 0;
+		if (last_row > number_of_rows - 1) last_row = number_of_rows - 1;
 
+		for (int band = first_row / rows_per_band; (first_row <= last_row) && (band <= last_row / rows_per_band); band++)
+		{
+			bands[band].push_back(i);
+		}
+	}
+
+	std::vector<CWorkerTask *> tasks;
+	for (int band=0; band<number_of_bands; band++)
+	{
+		if (bands[band].size() == 0) continue;
+
+		int end_row = (band + 1) * rows_per_band;
+		if (end_row > number_of_rows) end_row = number_of_rows;
+		tasks.push_back( new ExposeRowsTask( this, &exposures, &bands[band], band * rows_per_band, end_row ) );
+	}
+
+	CWorkerPool::Run(tasks);
+
+	for (std::vector<CWorkerTask *>::iterator l_itTask = tasks.begin(); l_itTask != tasks.end(); l_itTask++)
+	{
+		delete *l_itTask;
+	}
+}
@@ -11,6 +11,7 @@ for isolation milling.
 
 #include <string>
 #include <list>
+#include <vector>
 #include <map>
 #include <algorithm>
 #include <iostream>
@@ -93,8 +94,38 @@ class RS274X
 
 	private:
 		/**
-			The Bitmap class defines an array of colour values surrounding a CENTRAL
-			position.  i.e. the position of a bitmap is defined as its centre point.
+			An Exposure is a convex part of the film that is exposed by a trace.  It is
+			the convex hull of its points, grown by its radius.  A line drawn with a
+			circular aperture is its two end points and the aperture's radius.  A line
+			drawn with a rectangular aperture is the rectangle's corners at both ends,
+			with no radius.  Arcs are split into lines that are short enough for the
+			difference to be less than a pixel.
+		 */
+		class Exposure
+		{
+		public:
+			Exposure( const double radius ) : m_number_of_points(0), m_radius(radius) { }
+
+			void Add( const double x, const double y ) { m_x[m_number_of_points] = x; m_y[m_number_of_points] = y; m_number_of_points++; }
+
+			double MinY() const;
+			double MaxY() const;
+
+			// Find where the row of pixels at y crosses this exposure.
+			bool Span( const double y, double *pMinX, double *pMaxX ) const;
+
+		private:
+			double m_x[8];
+			double m_y[8];
+			int m_number_of_points;
+			double m_radius;
+		}; // End Exposure class definition.
+
+		typedef std::vector<Exposure> Exposures_t;
+
+		/**
+			The Bitmap class defines an array of pixels covering a bounding box, with a
+			boarder of a few pixels all around it.
 		 */
 		class Bitmap
 		{
@@ -195,20 +226,20 @@ class RS274X
 
 			int Size() const { return((PixelsPerRow() + Boarder() + Boarder()) * (PixelsPerColumn() + Boarder() + Boarder())); }
 
-			// Return the pixel value for the real-world coordinates passed in.  Take note
-			// that the real-world 0,0 point is in the centre of the bitmap array.
-			char & operator() ( const double x, const double y ) const
-			{
-				int pixel_x = int(floor((x - m_box.MinX()) * PixelsPerMM()) + ((m_box.Width()  * PixelsPerMM()) / 2.0)) + Boarder();
-				int pixel_y = int(floor((y - m_box.MinY()) * PixelsPerMM()) + ((m_box.Height() * PixelsPerMM()) / 2.0)) + Boarder();
+			int Stride() const { return(PixelsPerRow() + Boarder() + Boarder()); }
 
-				return(m_bitmap[(PixelsPerRow() * pixel_y) + pixel_x]);
-			}
+			// Return the pixels of one row, from 0 at the bottom of the bounding box.  The
+			// first pixel is at the left of the bounding box.
+			char *Row( const int row ) const { return(m_bitmap + ((row + Boarder()) * Stride()) + Boarder()); }
 
-			bool ExposeFilm( const Bitmap & pattern, const gp_Pnt & location );
+			// Expose the film to all the exposures.  This is done a band of rows at a time,
+			// on all the processors.
+			void Expose( const Exposures_t & exposures );
 			bool Save( const wxString file_name ) const;
 
 		private:
+			class ExposeRowsTask;
+
 			CBox m_box;
 
 			char *m_bitmap;
@@ -295,7 +326,8 @@ class RS274X
 				TopoDS_Face Face(const gp_Pnt & location) const;
 				TopoDS_Shape Shape(const gp_Pnt & location) const;
 
-				const Bitmap *GetBitmap();
+				// Add the exposure of this aperture being moved in a straight line from start to end.
+				void Expose( const gp_Pnt & start, const gp_Pnt & end, Exposures_t & exposures ) const;
 				CBox BoundingBox() const;
 
 			private:
@@ -312,8 +344,6 @@ class RS274X
 
 				// For polygon
 				double m_degree_of_rotation;
-
-				std::auto_ptr<Bitmap>	m_pBitmap;
 		}; // End Aperture class defintion.
 
 
@@ -379,7 +409,7 @@ class RS274X
 			bool Intersects( const Trace & rhs ) const;
 			bool PointWithinBoundary( const gp_Pnt & point, const gp_Pnt & start, const gp_Pnt & end ) const;
 
-			void ExposeFilm( Bitmap & pcb );
+			void Expose( Exposures_t & exposures ) const;
 			CBox BoundingBox() const;
 
 		private:
@@ -450,6 +480,7 @@ class RS274X
 		static HeeksObj *Sketch( const TopoDS_Face face );
 		static bool FacesIntersect( const TopoDS_Face lhs, const TopoDS_Face rhs );
 
+		class FuseFacesTask;
 		int FormNetworks();
 		void DrawCentrelines();
 		Bitmap RenderToBitmap();
@@ -128,15 +128,12 @@ void ManyRemoveOrAddTool::Add()
 
 void ManyRemoveOrAddTool::Remove()
 {
-	std::list<HeeksObj*>::iterator It;
-	for(It = m_objects.begin(); It != m_objects.end(); It++){
-		HeeksObj* object = *It;
-		m_owner->Remove(object);
-		wxGetApp().m_marked_list->Remove(object, false);
-	}
+	// removed all at once, so the owner's list is only looked through once; WereRemoved takes them out of the marked list
+	m_owner->Remove(m_objects);
 
 	wxGetApp().WereRemoved(m_objects);
 	wxGetApp().WasModified(m_owner);
+	std::list<HeeksObj*>::iterator It;
 	for(It = m_objects.begin(); It != m_objects.end(); It++){
 		HeeksObj* object = *It;
 		object->m_owner = NULL;
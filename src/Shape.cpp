@@ -7,6 +7,7 @@
 #include "Wire.h"
 #include "Group.h"
 #include "Face.h"
+#include "FaceTools.h"
 #include "Edge.h"
 #include "Vertex.h"
 #include "Loop.h"
@@ -14,6 +15,9 @@
 #include "Cuboid.h"
 #include "Sphere.h"
 #include "Cone.h"
+#include "Instance.h"
+#include "ShapeBox.h"
+#include "Picker.h"
 #include "HeeksFrame.h"
 #include "MarkedList.h"
 #include "../interface/Tool.h"
@@ -26,10 +30,20 @@
 
 // static member variable
 bool CShape::m_solids_found = false;
+wxLongLong CShape::m_lod_frame_start = 0;
+bool CShape::m_lod_refinement_pending = false;
+
+// each level of detail has this many times smaller deflection than the one before
+#define LOD_DEFLECTION_RATIO 8.0
+
+// the coarsest level's deflection, as a fraction of the size of the shape
+#define LOD_COARSEST_FRACTION 0.05
+
+// how long to spend making finer levels in each frame, in milliseconds
+#define LOD_MILLISECONDS_PER_FRAME 100
 
 CShape::CShape()
-:m_face_gl_list(0),
- m_edge_gl_list(0),
+:m_lod_drawn(0),
  m_opacity(1.0),
  m_volume_found(false),
  m_color(0, 0, 0),
@@ -40,8 +54,7 @@ CShape::CShape()
 
 CShape::CShape(const TopoDS_Shape &shape, const wxChar* title, const HeeksColor& col, float opacity)
 :IdNamedObjList(title),
- m_face_gl_list(0),
- m_edge_gl_list(0),
+ m_lod_drawn(0),
  m_shape(shape),
  m_opacity(opacity),
  m_volume_found(false),
@@ -52,8 +65,7 @@ CShape::CShape(const TopoDS_Shape &shape, const wxChar* title, const HeeksColor&
 }
 
 CShape::CShape(const CShape& s)
-:m_face_gl_list(0),
- m_edge_gl_list(0),
+:m_lod_drawn(0),
  m_volume_found(false),
  m_picked_face(NULL)
 {
@@ -117,19 +129,21 @@ void CShape::Init()
 
 void CShape::KillGLLists()
 {
-	if (m_face_gl_list)
+	for(int i = 0; i < SHAPE_LOD_LEVELS; i++)
 	{
-		glDeleteLists(m_face_gl_list, 1);
-		m_face_gl_list = 0;
-	}
+		LODLevel &lod = m_lod[i];
+		lod.m_face_buffer.Destroy();
+		lod.m_face_ranges.clear();
+		lod.m_face_tree.Clear();
+		lod.m_face_buffer_made = false;
 
-	if (m_edge_gl_list)
-	{
-		glDeleteLists(m_edge_gl_list, 1);
-		m_edge_gl_list = 0;
+		if (lod.m_edge_gl_list)
+		{
+			glDeleteLists(lod.m_edge_gl_list, 1);
+			lod.m_edge_gl_list = 0;
+		}
 	}
-
-	m_box = CBox();
+	m_lod_drawn = 0;
 
 	if(m_faces)
 	{
@@ -158,89 +172,362 @@ void CShape::create_faces_and_edges()
 
 void CShape::delete_faces_and_edges()
 {
+	// the face buffers and triangulations refer to the faces
+	for(int i = 0; i < SHAPE_LOD_LEVELS; i++)
+	{
+		m_lod[i].m_face_buffer.Destroy();
+		m_lod[i].m_face_ranges.clear();
+		m_lod[i].m_face_tree.Clear();
+		m_lod[i].m_face_buffer_made = false;
+		ClearLODTriangulation(m_lod[i]);
+	}
+
 	if(m_faces)m_faces->Clear();
 	if(m_edges)m_edges->Clear();
 	if(m_vertices)m_vertices->Clear();
 }
 
-void CShape::CallMesh()
+double CShape::LODDeflection(int level)
 {
-	double pixels_per_mm = wxGetApp().GetPixelScale();
-	BRepTools::Clean(m_shape);
-	BRepMesh::Mesh(m_shape, 1/pixels_per_mm);
+	CBox box;
+	GetBox(box);
+	double deflection = box.Radius() * 2 * LOD_COARSEST_FRACTION;
+	for(int i = 0; i < level; i++)deflection /= LOD_DEFLECTION_RATIO;
+
+	// the finest level is only drawn when the one before it is coarser than a pixel, so there is no point making it finer than a pixel
+	if(level == SHAPE_LOD_LEVELS - 1)
+	{
+		double mm_per_pixel = 1/wxGetApp().GetPixelScale();
+		if(deflection < mm_per_pixel)deflection = mm_per_pixel;
+	}
+
+	if(deflection < wxGetApp().m_geom_tol)deflection = wxGetApp().m_geom_tol;
+	return deflection;
 }
 
-void CShape::glCommands(bool select, bool marked, bool no_color)
+int CShape::ChooseLODLevel()
 {
-	bool mesh_called = false;
-	bool draw_faces = (wxGetApp().m_solid_view_mode == SolidViewFacesAndEdges || wxGetApp().m_solid_view_mode == SolidViewFacesOnly);
-	bool draw_edges = (wxGetApp().m_solid_view_mode == SolidViewFacesAndEdges || wxGetApp().m_solid_view_mode == SolidViewEdgesOnly);
+	// use the coarsest level whose deflection is less than a pixel on the screen
+	double mm_per_pixel = 1/wxGetApp().GetPixelScale();
+	for(int level = 0; level < SHAPE_LOD_LEVELS - 1; level++)
+	{
+		if(LODDeflection(level) <= mm_per_pixel)return level;
+	}
+	return SHAPE_LOD_LEVELS - 1;
+}
 
-	if(draw_faces)
+void CShape::CallMesh(int level)
+{
+	LODLevel &lod = m_lod[level];
+	if(lod.m_deflection > 0.0)
 	{
-		for(HeeksObj* object = m_faces->GetFirstChild(); object; object = m_faces->GetNextChild())
+		// this level has been meshed before, so put its triangulation back
+		RestoreLODTriangulation(lod);
+		return;
+	}
+
+	// start from the nearest coarser level, so only the faces which are too coarse for this level get meshed again
+	int coarser = level - 1;
+	while(coarser >= 0 && m_lod[coarser].m_deflection == 0.0)coarser--;
+	if(coarser >= 0)RestoreLODTriangulation(m_lod[coarser]);
+	else BRepTools::Clean(m_shape);
+
+	lod.m_deflection = LODDeflection(level);
+	BRepMesh::Mesh(m_shape, lod.m_deflection);
+	SaveLODTriangulation(lod);
+}
+
+void CShape::SaveLODTriangulation(LODLevel &lod)
+{
+	lod.m_face_triangulations.clear();
+	lod.m_face_locations.clear();
+	lod.m_edge_polygons.clear();
+
+	for(HeeksObj* object = m_faces->GetFirstChild(); object; object = m_faces->GetNextChild())
+	{
+		const TopoDS_Face &face = ((CFace*)object)->Face();
+		TopLoc_Location loc;
+		Handle_Poly_Triangulation triangulation = BRep_Tool::Triangulation(face, loc);
+		lod.m_face_triangulations.push_back(triangulation);
+		lod.m_face_locations.push_back(loc);
+		if(triangulation.IsNull())continue;
+
+		// the edges are drawn from their polygons on the face's triangulation
+		for(TopExp_Explorer ex(face, TopAbs_EDGE); ex.More(); ex.Next())
 		{
-			CFace* f = (CFace*)object;
-			f->MakeSureMarkingGLListExists();
+			EdgePolygon edge_polygon;
+			edge_polygon.m_edge = TopoDS::Edge(ex.Current().Oriented(TopAbs_FORWARD));
+			edge_polygon.m_triangulation = triangulation;
+			edge_polygon.m_location = loc;
+			edge_polygon.m_polygon = BRep_Tool::PolygonOnTriangulation(edge_polygon.m_edge, triangulation, loc);
+			if(edge_polygon.m_polygon.IsNull())continue;
+			if(BRep_Tool::IsClosed(edge_polygon.m_edge, face))edge_polygon.m_polygon2 = BRep_Tool::PolygonOnTriangulation(TopoDS::Edge(edge_polygon.m_edge.Reversed()), triangulation, loc);
+			lod.m_edge_polygons.push_back(edge_polygon);
 		}
+	}
+}
+
+void CShape::RestoreLODTriangulation(const LODLevel &lod)
+{
+	BRep_Builder builder;
+
+	size_t i = 0;
+	for(HeeksObj* object = m_faces->GetFirstChild(); object && i < lod.m_face_triangulations.size(); object = m_faces->GetNextChild(), i++)
+	{
+		builder.UpdateFace(((CFace*)object)->Face(), lod.m_face_triangulations[i]);
+	}
+
+	for(std::vector<EdgePolygon>::const_iterator It = lod.m_edge_polygons.begin(); It != lod.m_edge_polygons.end(); It++)
+	{
+		const EdgePolygon &edge_polygon = *It;
+		if(edge_polygon.m_polygon2.IsNull())builder.UpdateEdge(edge_polygon.m_edge, edge_polygon.m_polygon, edge_polygon.m_triangulation, edge_polygon.m_location);
+		else builder.UpdateEdge(edge_polygon.m_edge, edge_polygon.m_polygon, edge_polygon.m_polygon2, edge_polygon.m_triangulation, edge_polygon.m_location);
+	}
+}
+
+void CShape::ClearLODTriangulation(LODLevel &lod)
+{
+	lod.m_deflection = 0.0;
+	lod.m_face_triangulations.clear();
+	lod.m_face_locations.clear();
+	lod.m_edge_polygons.clear();
+}
+
+void CShape::MakeLODLevel(int level, bool faces, bool edges)
+{
+	LODLevel &lod = m_lod[level];
+	if(lod.m_face_buffer_made)faces = false;
+	if(lod.m_edge_gl_list)edges = false;
+	if(!faces && !edges)return;
+
+	// the faces only hold one triangulation at a time, so this level's is put on them before the face buffer and edge list are made
+	CallMesh(level);
+
+	if(faces)
+	{
+		// collect the triangles of all the faces into one buffer
+		MakeFaceBuffer(lod);
+		lod.m_face_buffer_made = true;
+	}
+
+	if(edges)
+	{
+		// make the display list
+		lod.m_edge_gl_list = glGenLists(1);
+		glNewList(lod.m_edge_gl_list, GL_COMPILE);
+
+		// render all the edges
+		m_edges->glCommands(true, false, false);
 
-		if(!m_face_gl_list)
+		// render all the vertices
+		m_vertices->glCommands(true, false, false);
+
+		glEndList();
+	}
+}
+
+bool CShape::LODLevelMade(int level, bool faces, bool edges)
+{
+	LODLevel &lod = m_lod[level];
+	if(faces && !lod.m_face_buffer_made)return false;
+	if(edges && !lod.m_edge_gl_list)return false;
+	return true;
+}
+
+void CShape::BeginLODFrame()
+{
+	m_lod_frame_start = wxGetLocalTimeMillis();
+	m_lod_refinement_pending = false;
+}
+
+static std::vector<float>* vertices_for_face_buffer = NULL;
+static std::vector<float>* normals_for_face_buffer = NULL;
+
+static void face_buffer_callback(const double* x, const double* n)
+{
+	for(int i = 0; i<9; i++)
+	{
+		vertices_for_face_buffer->push_back((float)x[i]);
+		normals_for_face_buffer->push_back((float)n[i]);
+	}
+}
+
+void CShape::MakeFaceBuffer(LODLevel &lod)
+{
+	std::vector<float> vertices;
+	std::vector<float> normals;
+	vertices_for_face_buffer = &vertices;
+	normals_for_face_buffer = &normals;
+
+	lod.m_face_ranges.clear();
+	std::vector<CBox> face_boxes;
+	unsigned int face_index = 0;
+	for(HeeksObj* object = m_faces->GetFirstChild(); object; object = m_faces->GetNextChild(), face_index++)
+	{
+		CFace* f = (CFace*)object;
+		FaceRange range;
+		range.m_face = f;
+		range.m_face_index = face_index;
+		range.m_first = (unsigned int)(vertices.size() / 3);
+		DrawFace(f->Face(), face_buffer_callback, false);
+		range.m_count = (unsigned int)(vertices.size() / 3) - range.m_first;
+		if(range.m_count > 0)
 		{
-			if(!mesh_called)
+			lod.m_face_ranges.push_back(range);
+
+			CBox box;
+			for(unsigned int i = range.m_first; i < range.m_first + range.m_count; i++)
 			{
-				CallMesh();
-				mesh_called = true;
+				box.Insert(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
 			}
+			face_boxes.push_back(box);
+		}
+	}
+	lod.m_face_tree.Build(face_boxes);
 
-			// make the display list
-			m_face_gl_list = glGenLists(1);
-			glNewList(m_face_gl_list, GL_COMPILE);
+	// the triangles don't share vertices, so the indices just count up
+	std::vector<unsigned int> indices(vertices.size() / 3);
+	for(unsigned int i = 0; i < indices.size(); i++)indices[i] = i;
 
-			// render all the faces
-			m_faces->glCommands(true, marked, no_color);
+	lod.m_face_buffer.SetData(vertices, normals, indices);
+}
 
-			glEndList();
+void CShape::DrawFaceBuffer(LODLevel &lod, bool select)
+{
+	if(!m_faces->m_visible)return;
+
+	if(select)
+	{
+		// only the faces in the pick window can be hit, each has its own name
+		CFrustum frustum;
+		frustum.SetFromGL();
+		std::vector<int> items;
+		lod.m_face_tree.Find(frustum, items);
+		std::sort(items.begin(), items.end());
+
+		for(std::vector<int>::iterator It = items.begin(); It != items.end(); It++)
+		{
+			FaceRange &range = lod.m_face_ranges[*It];
+			if(!range.m_face->OnVisibleLayer() || !range.m_face->m_visible)continue;
+			glPushName(range.m_face->GetIndex());
+			range.m_face->CallMarkingGLList();
+			lod.m_face_buffer.Draw(GL_TRIANGLES, range.m_first, range.m_count);
+			glPopName();
 		}
+		return;
+	}
 
-		// update faces marking display list
-		GLint currentListIndex;
-		glGetIntegerv(GL_LIST_INDEX, &currentListIndex);
-		if(currentListIndex == 0){
-			for(HeeksObj* object = m_faces->GetFirstChild(); object; object = m_faces->GetNextChild())
+	// unmarked faces all use the body's material, so neighbouring ones are drawn together
+	CFace* run_face = NULL;
+	unsigned int run_first = 0;
+	unsigned int run_count = 0;
+
+	for(std::vector<FaceRange>::iterator It = lod.m_face_ranges.begin(); It != lod.m_face_ranges.end(); It++)
+	{
+		FaceRange &range = *It;
+		bool visible = range.m_face->OnVisibleLayer() && range.m_face->m_visible;
+		bool draw_alone = wxGetApp().m_marked_list->ObjectMarked(range.m_face);
+
+		if(run_count > 0 && (!visible || draw_alone || range.m_first != run_first + run_count))
+		{
+			run_face->CallMarkingGLList();
+			lod.m_face_buffer.Draw(GL_TRIANGLES, run_first, run_count);
+			run_count = 0;
+		}
+
+		if(!visible)continue;
+
+		if(draw_alone)
+		{
+			range.m_face->CallMarkingGLList();
+			lod.m_face_buffer.Draw(GL_TRIANGLES, range.m_first, range.m_count);
+		}
+		else
+		{
+			if(run_count == 0)
 			{
-				CFace* f = (CFace*)object;
-				f->UpdateMarkingGLList(wxGetApp().m_marked_list->ObjectMarked(f));
+				run_face = range.m_face;
+				run_first = range.m_first;
 			}
+			run_count += range.m_count;
 		}
 	}
 
-	if(draw_edges && !m_edge_gl_list)
+	if(run_count > 0)
 	{
-		if(!mesh_called)
+		run_face->CallMarkingGLList();
+		lod.m_face_buffer.Draw(GL_TRIANGLES, run_first, run_count);
+	}
+}
+
+void CShape::glCommands(bool select, bool marked, bool no_color)
+{
+	bool draw_faces = (wxGetApp().m_solid_view_mode == SolidViewFacesAndEdges || wxGetApp().m_solid_view_mode == SolidViewFacesOnly);
+	bool draw_edges = (wxGetApp().m_solid_view_mode == SolidViewFacesAndEdges || wxGetApp().m_solid_view_mode == SolidViewEdgesOnly);
+
+	// choose the level of detail from the size of the shape on the screen
+	// the coarsest level is made first, and finer ones are made in later frames, while there is time
+	int level = m_lod_drawn;
+	if(!select)
+	{
+		level = ChooseLODLevel();
+		if(level == SHAPE_LOD_LEVELS - 1 && m_lod[level].m_deflection > LODDeflection(level) * 2)
 		{
-			CallMesh();
-			mesh_called = true;
+			// zoomed in a long way since the finest level was made to the pixel size, so make it again
+			LODLevel &lod = m_lod[level];
+			lod.m_face_buffer.Destroy();
+			lod.m_face_ranges.clear();
+			lod.m_face_tree.Clear();
+			lod.m_face_buffer_made = false;
+			if (lod.m_edge_gl_list)
+			{
+				glDeleteLists(lod.m_edge_gl_list, 1);
+				lod.m_edge_gl_list = 0;
+			}
+			ClearLODTriangulation(lod);
 		}
+		if(!LODLevelMade(0, draw_faces, draw_edges))
+		{
+			if(level > 0)m_lod_refinement_pending = true;
+			level = 0;
+		}
+		else if(!LODLevelMade(level, draw_faces, draw_edges) && wxGetLocalTimeMillis() - m_lod_frame_start > LOD_MILLISECONDS_PER_FRAME)
+		{
+			m_lod_refinement_pending = true;
+			while(!LODLevelMade(level, draw_faces, draw_edges))level--;
+		}
+		m_lod_drawn = level;
+	}
 
-		// make the display list
-		m_edge_gl_list = glGenLists(1);
-		glNewList(m_edge_gl_list, GL_COMPILE);
-
-		// render all the edges
-		m_edges->glCommands(true, marked, no_color);
+	MakeLODLevel(level, draw_faces, draw_edges);
+	LODLevel &lod = m_lod[level];
 
-		// render all the vertices
-		m_vertices->glCommands(true, false, false);
+	if(draw_faces)
+	{
+		for(HeeksObj* object = m_faces->GetFirstChild(); object; object = m_faces->GetNextChild())
+		{
+			CFace* f = (CFace*)object;
+			f->MakeSureMarkingGLListExists();
+		}
 
-		glEndList();
+		// update faces marking display list
+		GLint currentListIndex;
+		glGetIntegerv(GL_LIST_INDEX, &currentListIndex);
+		if(currentListIndex == 0){
+			for(HeeksObj* object = m_faces->GetFirstChild(); object; object = m_faces->GetNextChild())
+			{
+				CFace* f = (CFace*)object;
+				f->UpdateMarkingGLList(wxGetApp().m_marked_list->ObjectMarked(f));
+			}
+		}
 	}
 
-	if(draw_faces && m_face_gl_list)
+	if(draw_faces && !lod.m_face_buffer.IsEmpty())
 	{
-		// draw the face display list
+		// draw the face buffer
 		glEnable(GL_LIGHTING);
 		glShadeModel(GL_SMOOTH);
-		glCallList(m_face_gl_list);
+		DrawFaceBuffer(lod, select);
 		glDisable(GL_LIGHTING);
 		glShadeModel(GL_FLAT);
 	}
@@ -251,10 +538,105 @@ void CShape::glCommands(bool select, bool marked, bool no_color)
 		glDepthMask(1);
 	}
 
-	if(draw_edges && m_edge_gl_list)
+	if(draw_edges && lod.m_edge_gl_list)
 	{
 		// draw the edge display list
-		glCallList(m_edge_gl_list);
+		glCallList(lod.m_edge_gl_list);
+	}
+}
+
+void CShape::Pick(CPicker &picker)
+{
+	bool draw_faces = (wxGetApp().m_solid_view_mode == SolidViewFacesAndEdges || wxGetApp().m_solid_view_mode == SolidViewFacesOnly);
+	bool draw_edges = (wxGetApp().m_solid_view_mode == SolidViewFacesAndEdges || wxGetApp().m_solid_view_mode == SolidViewEdgesOnly);
+
+	// the level drawn last, as glCommands uses for selecting
+	int level = m_lod_drawn;
+	MakeLODLevel(level, draw_faces, draw_edges);
+	LODLevel &lod = m_lod[level];
+
+	if(draw_faces && m_faces->m_visible)
+	{
+		// the triangles of the faces whose boxes are in the pick window, from the level's triangulations, which are what the face buffer was made from
+		CFrustum frustum;
+		frustum.SetFromGL();
+		std::vector<int> items;
+		lod.m_face_tree.Find(frustum, items);
+		std::sort(items.begin(), items.end());
+
+		for(std::vector<int>::iterator It = items.begin(); It != items.end(); It++)
+		{
+			FaceRange &range = lod.m_face_ranges[*It];
+			if(!range.m_face->OnVisibleLayer() || !range.m_face->m_visible)continue;
+			if(range.m_face_index >= lod.m_face_triangulations.size())continue;
+			const Handle_Poly_Triangulation &triangulation = lod.m_face_triangulations[range.m_face_index];
+			if(triangulation.IsNull())continue;
+			gp_Trsf tr = lod.m_face_locations[range.m_face_index];
+
+			picker.PushName(range.m_face);
+			const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
+			const Poly_Array1OfTriangle& triangles = triangulation->Triangles();
+			for(int i = 1; i <= triangulation->NbTriangles(); i++)
+			{
+				int n[3];
+				triangles(i).Get(n[0], n[1], n[2]);
+				double p[3][3];
+				for(int j = 0; j<3; j++)extract(nodes(n[j]).Transformed(tr), p[j]);
+				picker.Triangle(p[0], p[1], p[2]);
+			}
+			picker.PopName();
+		}
+	}
+
+	if(draw_edges)
+	{
+		// the edges are drawn from their polygons on a face's triangulation
+		TopTools_IndexedMapOfShape edge_map;
+		std::vector<int> edge_polygon; // the first of lod.m_edge_polygons for each edge in edge_map
+		for(unsigned int i = 0; i < lod.m_edge_polygons.size(); i++)
+		{
+			int index = edge_map.Add(lod.m_edge_polygons[i].m_edge);
+			if(index > (int)edge_polygon.size())edge_polygon.push_back(i);
+		}
+
+		if(m_edges->m_visible)
+		{
+			std::vector<float> points;
+			for(HeeksObj* object = m_edges->GetFirstChild(); object; object = m_edges->GetNextChild())
+			{
+				if(!object->OnVisibleLayer() || !object->m_visible)continue;
+				int index = edge_map.FindIndex(((CEdge*)object)->Edge());
+				if(index == 0)continue;
+				const EdgePolygon &polygon = lod.m_edge_polygons[edge_polygon[index - 1]];
+				gp_Trsf tr = polygon.m_location;
+				const TColStd_Array1OfInteger& polygon_nodes = polygon.m_polygon->Nodes();
+				const TColgp_Array1OfPnt& nodes = polygon.m_triangulation->Nodes();
+				points.clear();
+				for(int i = polygon_nodes.Lower(); i <= polygon_nodes.Upper(); i++)
+				{
+					gp_Pnt p = nodes(polygon_nodes(i)).Transformed(tr);
+					points.push_back((float)p.X());
+					points.push_back((float)p.Y());
+					points.push_back((float)p.Z());
+				}
+
+				picker.PushName(object);
+				if(points.size() > 0)picker.LineStrip(&points[0], (unsigned int)(points.size() / 3));
+				picker.PopName();
+			}
+		}
+
+		// the vertices are drawn as raster positions
+		if(m_vertices->m_visible)
+		{
+			for(HeeksObj* object = m_vertices->GetFirstChild(); object; object = m_vertices->GetNextChild())
+			{
+				if(!object->OnVisibleLayer() || !object->m_visible)continue;
+				picker.PushName(object);
+				picker.Point(((HVertex*)object)->m_point);
+				picker.PopName();
+			}
+		}
 	}
 }
 
@@ -262,10 +644,9 @@ void CShape::GetBox(CBox &box)
 {
 	if(!m_box.m_valid)
 	{
-		if(m_faces == NULL)create_faces_and_edges();
-		BRepTools::Clean(m_shape);
-		BRepMesh::Mesh(m_shape, 1.0);
-		if(m_faces)m_faces->GetBox(m_box);
+		// found from the surfaces and curves, or from the triangulation if it has been drawn, so it doesn't mesh the shape
+		// it is kept until the shape changes, not cleared with the display lists
+		GetShapeBox(m_shape, m_box);
 	}
 
 	box.Insert(m_box);
@@ -327,8 +708,11 @@ wxString CShape::StretchedName()
 }
 
 void CShape::ModifyByMatrix(const double* m){
-	gp_Trsf mat = make_matrix(m);
+	TransformShape(make_matrix(m));
+	OnShapeTransformed();
+}
 
+void CShape::TransformShape(const gp_Trsf &mat){
 	if(IsMatrixDifferentialScale(mat))
 	{
         gp_GTrsf gm(mat);
@@ -339,6 +723,10 @@ void CShape::ModifyByMatrix(const double* m){
 	{
 		MakeTransformedShape(mat);
 	}
+}
+
+void CShape::OnShapeTransformed(){
+	m_box = CBox();
 	delete_faces_and_edges();
 	KillGLLists();
 	create_faces_and_edges();
@@ -545,10 +933,11 @@ void CShape::CopyIDsFrom(const CShape* shape_from)
 	}
 }
 
-HeeksObj* CShape::CutShapes(std::list<HeeksObj*> &list_in, bool dodelete)
+HeeksObj* CShape::CutShapes(std::list<HeeksObj*> &list_picked, bool dodelete)
 {
-	wxGetApp().StartHistory();
+	wxGetApp().StartTransaction();
 	HeeksObj* return_object = NULL;
+	std::list<HeeksObj*> list_in = CInstance::MakeRealUndoably(list_picked);
 
 	if(list_in.front()->GetType() == GroupType)
 	{
@@ -625,7 +1014,7 @@ HeeksObj* CShape::CutShapes(std::list<HeeksObj*> &list_in, bool dodelete)
 	}
 	}
 
-	wxGetApp().EndHistory();
+	wxGetApp().EndTransaction();
 	wxGetApp().Repaint();
 
 	return return_object;
@@ -635,7 +1024,7 @@ HeeksObj* CShape::FuseShapes(std::list<HeeksObj*> &list_in)
 {
 	// fuse with the first one in the list all the others
 	HeeksObj* s1 = NULL;
-	std::list<HeeksObj*> list = list_in;
+	std::list<HeeksObj*> list = CInstance::MakeRealUndoably(list_in);
 
 	for(std::list<HeeksObj*>::const_iterator It = list.begin(); It != list.end(); It++){
 		HeeksObj* object = *It;
@@ -658,7 +1047,7 @@ HeeksObj* CShape::CommonShapes(std::list<HeeksObj*> &list_in)
 	// find common solid ( intersect ) with the first one in the list all the others
 	HeeksObj* s1 = NULL;
 	bool s1_set = false;
-	std::list<HeeksObj*> list = list_in;
+	std::list<HeeksObj*> list = CInstance::MakeRealUndoably(list_in);
 
 	for(std::list<HeeksObj*>::const_iterator It = list.begin(); It != list.end(); It++){
 		HeeksObj* object = *It;
@@ -943,6 +1332,23 @@ static void WriteShapeOrGroup(STEPControl_Writer &writer, HeeksObj* object, std:
 		writer.Transfer(((CSolid*)object)->Shape(), STEPControl_AsIs);
 	}
 
+	if(object->GetType() == InstanceType && CShape::IsTypeAShape(((CInstance*)object)->Source()->GetType()))
+	{
+		if(index_map)
+		{
+			// the source's title and colour, but not its ids, which aren't in the document
+			CShapeData shape_data((CShape*)(((CInstance*)object)->Source()));
+			shape_data.m_id = -1;
+			shape_data.m_visible = object->m_visible;
+			shape_data.m_face_ids.clear();
+			shape_data.m_edge_ids.clear();
+			shape_data.m_vertex_ids.clear();
+			index_map->insert( std::pair<int, CShapeData>(i, shape_data) );
+		}
+		i++;
+		writer.Transfer(((CInstance*)object)->GetTransformedShape(), STEPControl_AsIs);
+	}
+
 	if(object->GetType() == GroupType)
 	{
 		for(HeeksObj* o = object->GetFirstChild(); o; o = object->GetNextChild())
@@ -998,6 +1404,9 @@ bool CShape::ExportSolidsFile(const std::list<HeeksObj*>& objects, const wxChar*
 			else if(object->GetType() == WireType){
 				writer.AddShape(((CWire*)object)->Shape());
 			}
+			else if(object->GetType() == InstanceType && CShape::IsTypeAShape(((CInstance*)object)->Source()->GetType())){
+				writer.AddShape(((CInstance*)object)->GetTransformedShape());
+			}
 		}
 		writer.Write(aFileName);
 
@@ -1024,6 +1433,115 @@ bool CShape::ExportSolidsFile(const std::list<HeeksObj*>& objects, const wxChar*
 	return false;
 }
 
+void CShape::ImportSolidsBREP(std::istream &is, bool undoably, std::map<int, CShapeData> *index_map, HeeksObj* paste_into)
+{
+	// only allow paste of solids at top level or to groups
+	if(paste_into && paste_into->GetType() != GroupType)return;
+
+	HeeksObj* add_to = &wxGetApp();
+	if(paste_into)add_to = paste_into;
+
+	char oldlocale[1000];
+	strcpy(oldlocale, setlocale(LC_NUMERIC, "C"));
+
+	TopoDS_Shape compound;
+	BRep_Builder builder;
+	BRepTools::Read(compound, is, builder);
+
+	// the children of the compound are in the order of the index map, like the roots of a STEP file
+	int i = 1;
+	for(TopoDS_Iterator It(compound); It.More(); It.Next(), i++)
+	{
+		for (TopExp_Explorer ex(It.Value(), TopAbs_SOLID); ex.More(); ex.Next())
+		{
+			const TopoDS_Solid& aSolid = TopoDS::Solid(ex.Current());
+			CShapeData* shape_data = NULL;
+			if(index_map)
+			{
+				std::map<int, CShapeData>::iterator FindIt = index_map->find(i);
+				if (FindIt == index_map->end())continue;
+				shape_data = &(FindIt->second);
+			}
+
+			HeeksObj* new_object = MakeObject(aSolid, _("BREP solid"), shape_data ? shape_data->m_solid_type : SOLID_TYPE_UNKNOWN, HeeksColor(191, 191, 191), 1.0f);
+			if (new_object)
+			{
+				if (undoably)wxGetApp().AddUndoably(new_object, add_to, NULL);
+				else add_to->Add(new_object, NULL);
+
+				// change the id ( and any other data ), to the one in the index
+				if(shape_data)shape_data->SetShape((CShape*)new_object, !wxGetApp().m_inPaste);
+			}
+		}
+	}
+
+	setlocale(LC_NUMERIC, oldlocale);
+}
+
+static void AddShapeOrGroup(BRep_Builder &builder, TopoDS_Compound &compound, HeeksObj* object, std::map<int, CShapeData> *index_map, int &i, std::list<CShape*> &shapes)
+{
+	if(CShape::IsTypeAShape(object->GetType())){
+
+		if(index_map)index_map->insert( std::pair<int, CShapeData>(i, CShapeData((CShape*)object)) );
+		i++;
+		builder.Add(compound, ((CShape*)object)->Shape());
+		shapes.push_back((CShape*)object);
+	}
+
+	if(object->GetType() == GroupType)
+	{
+		for(HeeksObj* o = object->GetFirstChild(); o; o = object->GetNextChild())
+		{
+			AddShapeOrGroup(builder, compound, o, index_map, i, shapes);
+		}
+	}
+}
+
+void CShape::ExportSolidsBREP(const std::list<HeeksObj*>& objects, std::ostream &os, std::map<int, CShapeData> *index_map)
+{
+	char oldlocale[1000];
+	strcpy(oldlocale, setlocale(LC_NUMERIC, "C"));
+
+	// put all the solids in one compound, so shared geometry is only written once
+	TopoDS_Compound compound;
+	BRep_Builder builder;
+	builder.MakeCompound(compound);
+	int i = 1;
+	std::list<CShape*> shapes;
+	for(std::list<HeeksObj*>::const_iterator It = objects.begin(); It != objects.end(); It++)
+	{
+		AddShapeOrGroup(builder, compound, *It, index_map, i, shapes);
+	}
+	WriteBREP(compound, shapes, os);
+
+	setlocale(LC_NUMERIC, oldlocale);
+}
+
+// static
+void CShape::WriteBREP(const TopoDS_Shape &shape, const std::list<CShape*> &shapes, std::ostream &os)
+{
+	// the faces hold the triangulation of the level of detail drawn last, which BRepTools::Write would write too.
+	// it is taken off while writing, and put back afterwards, so nothing has to be meshed again
+	std::list<LODLevel> drawn;
+	for(std::list<CShape*>::const_iterator It = shapes.begin(); It != shapes.end(); It++)
+	{
+		drawn.push_back(LODLevel());
+		(*It)->SaveLODTriangulation(drawn.back());
+	}
+	for(std::list<CShape*>::const_iterator It = shapes.begin(); It != shapes.end(); It++)
+	{
+		BRepTools::Clean((*It)->m_shape);
+	}
+
+	BRepTools::Write(shape, os);
+
+	std::list<LODLevel>::iterator DrawnIt = drawn.begin();
+	for(std::list<CShape*>::const_iterator It = shapes.begin(); It != shapes.end(); It++, DrawnIt++)
+	{
+		(*It)->RestoreLODTriangulation(*DrawnIt);
+	}
+}
+
 void CShape::GetTriangles(void(*callbackfunc)(const double* x, const double* n), double cusp, bool just_one_average_normal){
 	BRepTools::Clean(m_shape);
 	BRepMesh::Mesh(m_shape, cusp);
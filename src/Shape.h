@@ -8,12 +8,53 @@
 #include "ShapeData.h"
 #include "ShapeTools.h"
 #include "../interface/IdNamedObjList.h"
+#include "VertexBuffer.h"
+#include "BoxTree.h"
+
+#define SHAPE_LOD_LEVELS 4
+
+class CFace;
+class CPicker;
 
 class CShape:public IdNamedObjList{
 protected:
-	int m_face_gl_list;
-	int m_edge_gl_list;
-	CBox m_box;
+	struct FaceRange
+	{
+		CFace* m_face;
+		unsigned int m_face_index; // of m_face in m_faces, and in the level's m_face_triangulations
+		unsigned int m_first; // first index of the face's triangles in m_face_buffer
+		unsigned int m_count;
+	};
+
+	// an edge's polygon on one face's triangulation
+	struct EdgePolygon
+	{
+		TopoDS_Edge m_edge; // forward
+		Handle_Poly_PolygonOnTriangulation m_polygon;
+		Handle_Poly_PolygonOnTriangulation m_polygon2; // the other side, for a seam edge, else null
+		Handle_Poly_Triangulation m_triangulation;
+		TopLoc_Location m_location;
+	};
+
+	// one tessellation of the whole shape, at one of the level of detail deflections
+	struct LODLevel
+	{
+		CVertexBuffer m_face_buffer; // the triangles of all the faces
+		std::vector<FaceRange> m_face_ranges;
+		CBoxTree m_face_tree; // the boxes of m_face_ranges, for picking
+		bool m_face_buffer_made;
+		int m_edge_gl_list;
+		double m_deflection; // it was meshed with, or 0 if it hasn't been
+		std::vector<Handle_Poly_Triangulation> m_face_triangulations; // copies of the faces' triangulations, in the order of m_faces, kept until the shape changes
+		std::vector<TopLoc_Location> m_face_locations; // of m_face_triangulations
+		std::vector<EdgePolygon> m_edge_polygons; // on m_face_triangulations
+
+		LODLevel():m_face_buffer_made(false), m_edge_gl_list(0), m_deflection(0.0){}
+	};
+
+	LODLevel m_lod[SHAPE_LOD_LEVELS]; // coarsest first
+	int m_lod_drawn; // the level drawn last time, used when selecting
+	CBox m_box; // the bounds of m_shape, kept until m_shape changes
 	TopoDS_Shape m_shape;
 	wxLongLong m_creation_time;
 	float m_opacity;
@@ -23,12 +64,23 @@ protected:
 
 	void create_faces_and_edges();
 	void delete_faces_and_edges();
-	void CallMesh();
+	double LODDeflection(int level);
+	int ChooseLODLevel();
+	void CallMesh(int level);
+	void SaveLODTriangulation(LODLevel &lod);
+	void RestoreLODTriangulation(const LODLevel &lod);
+	void ClearLODTriangulation(LODLevel &lod);
+	bool LODLevelMade(int level, bool faces, bool edges);
+	void MakeLODLevel(int level, bool faces, bool edges);
+	void MakeFaceBuffer(LODLevel &lod);
+	void DrawFaceBuffer(LODLevel &lod, bool select);
 	virtual void MakeTransformedShape(const gp_Trsf &mat);
 	virtual wxString StretchedName();
 
 public:
 	static bool m_solids_found; // a flag for xml writing
+	static wxLongLong m_lod_frame_start; // when the current frame started drawing, finer levels are only made for a while after this
+	static bool m_lod_refinement_pending; // a shape was drawn at a coarser level than it wanted
 	CFaceList* m_faces;
 	CEdgeList* m_edges;
 	CVertexList* m_vertices;
@@ -49,6 +101,8 @@ public:
 	void GetBox(CBox &box);
 	void KillGLLists(void);
 	void ModifyByMatrix(const double* m);
+	void TransformShape(const gp_Trsf &mat); // the first part of ModifyByMatrix, which only changes m_shape, so it can be run on a worker thread
+	void OnShapeTransformed(); // the rest of ModifyByMatrix, which remakes the faces and edges
 	void GetTriangles(void(*callbackfunc)(const double* x, const double* n), double cusp, bool just_one_average_normal = true);
 	double Area()const;
 	void GetTools(std::list<Tool*>* t_list, const wxPoint* p);
@@ -61,6 +115,7 @@ public:
 	bool DrawAfterOthers(){return m_opacity < 0.9999;}
 	void GetProperties(std::list<Property *> *list);
 
+	void Pick(CPicker &picker); // finds the faces, edges and vertices in the pick window, as glCommands would draw them for selecting
 	const TopoDS_Shape &Shape(){return m_shape;}
 	const TopoDS_Shape *GetShape(){return &m_shape;}
 
@@ -77,12 +132,17 @@ public:
 	static void FilletOrChamferEdges(std::list<HeeksObj*> &list, double radius, bool chamfer_not_fillet = false);
 	static bool ImportSolidsFile(const wxChar* filepath, bool undoably,std::map<int, CShapeData> *index_map = NULL, HeeksObj* paste_into = NULL);
 	static bool ExportSolidsFile(const std::list<HeeksObj*>& objects, const wxChar* filepath, std::map<int, CShapeData> *index_map = NULL);
+	static void ImportSolidsBREP(std::istream &is, bool undoably, std::map<int, CShapeData> *index_map, HeeksObj* paste_into = NULL);
+	static void ExportSolidsBREP(const std::list<HeeksObj*>& objects, std::ostream &os, std::map<int, CShapeData> *index_map);
+	static void WriteBREP(const TopoDS_Shape &shape, const std::list<CShape*> &shapes, std::ostream &os); // writes shape, which is made of shapes, without the triangulations they are drawn with
 	static HeeksObj* MakeObject(const TopoDS_Shape &shape, const wxChar* title, SolidTypeEnum solid_type, const HeeksColor& col, float opacity);
 	static bool IsTypeAShape(int t);
 	static bool IsMatrixDifferentialScale(const gp_Trsf& trsf);
+	static void BeginLODFrame();
 
 	virtual void SetXMLElement(TiXmlElement* element){}
 	virtual void SetFromXMLElement(TiXmlElement* pElem){}
+	virtual bool CanPick(){return true;} // false if glCommands draws something other than the faces and edges, so it must be picked with GL_SELECT
 
 	void Init();
 };
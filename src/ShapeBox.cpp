@@ -0,0 +1,18 @@
+// ShapeBox.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#include "stdafx.h"
+#include "ShapeBox.h"
+
+bool GetShapeBox(const TopoDS_Shape &shape, CBox &box)
+{
+	Bnd_Box b;
+	BRepBndLib::Add(shape, b);
+	if(b.IsVoid())return false;
+
+	double xmin, ymin, zmin, xmax, ymax, zmax;
+	b.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+	box = CBox(xmin, ymin, zmin, xmax, ymax, zmax);
+	return true;
+}
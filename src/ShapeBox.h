@@ -0,0 +1,9 @@
+// ShapeBox.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// the bounds of a shape, found from its surfaces and curves, or from a triangulation it already has.
+// it never meshes the shape; CShape::GetBox uses it, and unittest/ShapeBoxtest checks that.
+bool GetShapeBox(const TopoDS_Shape &shape, CBox &box); // returns false for an empty shape
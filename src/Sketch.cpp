@@ -4,9 +4,13 @@
 
 #include "stdafx.h"
 #include "Sketch.h"
+#include "SpanLinker.h"
 #include "HLine.h"
 #include "HArc.h"
 #include "HSpline.h"
+#include "HCircle.h"
+#include "HEllipse.h"
+#include "MarkedList.h"
 #include "HeeksFrame.h"
 #include "ObjPropsCanvas.h"
 #include "../interface/PropertyInt.h"
@@ -52,6 +56,64 @@ CSketch::~CSketch()
 {
 }
 
+// static
+const CCurvePolyline* CSketch::GetCurvePolyline(HeeksObj* object)
+{
+	switch(object->GetType())
+	{
+	case LineType:
+		return &((HLine*)object)->GetPolyline();
+	case ArcType:
+		return &((HArc*)object)->GetPolyline();
+	case CircleType:
+		return &((HCircle*)object)->GetPolyline();
+	case EllipseType:
+		return &((HEllipse*)object)->GetPolyline();
+	case SplineType:
+		return &((HSpline*)object)->GetPolyline();
+	default:
+		return NULL;
+	}
+}
+
+void CSketch::glCommands(bool select, bool marked, bool no_color)
+{
+	if(select || marked || no_color)
+	{
+		IdNamedObjList::glCommands(select, marked, no_color);
+		return;
+	}
+
+	if(!m_visible)return;
+
+	// the curves go into the batch, whether they are on the screen or not, so panning doesn't remake it.
+	// the marked ones are drawn again, on top, so selecting doesn't remake it either.
+	m_batch.Begin();
+	for(std::list<HeeksObj*>::iterator It = m_objects.begin(); It != m_objects.end(); It++)
+	{
+		HeeksObj* object = *It;
+		if(!object->OnVisibleLayer() || !object->m_visible)continue;
+
+		bool object_marked = wxGetApp().m_marked_list->ObjectMarked(object);
+		const CCurvePolyline* polyline = GetCurvePolyline(object);
+		if(polyline)
+		{
+			m_batch.Add(*polyline, *object->GetColor());
+			if(!object_marked)continue;
+		}
+
+		if(wxGetApp().m_view_culler.IsCulled(object))continue;
+		object->glCommands(false, object_marked, false);
+	}
+	m_batch.glCommands();
+}
+
+void CSketch::KillGLLists(void)
+{
+	IdNamedObjList::KillGLLists();
+	m_batch.Destroy();
+}
+
 const CSketch& CSketch::operator=(const CSketch& c)
 {
     if (this != &c)
@@ -844,128 +906,37 @@ void CSketch::Remove(HeeksObj* object)
 	IdNamedObjList::Remove(object);
 }
 
-bool CSketchRelinker::TryAdd(HeeksObj* object)
+void CSketch::Remove(std::list<HeeksObj*> objects)
 {
-	// if the object is not already added
-	if(m_added_from_old_set.find(object) == m_added_from_old_set.end())
-	{
-		double old_point[3];
-		double new_point[3];
-		m_new_back->GetEndPoint(old_point);
-
-		// try the object, the right way round
-		object->GetStartPoint(new_point);
-		if(make_point(old_point).IsEqual(make_point(new_point), wxGetApp().m_sketch_reorder_tol))
-		{
-			m_new_lists.back().push_back(object);
-			m_new_back = object;
-			m_added_from_old_set.insert(object);
-			return true;
-		}
-
-		// try the object, the wrong way round
-		object->GetEndPoint(new_point);
-		if(make_point(old_point).IsEqual(make_point(new_point), wxGetApp().m_sketch_reorder_tol))
-		{
-			CSketch::ReverseObject(object);
-			m_new_lists.back().push_back(object);
-			m_new_back = object;
-			m_added_from_old_set.insert(object);
-			return true;
-		}
-
-		// try at the start
-		m_new_front->GetStartPoint(old_point);
-
-		// try the object, the right way round
-		object->GetEndPoint(new_point);
-		if(make_point(old_point).IsEqual(make_point(new_point), wxGetApp().m_sketch_reorder_tol))
-		{
-			m_new_lists.back().push_front(object);
-			m_new_front = object;
-			m_added_from_old_set.insert(object);
-			return true;
-		}
-
-		// try the object, the wrong way round
-		object->GetStartPoint(new_point);
-		if(make_point(old_point).IsEqual(make_point(new_point), wxGetApp().m_sketch_reorder_tol))
-		{
-			CSketch::ReverseObject(object);
-			m_new_lists.back().push_front(object);
-			m_new_front = object;
-			m_added_from_old_set.insert(object);
-			return true;
-		}
-	}
-
-	return false;
+	m_order = SketchOrderTypeUnknown;
+	RemoveInOnePass(objects);
 }
 
-bool CSketchRelinker::AddNext()
+bool CSketchRelinker::Do()
 {
-	// returns true, if another object was added to m_new_lists
-
-	if(m_new_back)
+	CSpanLinker linker(wxGetApp().m_sketch_reorder_tol);
+	std::vector<HeeksObj*> objects(m_old_list.begin(), m_old_list.end());
+	for(std::vector<HeeksObj*>::iterator It = objects.begin(); It != objects.end(); It++)
 	{
-		bool added = false;
-
-		// look through all of the old list, starting at m_old_front
-		std::list<HeeksObj*>::const_iterator It = m_old_front;
-		do{
-			It++;
-			if(It == m_old_list.end())It = m_old_list.begin();
-			HeeksObj* object = *It;
-
-			added = TryAdd(object);
-
-		}while(It != m_old_front && !added);
-
-		if(added)return true;
-
-		// nothing fits the current new list
-
-		m_new_back = NULL;
-		m_new_front = NULL;
-
-		if(m_old_list.size() > m_added_from_old_set.size())
-		{
-			// there are still some to add, find a unused object
-			for(std::list<HeeksObj*>::const_iterator It = m_old_list.begin(); It != m_old_list.end(); It++)
-			{
-				HeeksObj* object = *It;
-				if(m_added_from_old_set.find(object) == m_added_from_old_set.end())
-				{
-					std::list<HeeksObj*> empty_list;
-					m_new_lists.push_back(empty_list);
-					m_new_lists.back().push_back(object);
-					m_added_from_old_set.insert(object);
-					m_old_front = It;
-					m_new_back = object;
-					m_new_front = object;
-					return true;
-				}
-			}
-		}
+		HeeksObj* object = *It;
+		double s[3], e[3];
+		if(object->GetStartPoint(s) && object->GetEndPoint(e))linker.AddSpan(s, e);
+		else linker.AddSpan();
 	}
 
-	return false;
-}
+	linker.Do();
 
-bool CSketchRelinker::Do()
-{
-	if(m_old_list.size() > 0)
+	for(std::list< std::list<CSpanLinker::Link> >::iterator It = linker.m_chains.begin(); It != linker.m_chains.end(); It++)
 	{
-		HeeksObj* new_object = m_old_list.front();
+		std::list<CSpanLinker::Link> &chain = *It;
 		std::list<HeeksObj*> empty_list;
 		m_new_lists.push_back(empty_list);
-		m_new_lists.back().push_back(new_object);
-		m_added_from_old_set.insert(m_old_list.front());
-		m_old_front = m_old_list.begin();
-		m_new_back = new_object;
-		m_new_front = new_object;
-
-		while(AddNext()){}
+		for(std::list<CSpanLinker::Link>::iterator It2 = chain.begin(); It2 != chain.end(); It2++)
+		{
+			HeeksObj* object = objects[It2->m_span];
+			if(It2->m_reversed)CSketch::ReverseObject(object);
+			m_new_lists.back().push_back(object);
+		}
 	}
 
 	return true;
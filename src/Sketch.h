@@ -7,12 +7,14 @@
 #include "../interface/IdNamedObjList.h"
 #include "../interface/HeeksColor.h"
 #include "../interface/SketchOrder.h"
+#include "CurvePolyline.h"
 
 class CoordinateSystem;
 
 class CSketch:public IdNamedObjList
 {
 	HeeksColor color;
+	CCurveBatch m_batch; // the lines, arcs, circles, ellipses and splines, as drawn last time
 	bool IsClockwise()const{return GetArea()>0;}
 
 public:
@@ -35,6 +37,8 @@ public:
 	long GetMarkingMask()const{return MARKING_FILTER_SKETCH;}
 	const wxChar* GetTypeString(void)const{return _("Sketch");}
 	const wxBitmap &GetIcon();
+	void glCommands(bool select, bool marked, bool no_color);
+	void KillGLLists(void);
 	void GetProperties(std::list<Property *> *list);
 	void GetTools(std::list<Tool*>* t_list, const wxPoint* p);
 	HeeksObj *MakeACopy(void)const;
@@ -45,6 +49,7 @@ public:
 	const HeeksColor* GetColor()const;
 	bool Add(HeeksObj* object, HeeksObj* prev_object);
 	void Remove(HeeksObj* object);
+	void Remove(std::list<HeeksObj*> objects);
 
 	static HeeksObj* ReadFromXMLElement(TiXmlElement* pElem);
 
@@ -58,23 +63,18 @@ public:
 	HeeksObj *Parallel( const double distance );
 	bool FilletAtPoint(const gp_Pnt& p, double rad);
 	static void ReverseObject(HeeksObj* object);
+	static const CCurvePolyline* GetCurvePolyline(HeeksObj* object); // the points a line, arc, circle, ellipse or spline is drawn with, else NULL
 	double GetArea()const;
 	CSketch* SplineToBiarcs(double tolerance)const;
 };
 
 class CSketchRelinker{
 	const std::list<HeeksObj*> &m_old_list;
-	std::set<HeeksObj*> m_added_from_old_set;
-	std::list<HeeksObj*>::const_iterator m_old_front;
-	HeeksObj* m_new_back;
-	HeeksObj* m_new_front;
-	bool AddNext();
-	bool TryAdd(HeeksObj* object);
 
 public:
 	std::list< std::list<HeeksObj*> > m_new_lists;
 
-	CSketchRelinker(const std::list<HeeksObj*>& old_list):m_old_list(old_list), m_new_back(NULL), m_new_front(NULL){}
+	CSketchRelinker(const std::list<HeeksObj*>& old_list):m_old_list(old_list){}
 
-	bool Do(); // makes m_new_lists
+	bool Do(); // makes m_new_lists, using a CSpanLinker
 };
@@ -0,0 +1,302 @@
+// SnapIndex.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "SnapIndex.h"
+#include "DigitizeMode.h"
+#include "MarkedList.h"
+
+// the types which FindNearPoint, FindPossTangentPoint, GetCentrePoints and Intersects are used with
+static bool IsCurveType(int type)
+{
+	switch(type)
+	{
+	case LineType:
+	case ILineType:
+	case ArcType:
+	case CircleType:
+	case EllipseType:
+	case SplineType:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void CSnapIndex::Clear()
+{
+	m_items.clear();
+	m_nodes.clear();
+	m_shapes.clear();
+	m_intersections.clear();
+	m_tree.Clear();
+	m_num_in_tree = 0;
+	m_num_removed = 0;
+	m_unbounded_items.clear();
+}
+
+void CSnapIndex::AddItem(Node &node, const Item &item)
+{
+	int index = (int)m_items.size();
+	m_items.push_back(item);
+	node.m_items.push_back(index);
+	if(!item.m_box.m_valid)m_unbounded_items.push_back(index);
+}
+
+void CSnapIndex::AddNode(HeeksObj* object, HeeksObj* parent)
+{
+	Node &node = m_nodes[object];
+	node.m_parent = parent;
+	if(parent)m_nodes[parent].m_children.push_back(object);
+
+	int type = object->GetType();
+	if(CShape::IsTypeAShape(type))
+	{
+		m_shapes.insert(object);
+		return;
+	}
+
+	if(object->GetFirstChild())
+	{
+		for(HeeksObj* child = object->GetFirstChild(); child; child = object->GetNextChild())
+		{
+			AddNode(child, object);
+		}
+		return;
+	}
+
+	Item item;
+	item.m_object = object;
+	item.m_item_type = ItemPoint;
+
+	std::list<GripData> vl;
+	object->GetGripperPositionsTransformed(&vl, true);
+	std::list<gp_Pnt> plist;
+	convert_gripdata_to_pnts(vl, plist);
+	for(std::list<gp_Pnt>::iterator It = plist.begin(); It != plist.end(); It++)
+	{
+		item.m_digitize_type = DigitizeEndofType;
+		item.m_point = *It;
+		item.m_box = CBox();
+		item.m_box.Insert(It->X(), It->Y(), It->Z());
+		AddItem(node, item);
+	}
+
+	double p[3];
+	if(object->GetMidPoint(p))
+	{
+		item.m_digitize_type = DigitizeMidpointType;
+		item.m_point = make_point(p);
+		item.m_box = CBox();
+		item.m_box.Insert(p);
+		AddItem(node, item);
+	}
+
+	if(IsCurveType(type))
+	{
+		item.m_item_type = ItemCurve;
+		item.m_digitize_type = DigitizeNoItemType;
+		item.m_box = CBox();
+		if(type != ILineType)object->GetBox(item.m_box);
+		AddItem(node, item);
+	}
+}
+
+void CSnapIndex::RemoveNode(HeeksObj* object)
+{
+	std::map<HeeksObj*, Node>::iterator FindIt = m_nodes.find(object);
+	if(FindIt == m_nodes.end())return;
+	Node &node = FindIt->second;
+
+	// the objects aren't looked at, they may have been deleted already
+	std::list<HeeksObj*> children = node.m_children;
+	for(std::list<HeeksObj*>::iterator It = children.begin(); It != children.end(); It++)
+	{
+		RemoveNode(*It);
+	}
+
+	for(std::list<int>::iterator It = node.m_items.begin(); It != node.m_items.end(); It++)
+	{
+		m_items[*It].m_object = NULL;
+		m_num_removed++;
+	}
+
+	for(std::set<HeeksObj*>::iterator It = node.m_intersected.begin(); It != node.m_intersected.end(); It++)
+	{
+		HeeksObj* other = *It;
+		m_intersections.erase(other < object ? std::make_pair(other, object) : std::make_pair(object, other));
+		std::map<HeeksObj*, Node>::iterator OtherIt = m_nodes.find(other);
+		if(OtherIt != m_nodes.end())OtherIt->second.m_intersected.erase(object);
+	}
+
+	if(node.m_parent)
+	{
+		std::map<HeeksObj*, Node>::iterator ParentIt = m_nodes.find(node.m_parent);
+		if(ParentIt != m_nodes.end())ParentIt->second.m_children.remove(object);
+	}
+
+	m_shapes.erase(object);
+	m_nodes.erase(FindIt);
+}
+
+void CSnapIndex::Add(HeeksObj* object)
+{
+	RemoveNode(object);
+
+	// only objects in the document are used; objects added to something which isn't in it yet are added with it
+	HeeksObj* parent = object->m_owner;
+	if(parent == &wxGetApp())parent = NULL;
+	else if(parent == NULL || m_shapes.find(parent) != m_shapes.end() || m_nodes.find(parent) == m_nodes.end())return;
+
+	AddNode(object, parent);
+}
+
+void CSnapIndex::Remove(HeeksObj* object)
+{
+	RemoveNode(object);
+}
+
+void CSnapIndex::OnChanged(const std::list<HeeksObj*>* added, const std::list<HeeksObj*>* removed, const std::list<HeeksObj*>* modified)
+{
+	if(removed)
+	{
+		for(std::list<HeeksObj*>::const_iterator It = removed->begin(); It != removed->end(); It++)Remove(*It);
+	}
+	if(added)
+	{
+		// ObjList::Add has usually done these already
+		for(std::list<HeeksObj*>::const_iterator It = added->begin(); It != added->end(); It++)
+		{
+			if(!Contains(*It))Add(*It);
+		}
+	}
+	if(modified)
+	{
+		for(std::list<HeeksObj*>::const_iterator It = modified->begin(); It != modified->end(); It++)Add(*It);
+	}
+}
+
+void CSnapIndex::Rebuild()
+{
+	// leave out the removed items, and put the rest in a new tree
+	std::vector<Item> items;
+	items.reserve(m_items.size() - m_num_removed);
+	m_unbounded_items.clear();
+	for(std::map<HeeksObj*, Node>::iterator It = m_nodes.begin(); It != m_nodes.end(); It++)
+	{
+		Node &node = It->second;
+		for(std::list<int>::iterator ItemIt = node.m_items.begin(); ItemIt != node.m_items.end(); ItemIt++)
+		{
+			int index = (int)items.size();
+			items.push_back(m_items[*ItemIt]);
+			if(!items.back().m_box.m_valid)m_unbounded_items.push_back(index);
+			*ItemIt = index;
+		}
+	}
+	m_items.swap(items);
+
+	std::vector<CBox> boxes(m_items.size());
+	for(unsigned int i = 0; i < m_items.size(); i++)boxes[i] = m_items[i].m_box;
+	m_tree.Build(boxes);
+	m_num_in_tree = (int)m_items.size();
+	m_num_removed = 0;
+}
+
+bool CSnapIndex::CanSnapTo(HeeksObj* object)const
+{
+	long mask = object->GetMarkingMask();
+	if(mask == 0 || (mask & wxGetApp().m_marked_list->m_filter) == 0)return false;
+
+	for(HeeksObj* o = object; o && o != &wxGetApp(); o = o->m_owner)
+	{
+		if(!o->OnVisibleLayer() || !o->m_visible)return false;
+		if(wxGetApp().m_digitizing->OnlyCoords(o))return false;
+	}
+	return true;
+}
+
+bool CSnapIndex::Find(const gp_Lin &ray, double radius, std::list<DigitizedPoint> &points, std::list<HeeksObj*> &curves)
+{
+	int num_not_in_tree = (int)m_items.size() - m_num_in_tree;
+	if(num_not_in_tree > 256 + m_num_in_tree / 8 || m_num_removed > (int)m_items.size() / 2)Rebuild();
+
+	CLineBoxTest test(ray, radius);
+	std::vector<int> found;
+	m_tree.Find(test, found);
+	for(int i = m_num_in_tree; i < (int)m_items.size(); i++)
+	{
+		if(m_items[i].m_box.m_valid && test.Intersects(m_items[i].m_box))found.push_back(i);
+	}
+	found.insert(found.end(), m_unbounded_items.begin(), m_unbounded_items.end());
+
+	double ray_start[3], ray_direction[3];
+	extract(ray.Location(), ray_start);
+	extract(ray.Direction().XYZ(), ray_direction);
+
+	std::multimap<double, HeeksObj*> curves_by_distance;
+	std::map<HeeksObj*, bool> can_snap_to;
+	for(std::vector<int>::iterator It = found.begin(); It != found.end(); It++)
+	{
+		Item &item = m_items[*It];
+		if(item.m_object == NULL)continue;
+
+		std::map<HeeksObj*, bool>::iterator CanIt = can_snap_to.find(item.m_object);
+		if(CanIt == can_snap_to.end())CanIt = can_snap_to.insert(std::make_pair(item.m_object, CanSnapTo(item.m_object))).first;
+		if(!CanIt->second)continue;
+
+		if(item.m_item_type == ItemPoint)
+		{
+			if(ray.Distance(item.m_point) <= radius)points.push_back(DigitizedPoint(item.m_point, item.m_digitize_type));
+		}
+		else
+		{
+			double p[3];
+			if(item.m_object->FindNearPoint(ray_start, ray_direction, p))
+			{
+				double dist = ray.Distance(make_point(p));
+				if(dist <= radius)curves_by_distance.insert(std::make_pair(dist, item.m_object));
+			}
+		}
+	}
+
+	for(std::multimap<double, HeeksObj*>::iterator It = curves_by_distance.begin(); It != curves_by_distance.end(); It++)
+	{
+		curves.push_back(It->second);
+	}
+
+	for(std::set<HeeksObj*>::iterator It = m_shapes.begin(); It != m_shapes.end(); It++)
+	{
+		HeeksObj* shape = *It;
+		CBox box;
+		shape->GetBox(box);
+		if(test.Intersects(box) && CanSnapTo(shape))return true;
+	}
+
+	return false;
+}
+
+void CSnapIndex::GetIntersections(HeeksObj* object1, HeeksObj* object2, std::list<gp_Pnt> &points)
+{
+	if(object2 < object1){HeeksObj* o = object1; object1 = object2; object2 = o;}
+	std::pair<HeeksObj*, HeeksObj*> key(object1, object2);
+
+	std::map< std::pair<HeeksObj*, HeeksObj*>, std::list<gp_Pnt> >::iterator FindIt = m_intersections.find(key);
+	if(FindIt != m_intersections.end())
+	{
+		points.insert(points.end(), FindIt->second.begin(), FindIt->second.end());
+		return;
+	}
+
+	std::list<double> rl;
+	std::list<gp_Pnt> plist;
+	if(object1->Intersects(object2, &rl))convert_doubles_to_pnts(rl, plist);
+	points.insert(points.end(), plist.begin(), plist.end());
+
+	// only remember them if the index will find out when either object changes
+	std::map<HeeksObj*, Node>::iterator It1 = m_nodes.find(object1);
+	std::map<HeeksObj*, Node>::iterator It2 = m_nodes.find(object2);
+	if(It1 == m_nodes.end() || It2 == m_nodes.end())return;
+	m_intersections.insert(std::make_pair(key, plist));
+	It1->second.m_intersected.insert(object2);
+	It2->second.m_intersected.insert(object1);
+}
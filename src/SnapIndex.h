@@ -0,0 +1,68 @@
+// SnapIndex.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "BoxTree.h"
+#include "DigitizedPoint.h"
+
+// the end points and mid points of everything in the document, and the boxes of the curves, for DigitizeMode to snap to without picking.
+// it is kept up to date by ObjList::Add, Remove and Clear, and by HeeksCADapp::ObserversOnChange, so only the objects which change are looked at again.
+// solids aren't split into their faces, edges and vertices; Find says when one is near, so they can be picked instead.
+class CSnapIndex
+{
+	enum ItemType
+	{
+		ItemPoint,
+		ItemCurve
+	};
+
+	struct Item
+	{
+		HeeksObj* m_object; // NULL when the object has been removed
+		ItemType m_item_type;
+		DigitizeType m_digitize_type; // for points
+		gp_Pnt m_point;
+		CBox m_box;
+	};
+
+	struct Node
+	{
+		HeeksObj* m_parent; // NULL for objects in the document's top level
+		std::list<HeeksObj*> m_children;
+		std::list<int> m_items;
+		std::set<HeeksObj*> m_intersected; // objects which have intersections cached with this one
+	};
+
+	std::vector<Item> m_items;
+	std::map<HeeksObj*, Node> m_nodes;
+	std::set<HeeksObj*> m_shapes;
+	std::map< std::pair<HeeksObj*, HeeksObj*>, std::list<gp_Pnt> > m_intersections;
+	CBoxTree m_tree; // has the items before m_num_in_tree; the ones after are looked at one by one, until there are enough to make a new tree
+	int m_num_in_tree;
+	int m_num_removed;
+	std::vector<int> m_unbounded_items; // infinite lines, which have no box
+
+	void AddNode(HeeksObj* object, HeeksObj* parent);
+	void AddItem(Node &node, const Item &item);
+	void RemoveNode(HeeksObj* object);
+	void Rebuild();
+	bool CanSnapTo(HeeksObj* object)const;
+
+public:
+	CSnapIndex():m_num_in_tree(0), m_num_removed(0){}
+
+	void Clear();
+	void Add(HeeksObj* object); // also used when the object has been modified
+	void Remove(HeeksObj* object);
+	void OnChanged(const std::list<HeeksObj*>* added, const std::list<HeeksObj*>* removed, const std::list<HeeksObj*>* modified);
+
+	// adds the end points and mid points within radius of the ray to points, and the curves which come within radius of it to curves, nearest first
+	// returns true if a solid's box is near the ray
+	bool Find(const gp_Lin &ray, double radius, std::list<DigitizedPoint> &points, std::list<HeeksObj*> &curves);
+
+	// the intersections of two objects, remembered until either of them changes
+	void GetIntersections(HeeksObj* object1, HeeksObj* object2, std::list<gp_Pnt> &points);
+	bool Contains(HeeksObj* object)const{return m_nodes.find(object) != m_nodes.end();}
+};
@@ -0,0 +1,172 @@
+// SpanLinker.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#include "stdafx.h"
+#include "SpanLinker.h"
+
+void CSpanLinker::AddSpan(const double* s, const double* e)
+{
+	for(int j = 0; j<3; j++)m_ends.push_back(s[j]);
+	for(int j = 0; j<3; j++)m_ends.push_back(e[j]);
+	m_has_ends.push_back(1);
+}
+
+void CSpanLinker::AddSpan()
+{
+	for(int j = 0; j<6; j++)m_ends.push_back(0.0);
+	m_has_ends.push_back(0);
+}
+
+size_t CSpanLinker::Slot(long long x, long long y, long long z)const
+{
+	unsigned int h = (unsigned int)x * 2654435769u ^ (unsigned int)y * 2246822519u ^ (unsigned int)z * 3266489917u;
+	return (size_t)((h * 2654435769u) >> m_shift);
+}
+
+void CSpanLinker::MakeTable()
+{
+	// the ends are put in cells twice the size of the tolerance, so matching ends are in the same cell or a neighbouring one
+	m_cell_size = m_tol * 2;
+	if(m_cell_size < 1.0e-9)m_cell_size = 1.0e-9;
+
+	int num_spans = (int)m_has_ends.size();
+	int num_ends = num_spans * 2;
+	int bits = 4;
+	while((1 << bits) < num_ends * 2)bits++;
+	m_shift = 32 - bits;
+	m_table.assign(1 << bits, -1);
+	m_next_end.assign(num_ends, -1);
+	m_end_cells.assign(num_ends * 3, 0);
+
+	for(int i = 0; i < num_spans; i++)
+	{
+		// spans without ends are never linked to
+		if(!m_has_ends[i])continue;
+
+		for(int end = i * 2; end < i * 2 + 2; end++)
+		{
+			long long* cell = &m_end_cells[end * 3];
+			for(int j = 0; j<3; j++)cell[j] = (long long)floor(m_ends[end * 3 + j] / m_cell_size);
+			size_t slot = Slot(cell[0], cell[1], cell[2]);
+			m_next_end[end] = m_table[slot];
+			m_table[slot] = end;
+		}
+	}
+}
+
+void CSpanLinker::FindBest(const double* point, bool back, int &best_span, int &best_order, int &best_way)const
+{
+	// finds the not added span, with an end at the point, which comes first after m_old_front
+	long long lo[3], hi[3];
+	for(int j = 0; j<3; j++)
+	{
+		lo[j] = (long long)floor((point[j] - m_tol) / m_cell_size);
+		hi[j] = (long long)floor((point[j] + m_tol) / m_cell_size);
+	}
+
+	int n = (int)m_has_ends.size();
+	for(long long x = lo[0]; x <= hi[0]; x++)
+	{
+		for(long long y = lo[1]; y <= hi[1]; y++)
+		{
+			for(long long z = lo[2]; z <= hi[2]; z++)
+			{
+				for(int end = m_table[Slot(x, y, z)]; end != -1; end = m_next_end[end])
+				{
+					const long long* cell = &m_end_cells[end * 3];
+					if(cell[0] != x || cell[1] != y || cell[2] != z)continue;
+					int span = end / 2;
+					if(m_added[span])continue;
+					const double* p = &m_ends[end * 3];
+					double dx = p[0] - point[0], dy = p[1] - point[1], dz = p[2] - point[2];
+					if(sqrt(dx*dx + dy*dy + dz*dz) > m_tol)continue;
+
+					// at the back, a span's start fits the right way round; at the front, its end does
+					bool is_start = (end % 2 == 0);
+					int way = (back ? 0 : 2) + ((is_start == back) ? 0 : 1);
+					int order = (span - m_old_front - 1 + n) % n;
+					if(best_span == -1 || order < best_order || (order == best_order && way < best_way))
+					{
+						best_span = span;
+						best_order = order;
+						best_way = way;
+					}
+				}
+			}
+		}
+	}
+}
+
+void CSpanLinker::StartNewChain(int span)
+{
+	std::list<Link> empty_list;
+	m_chains.push_back(empty_list);
+	m_chains.back().push_back(Link(span, false));
+	m_added[span] = 1;
+	m_old_front = span;
+	m_back = span;
+	m_front = span;
+}
+
+bool CSpanLinker::AddNext()
+{
+	// returns true, if another span was added to m_chains
+
+	if(m_back != -1)
+	{
+		// the same span is chosen as by looking through all the spans from m_old_front, trying each one at the back, then at the front
+		int best_span = -1;
+		int best_order = 0;
+		int best_way = 0;
+		if(m_has_ends[m_back])FindBest(EndPoint(m_back), true, best_span, best_order, best_way);
+		if(m_has_ends[m_front])FindBest(StartPoint(m_front), false, best_span, best_order, best_way);
+
+		if(best_span != -1)
+		{
+			bool reversed = (best_way == 1 || best_way == 3);
+			m_reversed[best_span] = reversed;
+			if(best_way < 2)
+			{
+				m_chains.back().push_back(Link(best_span, reversed));
+				m_back = best_span;
+			}
+			else
+			{
+				m_chains.back().push_front(Link(best_span, reversed));
+				m_front = best_span;
+			}
+			m_added[best_span] = 1;
+			return true;
+		}
+
+		// nothing fits the current chain
+
+		m_back = -1;
+		m_front = -1;
+
+		// there may still be some to add, find an unused span
+		while(m_first_not_added < (int)m_added.size() && m_added[m_first_not_added])m_first_not_added++;
+		if(m_first_not_added < (int)m_added.size())
+		{
+			StartNewChain(m_first_not_added);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void CSpanLinker::Do()
+{
+	if(m_has_ends.size() > 0)
+	{
+		m_added.assign(m_has_ends.size(), 0);
+		m_reversed.assign(m_has_ends.size(), 0);
+		MakeTable();
+
+		StartNewChain(0);
+
+		while(AddNext()){}
+	}
+}
@@ -0,0 +1,50 @@
+// SpanLinker.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// joins spans into chains, where each span starts where the one before it ends; CSketchRelinker uses it for the sketch's objects.
+// the span ends go in a hash table of cells, so each link only looks at the ends near the chain's back and front.
+class CSpanLinker
+{
+	double m_tol;
+	std::vector<double> m_ends; // for each span, the start point then the end point, as they were before any were reversed
+	std::vector<char> m_has_ends; // for each span
+	std::vector<char> m_added; // for each span
+	std::vector<char> m_reversed; // for each span
+	std::vector<long long> m_end_cells; // the cell of each end
+	std::vector<int> m_table; // first end in each hash table slot, or -1; each end is span index * 2, + 1 for the end point
+	std::vector<int> m_next_end; // the next end in the same slot
+	int m_shift;
+	double m_cell_size;
+	int m_old_front; // the span the current chain was started with
+	int m_first_not_added; // all the spans before this have been added
+	int m_back; // the span at the back of the current chain, or -1
+	int m_front; // the span at the front of the current chain, or -1
+
+	bool AddNext();
+	void MakeTable();
+	size_t Slot(long long x, long long y, long long z)const;
+	const double* StartPoint(int span)const{return &m_ends[span * 6 + (m_reversed[span] ? 3 : 0)];}
+	const double* EndPoint(int span)const{return &m_ends[span * 6 + (m_reversed[span] ? 0 : 3)];}
+	void FindBest(const double* point, bool back, int &best_span, int &best_order, int &best_way)const;
+	void StartNewChain(int span);
+
+public:
+	class Link
+	{
+	public:
+		int m_span; // index in the order the spans were added
+		bool m_reversed;
+		Link(int span, bool reversed):m_span(span), m_reversed(reversed){}
+	};
+
+	std::list< std::list<Link> > m_chains;
+
+	CSpanLinker(double tol):m_tol(tol), m_shift(0), m_cell_size(0.0), m_old_front(0), m_first_not_added(0), m_back(-1), m_front(-1){}
+
+	void AddSpan(const double* s, const double* e);
+	void AddSpan(); // for a span without ends, which gets a chain of its own
+	void Do(); // makes m_chains
+};
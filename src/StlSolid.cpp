@@ -3,38 +3,127 @@
 // This program is released under the BSD license. See the file COPYING for details.
 #include "stdafx.h"
 #include "StlSolid.h"
+#include "MappedFile.h"
+#include "HeeksBinaryFile.h"
 
 using namespace std;
 
-CStlTri::CStlTri(const float* t)
+// corners whose smoothed normal is more than about 30 degrees from their triangle's normal are drawn flat
+static const float crease_cos = 0.866f;
+
+// solids with up to this many triangles are written to XML in the version 1 layout
+static const size_t max_separate_xml_triangles = 1000;
+
+// the normal of the triangle p0, p1, p2; returns false for a degenerate triangle
+static bool GetTriangleNormal(const float* p0, const float* p1, const float* p2, float* n, bool normalize = true)
 {
-	memcpy(x[0], t, 9*sizeof(float));
+	float v1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+	float v2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+	n[0] = v1[1] * v2[2] - v1[2] * v2[1];
+	n[1] = v1[2] * v2[0] - v1[0] * v2[2];
+	n[2] = v1[0] * v2[1] - v1[1] * v2[0];
+	float len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	if(len < 1.0e-30f)return false;
+	if(normalize)
+	{
+		n[0] /= len;
+		n[1] /= len;
+		n[2] /= len;
+	}
+	return true;
 }
 
-CStlTri::CStlTri(const double* t)
+// merges vertices that are within tolerance of each other, using a hash of the grid cell each vertex is in
+class CVertexWelder
 {
-	x[0][0] = (float)t[0];
-	x[0][1] = (float)t[1];
-	x[0][2] = (float)t[2];
-	x[1][0] = (float)t[3];
-	x[1][1] = (float)t[4];
-	x[1][2] = (float)t[5];
-	x[2][0] = (float)t[6];
-	x[2][1] = (float)t[7];
-	x[2][2] = (float)t[8];
-}
-
-CStlSolid::CStlSolid(const HeeksColor* col):m_color(*col), m_gl_list(0){
+	std::vector<float> &m_vertices; // vertices are added to this
+	double m_tolerance;
+	double m_cell_size;
+	std::vector<int> m_heads; // first vertex in each hash bucket, or -1
+	std::vector<int> m_next; // next vertex in the same hash bucket, or -1
+
+	void GetCell(const float* p, long long* c)const
+	{
+		for(int i = 0; i<3; i++)c[i] = (long long)floor(p[i] / m_cell_size);
+	}
+
+	size_t Hash(long long x, long long y, long long z)const
+	{
+		unsigned long long h = ((unsigned long long)x * 73856093ULL) ^ ((unsigned long long)y * 19349663ULL) ^ ((unsigned long long)z * 83492791ULL);
+		// mix the high bits down, because grid coordinates are often multiples of a round number
+		h ^= h >> 31;
+		h *= 0xbf58476d1ce4e5b9ULL;
+		h ^= h >> 29;
+		return (size_t)(h & (m_heads.size() - 1));
+	}
+
+	void Link(unsigned int v)
+	{
+		long long c[3];
+		GetCell(&m_vertices[v*3], c);
+		size_t bucket = Hash(c[0], c[1], c[2]);
+		m_next[v] = m_heads[bucket];
+		m_heads[bucket] = v;
+	}
+
+	void Rehash(size_t num_buckets)
+	{
+		m_heads.assign(num_buckets, -1);
+		unsigned int num_vertices = (unsigned int)(m_vertices.size() / 3);
+		m_next.resize(num_vertices);
+		for(unsigned int v = 0; v < num_vertices; v++)Link(v);
+	}
+
+public:
+	CVertexWelder(std::vector<float> &vertices, double tolerance):m_vertices(vertices), m_tolerance(tolerance)
+	{
+		// with no tolerance, only identical positions are merged, and they are always in the same cell
+		m_cell_size = (tolerance > 0.0) ? tolerance : 1.0;
+		size_t num_buckets = 1024;
+		while(num_buckets < m_vertices.size() / 3)num_buckets *= 2;
+		Rehash(num_buckets);
+	}
+
+	// returns the index of a vertex within tolerance of p, adding p as a new vertex if there isn't one
+	unsigned int Insert(const float* p)
+	{
+		long long c[3];
+		GetCell(p, c);
+		double tol_sq = m_tolerance * m_tolerance;
+		int range = (m_tolerance > 0.0) ? 1 : 0;
+
+		for(int dx = -range; dx <= range; dx++)
+		for(int dy = -range; dy <= range; dy++)
+		for(int dz = -range; dz <= range; dz++)
+		{
+			for(int v = m_heads[Hash(c[0] + dx, c[1] + dy, c[2] + dz)]; v != -1; v = m_next[v])
+			{
+				const float* q = &m_vertices[v*3];
+				double d[3] = {q[0] - p[0], q[1] - p[1], q[2] - p[2]};
+				if(d[0] * d[0] + d[1] * d[1] + d[2] * d[2] <= tol_sq)return v;
+			}
+		}
+
+		unsigned int v = (unsigned int)(m_vertices.size() / 3);
+		m_vertices.insert(m_vertices.end(), p, p + 3);
+		m_next.push_back(-1);
+		if(m_next.size() > m_heads.size())Rehash(m_heads.size() * 2);
+		else Link(v);
+		return v;
+	}
+};
+
+CStlSolid::CStlSolid(const HeeksColor* col):m_color(*col){
 	m_title.assign(GetTypeString());
 }
 
-CStlSolid::CStlSolid():m_color(wxGetApp().current_color), m_gl_list(0){
+CStlSolid::CStlSolid():m_color(wxGetApp().current_color){
 	m_title.assign(GetTypeString());
 }
 
 #ifdef UNICODE
 // constructor for the Boost Python interface
-CStlSolid::CStlSolid(const std::wstring& filepath):m_color(wxGetApp().current_color), m_gl_list(0){
+CStlSolid::CStlSolid(const std::wstring& filepath):m_color(wxGetApp().current_color){
 	m_title.assign(GetTypeString());
 	read_from_file(filepath.c_str());
 
@@ -45,7 +134,7 @@ CStlSolid::CStlSolid(const std::wstring& filepath):m_color(wxGetApp().current_co
 }
 #endif
 
-CStlSolid::CStlSolid(const wxChar* filepath, const HeeksColor* col):m_color(*col), m_gl_list(0){
+CStlSolid::CStlSolid(const wxChar* filepath, const HeeksColor* col):m_color(*col){
 	m_title.assign(GetTypeString());
 	read_from_file(filepath);
 
@@ -57,88 +146,114 @@ CStlSolid::CStlSolid(const wxChar* filepath, const HeeksColor* col):m_color(*col
 
 void CStlSolid::read_from_file(const wxChar* filepath)
 {
-	// read the stl file
-	ifstream ifs(Ttc(filepath), ios::binary);
-	if(!ifs)return;
+	// map the whole file into memory, rather than reading it facet by facet
+	CMappedFile file(filepath);
+	if(!file.IsOpen())return;
+
+	const char* data = file.Data();
+	size_t size = file.Size();
+	if(size < 5)return;
+
+	// a binary file has an 80 byte header, a facet count, then 50 bytes per facet.
+	// some binary files also start with "solid", so check the file size matches before trusting the text
+	unsigned int num_facets = 0;
+	if(size >= 84)memcpy(&num_facets, &data[80], 4);
+	bool size_matches_binary = (size >= 84) && ((size - 84) / 50 == num_facets) && ((size - 84) % 50 == 0);
 
-	char solid_string[6] = "aaaaa";
-	ifs.read(solid_string, 5);
-	if(ifs.eof())return;
-	if(strcmp(solid_string, "solid"))
+	if(size_matches_binary || strncmp(data, "solid", 5))
 	{
-		// try binary file read
+		if(size < 84)return;
 
-		// read the header
-		char header[81];
-		header[80] = 0;
-		memcpy(header, solid_string, 5);
-		ifs.read(&header[5], 75);
+		// don't read beyond the end of a truncated file
+		size_t facets_in_file = (size - 84) / 50;
+		if(num_facets > facets_in_file)num_facets = (unsigned int)facets_in_file;
 
-		unsigned int num_facets = 0;
-		ifs.read((char*)(&num_facets), 4);
+		read_binary(&data[84], num_facets, wxGetApp().m_stl_weld_tolerance);
+	}
+	else
+	{
+		file.Close();
+		read_ascii(filepath);
+		Weld(wxGetApp().m_stl_weld_tolerance);
+	}
+}
 
-		for(unsigned int i = 0; i<num_facets; i++)
+void CStlSolid::read_binary(const char* data, unsigned int num_facets, double weld_tolerance)
+{
+	m_indices.reserve(m_indices.size() + (size_t)num_facets * 3);
+	CVertexWelder welder(m_vertices, weld_tolerance);
+
+	for(unsigned int i = 0; i<num_facets; i++)
+	{
+		// skip the 12 byte normal, weld the three 12 byte corners, skip the 2 byte attribute
+		const char* facet = &data[i * 50];
+		unsigned int v[3];
+		for(int j = 0; j<3; j++)
 		{
-			CStlTri tri;
-			float n[3];
-			ifs.read((char*)(n), 12);
-			ifs.read((char*)(tri.x[0]), 36);
-			short attr;
-			ifs.read((char*)(&attr), 2);
-			m_list.push_back(tri);
+			float p[3];
+			memcpy(p, &facet[12 + j * 12], 12);
+			v[j] = welder.Insert(p);
 		}
+
+		if(v[0] == v[1] || v[1] == v[2] || v[2] == v[0])continue;
+		m_indices.insert(m_indices.end(), v, v + 3);
 	}
-	else
-	{
-		// "solid" already found
-		char str[1024] = "solid";
-		ifs.getline(&str[5], 1024);
-		char title[1024];
-		if(sscanf(str, "solid %s", title) == 1)
-			m_title.assign(Ctt(title));
 
-		CStlTri t;
-		char five_chars[6] = "aaaaa";
+	m_normals.clear();
+}
 
-		int vertex = 0;
+void CStlSolid::read_ascii(const wxChar* filepath)
+{
+	ifstream ifs(Ttc(filepath));
+	if(!ifs)return;
 
-		while(!ifs.eof())
-		{
-			ifs.getline(str, 1024);
+	char str[1024];
+	ifs.getline(str, 1024);
+	char title[1024];
+	if(sscanf(str, "solid %s", title) == 1)
+		m_title.assign(Ctt(title));
 
-			int i = 0, j = 0;
-			for(; i<5; i++, j++)
-			{
-				if(str[j] == 0)break;
-				while(str[j] == ' ' || str[j] == '\t')j++;
-				five_chars[i] = str[j];
-			}
-			if(i == 5)
+	float t[3][3];
+	char five_chars[6] = "aaaaa";
+
+	int vertex = 0;
+
+	while(!ifs.eof())
+	{
+		ifs.getline(str, 1024);
+
+		int i = 0, j = 0;
+		for(; i<5; i++, j++)
+		{
+			if(str[j] == 0)break;
+			while(str[j] == ' ' || str[j] == '\t')j++;
+			five_chars[i] = str[j];
+		}
+		if(i == 5)
+		{
+			if(!strcmp(five_chars, "verte"))
 			{
-				if(!strcmp(five_chars, "verte"))
-				{
 #ifdef WIN32
-					sscanf(str, " vertex %f %f %f", &(t.x[vertex][0]), &(t.x[vertex][1]), &(t.x[vertex][2]));
+				sscanf(str, " vertex %f %f %f", &(t[vertex][0]), &(t[vertex][1]), &(t[vertex][2]));
 #else
-					std::istringstream ss(str);
-					ss.imbue(std::locale("C"));
-					while(ss.peek() == ' ') ss.seekg(1, ios_base::cur);
-					ss.seekg(std::string("vertex").size(), ios_base::cur);
-					ss >> t.x[vertex][0] >> t.x[vertex][1] >> t.x[vertex][2];
+				std::istringstream ss(str);
+				ss.imbue(std::locale("C"));
+				while(ss.peek() == ' ') ss.seekg(1, ios_base::cur);
+				ss.seekg(std::string("vertex").size(), ios_base::cur);
+				ss >> t[vertex][0] >> t[vertex][1] >> t[vertex][2];
 #endif
-					vertex++;
-					if(vertex > 2)vertex = 2;
-				}
-				else if(!strcmp(five_chars, "facet"))
-				{
-					vertex = 0;
-				}
-				else if(!strcmp(five_chars, "endfa"))
+				vertex++;
+				if(vertex > 2)vertex = 2;
+			}
+			else if(!strcmp(five_chars, "facet"))
+			{
+				vertex = 0;
+			}
+			else if(!strcmp(five_chars, "endfa"))
+			{
+				if(vertex == 2)
 				{
-					if(vertex == 2)
-					{
-						m_list.push_back(t);
-					}
+					AddTriangle(&t[0][0]);
 				}
 			}
 		}
@@ -146,7 +261,6 @@ void CStlSolid::read_from_file(const wxChar* filepath)
 }
 
 CStlSolid::~CStlSolid(){
-	KillGLLists();
 }
 
 const CStlSolid& CStlSolid::operator=(const CStlSolid& s)
@@ -156,12 +270,13 @@ const CStlSolid& CStlSolid::operator=(const CStlSolid& s)
 	// don't copy id
 	m_box = s.m_box;
 	m_title = s.m_title;
-	KillGLLists();
+	m_buffer.Destroy();
 
 	m_color = s.m_color;
 
-	m_list.clear();
-	std::copy( s.m_list.begin(), s.m_list.end(), std::inserter( m_list, m_list.begin() ));
+	m_vertices = s.m_vertices;
+	m_normals = s.m_normals;
+	m_indices = s.m_indices;
 
 	return *this;
 }
@@ -176,14 +291,12 @@ bool CStlSolid::IsDifferent(HeeksObj* other)
 }
 
 
-void CStlSolid::KillGLLists()
+void CStlSolid::OnRemove()
 {
-	if (m_gl_list)
-	{
-		glDeleteLists(m_gl_list, 1);
-		m_gl_list = 0;
-		m_box = CBox();
-	}
+	HeeksObj::OnRemove();
+
+	// the buffer doesn't depend on the view, so it is kept by KillGLLists, but not when removed from the document
+	if(m_owner == NULL)m_buffer.Destroy();
 }
 
 const wxBitmap &CStlSolid::GetIcon()
@@ -193,87 +306,123 @@ const wxBitmap &CStlSolid::GetIcon()
 	return *icon;
 }
 
-void CStlSolid::glCommands(bool select, bool marked, bool no_color){
-	glEnable(GL_LIGHTING);
-	Material(m_color).glMaterial(1.0);
+void CStlSolid::CalculateNormals()
+{
+	// each vertex normal is the sum of the triangle normals around it, weighted by triangle area
+	m_normals.assign(m_vertices.size(), 0.0f);
+	for(size_t i = 0; i + 2 < m_indices.size(); i += 3)
+	{
+		float n[3];
+		if(!GetTriangleNormal(&m_vertices[m_indices[i]*3], &m_vertices[m_indices[i+1]*3], &m_vertices[m_indices[i+2]*3], n, false))continue;
+		for(int j = 0; j<3; j++)
+		{
+			float* vn = &m_normals[m_indices[i+j]*3];
+			vn[0] += n[0];
+			vn[1] += n[1];
+			vn[2] += n[2];
+		}
+	}
 
-	if(m_gl_list)
+	for(size_t i = 0; i + 2 < m_normals.size(); i += 3)
 	{
-		glCallList(m_gl_list);
+		float* vn = &m_normals[i];
+		float len = sqrt(vn[0] * vn[0] + vn[1] * vn[1] + vn[2] * vn[2]);
+		if(len < 1.0e-30f)continue;
+		vn[0] /= len;
+		vn[1] /= len;
+		vn[2] /= len;
 	}
-	else{
-		m_gl_list = glGenLists(1);
-		glNewList(m_gl_list, GL_COMPILE_AND_EXECUTE);
+}
+
+const float* CStlSolid::GetCornerNormal(unsigned int vertex, const float* face_normal)const
+{
+	const float* vn = &m_normals[vertex*3];
+	if(vn[0] * face_normal[0] + vn[1] * face_normal[1] + vn[2] * face_normal[2] < crease_cos)return face_normal;
+	return vn;
+}
+
+void CStlSolid::UpdateBuffer()
+{
+	if(m_normals.size() != m_vertices.size())CalculateNormals();
 
-		// render all the triangles
-		glBegin(GL_TRIANGLES);
-		for(std::list<CStlTri>::iterator It = m_list.begin(); It != m_list.end(); It++)
+	// smooth corners use the shared vertex; corners on a crease get their own copy of the vertex, with the triangle's normal
+	std::vector<float> vertices(m_vertices);
+	std::vector<float> normals(m_normals);
+	std::vector<unsigned int> indices;
+	indices.reserve(m_indices.size());
+
+	float n[3];
+	for(size_t i = 0; i + 2 < m_indices.size(); i += 3)
+	{
+		const unsigned int* v = &m_indices[i];
+		if(!GetTriangleNormal(&m_vertices[v[0]*3], &m_vertices[v[1]*3], &m_vertices[v[2]*3], n))continue;
+		for(int j = 0; j<3; j++)
 		{
-			CStlTri &t = *It;
-			gp_Pnt p0(t.x[0][0], t.x[0][1], t.x[0][2]);
-			gp_Pnt p1(t.x[1][0], t.x[1][1], t.x[1][2]);
-			gp_Pnt p2(t.x[2][0], t.x[2][1], t.x[2][2]);
-			gp_Vec v1(p0, p1);
-			gp_Vec v2(p0, p2);
-			try
+			if(GetCornerNormal(v[j], n) == n)
 			{
-				gp_Vec norm = (v1 ^ v2).Normalized();
-				float n[3];
-				n[0] = (float)(norm.X());
-				n[1] = (float)(norm.Y());
-				n[2] = (float)(norm.Z());
-				glNormal3fv(n);
-				glVertex3fv(t.x[0]);
-				glVertex3fv(t.x[1]);
-				glVertex3fv(t.x[2]);
+				indices.push_back((unsigned int)(vertices.size() / 3));
+				const float* p = &m_vertices[v[j]*3];
+				vertices.insert(vertices.end(), p, p + 3);
+				normals.insert(normals.end(), n, n + 3);
 			}
-			catch(...)
+			else
 			{
+				indices.push_back(v[j]);
 			}
 		}
-		glEnd();
-
-		glEndList();
 	}
 
+	m_buffer.SetData(vertices, normals, indices);
+}
+
+void CStlSolid::glCommands(bool select, bool marked, bool no_color){
+	glEnable(GL_LIGHTING);
+	glShadeModel(GL_SMOOTH);
+	Material(m_color).glMaterial(1.0);
+
+	// render all the triangles
+	if(m_buffer.IsEmpty())UpdateBuffer();
+	m_buffer.Draw(GL_TRIANGLES);
+
+	glShadeModel(GL_FLAT);
 	glDisable(GL_LIGHTING);
 }
 
 void CStlSolid::GetBox(CBox &box){
 	if(!m_box.m_valid)
 	{
-		// calculate the box for all the triangles
-		for(std::list<CStlTri>::iterator It = m_list.begin(); It != m_list.end(); It++)
-		{
-			CStlTri &t = *It;
-			m_box.Insert(t.x[0][0], t.x[0][1], t.x[0][2]);
-			m_box.Insert(t.x[1][0], t.x[1][1], t.x[1][2]);
-			m_box.Insert(t.x[2][0], t.x[2][1], t.x[2][2]);
-		}
+		// calculate the box for all the vertices
+		for(size_t i = 0; i + 2 < m_vertices.size(); i += 3)
+			m_box.Insert(m_vertices[i], m_vertices[i+1], m_vertices[i+2]);
 	}
 
 	box.Insert(m_box);
 }
 
 void CStlSolid::ModifyByMatrix(const double* m){
-	gp_Trsf mat = make_matrix(m);
-	for(std::list<CStlTri>::iterator It = m_list.begin(); It != m_list.end(); It++)
+	TransformVertices(m);
+	OnVerticesTransformed();
+}
+
+void CStlSolid::TransformVertices(const double* m){
+	// m is a row major 4x4 matrix, which is applied directly, rather than making a gp_Pnt for every vertex
+	for(size_t i = 0; i + 2 < m_vertices.size(); i += 3)
 	{
-		CStlTri &t = *It;
-		for(int i = 0; i<3; i++){
-			gp_Pnt vx;
-			vx = gp_Pnt(t.x[i][0], t.x[i][1], t.x[i][2]);
-			vx.Transform(mat);
-			t.x[i][0] = (float)vx.X();
-			t.x[i][1] = (float)vx.Y();
-			t.x[i][2] = (float)vx.Z();
-		}
+		float* p = &m_vertices[i];
+		double x = p[0], y = p[1], z = p[2];
+		p[0] = (float)(m[0] * x + m[1] * y + m[2] * z + m[3]);
+		p[1] = (float)(m[4] * x + m[5] * y + m[6] * z + m[7]);
+		p[2] = (float)(m[8] * x + m[9] * y + m[10] * z + m[11]);
 	}
+}
 
-	KillGLLists();
+void CStlSolid::OnVerticesTransformed(){
+	m_normals.clear();
+	m_buffer.Destroy();
+	m_box = CBox();
 }
 
-CStlSolid::CStlSolid( const CStlSolid & rhs ) : m_gl_list(0)
+CStlSolid::CStlSolid( const CStlSolid & rhs )
 {
     *this = rhs;    // Call the assignment operator.
 }
@@ -294,44 +443,56 @@ void CStlSolid::OnEditString(const wxChar* str){
 }
 
 void CStlSolid::GetTriangles(void(*callbackfunc)(const double* x, const double* n), double cusp, bool just_one_average_normal){
+	if(!just_one_average_normal && m_normals.size() != m_vertices.size())CalculateNormals();
+
 	double x[9];
 	double n[9];
-	for(std::list<CStlTri>::iterator It = m_list.begin(); It != m_list.end(); It++)
+	float fn[3];
+	for(size_t i = 0; i + 2 < m_indices.size(); i += 3)
 	{
-		CStlTri &t = *It;
-		x[0] = t.x[0][0];
-		x[1] = t.x[0][1];
-		x[2] = t.x[0][2];
-		x[3] = t.x[1][0];
-		x[4] = t.x[1][1];
-		x[5] = t.x[1][2];
-		x[6] = t.x[2][0];
-		x[7] = t.x[2][1];
-		x[8] = t.x[2][2];
-		gp_Pnt p0(t.x[0][0], t.x[0][1], t.x[0][2]);
-		gp_Pnt p1(t.x[1][0], t.x[1][1], t.x[1][2]);
-		gp_Pnt p2(t.x[2][0], t.x[2][1], t.x[2][2]);
-		gp_Vec v1(p0, p1);
-		gp_Vec v2(p0, p2);
-		try
+		const unsigned int* v = &m_indices[i];
+		if(!GetTriangleNormal(&m_vertices[v[0]*3], &m_vertices[v[1]*3], &m_vertices[v[2]*3], fn))continue;
+		for(int j = 0; j<3; j++)
+		{
+			const float* p = &m_vertices[v[j]*3];
+			x[j*3] = p[0];
+			x[j*3+1] = p[1];
+			x[j*3+2] = p[2];
+		}
+		if(just_one_average_normal)
+		{
+			n[0] = fn[0];
+			n[1] = fn[1];
+			n[2] = fn[2];
+		}
+		else
 		{
-			gp_Vec norm = (v1 ^ v2).Normalized();
-			n[0] = norm.X();
-			n[1] = norm.Y();
-			n[2] = norm.Z();
-			if(!just_one_average_normal)
+			for(int j = 0; j<3; j++)
 			{
-				n[3] = n[0];
-				n[4] = n[1];
-				n[5] = n[2];
-				n[6] = n[0];
-				n[7] = n[1];
-				n[8] = n[2];
+				const float* cn = GetCornerNormal(v[j], fn);
+				n[j*3] = cn[0];
+				n[j*3+1] = cn[1];
+				n[j*3+2] = cn[2];
 			}
-			(*callbackfunc)(x, n);
 		}
-		catch(...)
+		(*callbackfunc)(x, n);
+	}
+}
+
+void CStlSolid::GetTriangleCorners(std::vector<float> &corners)const
+{
+	corners.reserve(corners.size() + m_indices.size() * 3);
+	float fn[3];
+	for(size_t i = 0; i + 2 < m_indices.size(); i += 3)
+	{
+		const unsigned int* v = &m_indices[i];
+		if(!GetTriangleNormal(&m_vertices[v[0]*3], &m_vertices[v[1]*3], &m_vertices[v[2]*3], fn, false))continue;
+		for(int j = 0; j<3; j++)
 		{
+			const float* p = &m_vertices[v[j]*3];
+			corners.push_back(p[0]);
+			corners.push_back(p[1]);
+			corners.push_back(p[2]);
 		}
 	}
 }
@@ -343,22 +504,52 @@ void CStlSolid::WriteXML(TiXmlNode *root)
 	root->LinkEndChild( element );
 	element->SetAttribute("col", m_color.COLORREF_color());
 
-	for(std::list<CStlTri>::iterator It = m_list.begin(); It != m_list.end(); It++)
+	// small solids, and files for older versions, have the corners of each triangle, which every version can read
+	if(wxGetApp().m_save_for_older_versions || m_indices.size() <= 3 * max_separate_xml_triangles)
+	{
+		for(size_t i = 0; i + 2 < m_indices.size(); i += 3)
+		{
+			TiXmlElement * child_element;
+			child_element = new TiXmlElement( "tri" );
+			element->LinkEndChild( child_element );
+			const float* p1 = &m_vertices[m_indices[i] * 3];
+			const float* p2 = &m_vertices[m_indices[i+1] * 3];
+			const float* p3 = &m_vertices[m_indices[i+2] * 3];
+			child_element->SetDoubleAttribute("p1x", p1[0]);
+			child_element->SetDoubleAttribute("p1y", p1[1]);
+			child_element->SetDoubleAttribute("p1z", p1[2]);
+			child_element->SetDoubleAttribute("p2x", p2[0]);
+			child_element->SetDoubleAttribute("p2y", p2[1]);
+			child_element->SetDoubleAttribute("p2z", p2[2]);
+			child_element->SetDoubleAttribute("p3x", p3[0]);
+			child_element->SetDoubleAttribute("p3y", p3[1]);
+			child_element->SetDoubleAttribute("p3z", p3[2]);
+		}
+
+		WriteBaseXML(element);
+		return;
+	}
+
+	// version 2 has the shared vertices, then the triangles' vertex indices, as text in the element.
+	// version 1 readers take every child element as a triangle, but skip text, so they find an empty solid
+	element->SetAttribute("version", 2);
+	element->SetAttribute("vertices", (int)NumVertices());
+	element->SetAttribute("triangles", (int)(m_indices.size() / 3));
+
+	std::string text;
+	text.reserve(m_vertices.size() * 12 + m_indices.size() * 8);
+	char number[64];
+	for(size_t i = 0; i < m_vertices.size(); i++)
 	{
-		CStlTri &t = *It;
-		TiXmlElement * child_element;
-		child_element = new TiXmlElement( "tri" );
-		element->LinkEndChild( child_element );
-		child_element->SetDoubleAttribute("p1x", t.x[0][0]);
-		child_element->SetDoubleAttribute("p1y", t.x[0][1]);
-		child_element->SetDoubleAttribute("p1z", t.x[0][2]);
-		child_element->SetDoubleAttribute("p2x", t.x[1][0]);
-		child_element->SetDoubleAttribute("p2y", t.x[1][1]);
-		child_element->SetDoubleAttribute("p2z", t.x[1][2]);
-		child_element->SetDoubleAttribute("p3x", t.x[2][0]);
-		child_element->SetDoubleAttribute("p3y", t.x[2][1]);
-		child_element->SetDoubleAttribute("p3z", t.x[2][2]);
+		sprintf(number, "%.9g ", m_vertices[i]);
+		text += number;
 	}
+	for(size_t i = 0; i < m_indices.size(); i++)
+	{
+		sprintf(number, "%u ", m_indices[i]);
+		text += number;
+	}
+	element->LinkEndChild( new TiXmlText(text.c_str()) );
 
 	WriteBaseXML(element);
 }
@@ -368,7 +559,6 @@ void CStlSolid::WriteXML(TiXmlNode *root)
 HeeksObj* CStlSolid::ReadFromXMLElement(TiXmlElement* pElem)
 {
 	HeeksColor c;
-	CStlTri t;
 
 	// get the attributes
 	for(TiXmlAttribute* a = pElem->FirstAttribute(); a; a = a->Next())
@@ -379,32 +569,180 @@ HeeksObj* CStlSolid::ReadFromXMLElement(TiXmlElement* pElem)
 
 	CStlSolid* new_object = new CStlSolid(&c);
 
-	// loop through all the "tri" objects
-	double x[3][3];
+	int version = 1;
+	pElem->Attribute("version", &version);
+	bool old_format = false;
 
-	for(TiXmlElement* pTriElem = TiXmlHandle(pElem).FirstChildElement().Element(); pTriElem;	pTriElem = pTriElem->NextSiblingElement())
+	if(version >= 2)
 	{
-		// get the attributes
-		pTriElem->Attribute("p1x", &x[0][0]);
-		pTriElem->Attribute("p1y", &x[0][1]);
-		pTriElem->Attribute("p1z", &x[0][2]);
-		pTriElem->Attribute("p2x", &x[1][0]);
-		pTriElem->Attribute("p2y", &x[1][1]);
-		pTriElem->Attribute("p2z", &x[1][2]);
-		pTriElem->Attribute("p3x", &x[2][0]);
-		pTriElem->Attribute("p3y", &x[2][1]);
-		pTriElem->Attribute("p3z", &x[2][2]);
-		new_object->m_list.push_back(CStlTri(&x[0][0]));
+		// the vertices, then the indices, as text
+		int num_vertices = 0;
+		int num_triangles = 0;
+		pElem->Attribute("vertices", &num_vertices);
+		pElem->Attribute("triangles", &num_triangles);
+		const char* text = NULL;
+		for(TiXmlNode* child = pElem->FirstChild(); child; child = child->NextSibling())
+		{
+			if(child->ToText()){text = child->Value(); break;}
+		}
+
+		if(text && num_vertices > 0 && num_triangles > 0)
+		{
+			char* end = NULL;
+			const char* p = text;
+			new_object->m_vertices.reserve(num_vertices * 3);
+			for(int i = 0; i < num_vertices * 3; i++, p = end)
+			{
+				float f = (float)strtod(p, &end);
+				if(end == p)break;
+				new_object->m_vertices.push_back(f);
+			}
+			new_object->m_indices.reserve(num_triangles * 3);
+			for(int i = 0; i < num_triangles * 3; i++, p = end)
+			{
+				unsigned long v = strtoul(p, &end, 10);
+				if(end == p)break;
+				new_object->m_indices.push_back((unsigned int)v);
+			}
+
+			// a short list of numbers loses the solid's triangles
+			if(new_object->m_vertices.size() != (size_t)num_vertices * 3 || new_object->m_indices.size() != (size_t)num_triangles * 3)
+			{
+				new_object->m_vertices.clear();
+				new_object->m_indices.clear();
+			}
+		}
+	}
+	else
+	{
+		// version 1 has a "tri" element with the nine coordinates of each triangle; anything else is skipped
+		float x[3][3] = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
+		for(TiXmlElement* pTriElem = TiXmlHandle(pElem).FirstChildElement("tri").Element(); pTriElem; pTriElem = pTriElem->NextSiblingElement("tri"))
+		{
+			if(pTriElem->Attribute("p1x") == NULL)continue;
+			pTriElem->QueryFloatAttribute("p1x", &x[0][0]);
+			pTriElem->QueryFloatAttribute("p1y", &x[0][1]);
+			pTriElem->QueryFloatAttribute("p1z", &x[0][2]);
+			pTriElem->QueryFloatAttribute("p2x", &x[1][0]);
+			pTriElem->QueryFloatAttribute("p2y", &x[1][1]);
+			pTriElem->QueryFloatAttribute("p2z", &x[1][2]);
+			pTriElem->QueryFloatAttribute("p3x", &x[2][0]);
+			pTriElem->QueryFloatAttribute("p3y", &x[2][1]);
+			pTriElem->QueryFloatAttribute("p3z", &x[2][2]);
+			new_object->AddTriangle(&x[0][0]);
+			old_format = true;
+		}
+	}
+
+	// don't trust indices that refer to missing vertices
+	unsigned int num_vertices = new_object->NumVertices();
+	for(std::vector<unsigned int>::iterator It = new_object->m_indices.begin(); It != new_object->m_indices.end(); It++)
+	{
+		if(*It >= num_vertices)
+		{
+			new_object->m_indices.clear();
+			break;
+		}
 	}
 
+	if(old_format)new_object->Weld(0.0);
+
 	new_object->ReadBaseXML(pElem);
 
 	return new_object;
 }
 
-void CStlSolid::AddTriangle(float* t)
+void CStlSolid::WriteBinary(CBinaryFileWriter &writer)
+{
+	writer.BeginChunk(BinaryChunkStlSolid);
+	writer.WriteInt((int)(m_color.COLORREF_color()));
+
+	// the id and visibility, written the same as for the XML file
+	TiXmlElement base_element("base");
+	WriteBaseXML(&base_element);
+	TiXmlPrinter printer;
+	base_element.Accept(&printer);
+	writer.WriteString(printer.Str());
+
+	// the arrays, as they are in memory
+	writer.WriteInt(NumVertices());
+	if(m_vertices.size() > 0)writer.Write(&m_vertices[0], m_vertices.size() * sizeof(float));
+	writer.WriteInt(NumTriangles());
+	if(m_indices.size() > 0)writer.Write(&m_indices[0], m_indices.size() * sizeof(unsigned int));
+	writer.EndChunk();
+}
+
+// static member function
+HeeksObj* CStlSolid::ReadFromBinary(CBinaryFileReader &reader)
+{
+	int col;
+	std::string base_text;
+	int num_vertices, num_triangles;
+	if(!reader.ReadInt(col) || !reader.ReadString(base_text) || !reader.ReadInt(num_vertices) || num_vertices < 0)return NULL;
+	const char* vertices = reader.Read((size_t)num_vertices * 3 * sizeof(float));
+	if(vertices == NULL || !reader.ReadInt(num_triangles) || num_triangles < 0)return NULL;
+	const char* indices = reader.Read((size_t)num_triangles * 3 * sizeof(unsigned int));
+	if(indices == NULL)return NULL;
+
+	HeeksColor c((long)col);
+	CStlSolid* new_object = new CStlSolid(&c);
+	new_object->m_vertices.resize(num_vertices * 3);
+	if(num_vertices > 0)memcpy(&new_object->m_vertices[0], vertices, num_vertices * 3 * sizeof(float));
+	new_object->m_indices.resize(num_triangles * 3);
+	if(num_triangles > 0)memcpy(&new_object->m_indices[0], indices, num_triangles * 3 * sizeof(unsigned int));
+
+	// don't trust indices that refer to missing vertices
+	for(std::vector<unsigned int>::iterator It = new_object->m_indices.begin(); It != new_object->m_indices.end(); It++)
+	{
+		if(*It >= (unsigned int)num_vertices)
+		{
+			new_object->m_indices.clear();
+			break;
+		}
+	}
+
+	TiXmlDocument base_doc;
+	base_doc.Parse(base_text.c_str());
+	if(base_doc.FirstChildElement())new_object->ReadBaseXML(base_doc.FirstChildElement());
+
+	return new_object;
+}
+
+void CStlSolid::AddTriangle(const float* t)
 {
-	CStlTri tri(t);
-	m_list.push_back(tri);
+	// the corners are not shared with other triangles until Weld is called
+	unsigned int v = NumVertices();
+	m_vertices.insert(m_vertices.end(), t, t + 9);
+	m_indices.push_back(v);
+	m_indices.push_back(v + 1);
+	m_indices.push_back(v + 2);
+	m_normals.clear();
+	m_buffer.Destroy();
+	m_box = CBox();
 }
 
+void CStlSolid::Weld(double tolerance)
+{
+	std::vector<float> old_vertices;
+	old_vertices.swap(m_vertices);
+	std::vector<unsigned int> old_indices;
+	old_indices.swap(m_indices);
+
+	std::vector<unsigned int> new_index(old_vertices.size() / 3);
+	{
+		CVertexWelder welder(m_vertices, tolerance);
+		for(size_t i = 0; i < new_index.size(); i++)new_index[i] = welder.Insert(&old_vertices[i*3]);
+	}
+
+	// triangles which have collapsed to a line or a point are removed
+	m_indices.reserve(old_indices.size());
+	for(size_t i = 0; i + 2 < old_indices.size(); i += 3)
+	{
+		unsigned int v[3] = {new_index[old_indices[i]], new_index[old_indices[i+1]], new_index[old_indices[i+2]]};
+		if(v[0] == v[1] || v[1] == v[2] || v[2] == v[0])continue;
+		m_indices.insert(m_indices.end(), v, v + 3);
+	}
+
+	m_normals.clear();
+	m_buffer.Destroy();
+}
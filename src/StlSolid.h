@@ -3,26 +3,29 @@
 // This program is released under the BSD license. See the file COPYING for details.
 
 #include "../interface/HeeksObj.h"
+#include "VertexBuffer.h"
 
-class CStlTri{
-public:
-	float x[3][3];
-	CStlTri(){}
-	CStlTri(const float* t);
-	CStlTri(const double* t);
-};
+class CBinaryFileWriter;
+class CBinaryFileReader;
 
 class CStlSolid:public HeeksObj{
 private:
 	HeeksColor m_color;
-	int m_gl_list;
+	CVertexBuffer m_buffer; // what is drawn; emptied when the triangles change
 	CBox m_box;
 	wxString m_title;
 
 	void read_from_file(const wxChar* filepath);
+	void read_binary(const char* data, unsigned int num_facets, double weld_tolerance);
+	void read_ascii(const wxChar* filepath);
+	void CalculateNormals();
+	const float* GetCornerNormal(unsigned int vertex, const float* face_normal)const;
+	void UpdateBuffer();
 
 public:
-	std::list<CStlTri> m_list;
+	std::vector<float> m_vertices; // x, y, z of each vertex, shared by the triangles which use it
+	std::vector<float> m_normals; // x, y, z of each vertex's normal; calculated when needed
+	std::vector<unsigned int> m_indices; // three vertex indices per triangle
 
 	CStlSolid();
 	CStlSolid(const HeeksColor* col);
@@ -44,8 +47,10 @@ public:
 	void SetColor(const HeeksColor &col){m_color = col;}
 	const HeeksColor* GetColor()const{return &m_color;}
 	void GetBox(CBox &box);
-	void KillGLLists(void);
+	void OnRemove();
 	void ModifyByMatrix(const double* m);
+	void TransformVertices(const double* m); // the first part of ModifyByMatrix, which can be run on a worker thread
+	void OnVerticesTransformed(); // the rest of ModifyByMatrix, which empties the buffer
 	const wxChar* GetShortString(void)const{return m_title.c_str();}
 	bool CanEditString(void)const{return true;}
 	void OnEditString(const wxChar* str);
@@ -56,7 +61,13 @@ public:
 	bool IsDifferent(HeeksObj* obj);
 
 	static HeeksObj* ReadFromXMLElement(TiXmlElement* pElem);
+	void WriteBinary(CBinaryFileWriter &writer);
+	static HeeksObj* ReadFromBinary(CBinaryFileReader &reader);
 
-	void AddTriangle(float* t); // 9 floats
+	void AddTriangle(const float* t); // 9 floats
+	void Weld(double tolerance); // merge vertices within tolerance of each other, so triangles share them
+	unsigned int NumTriangles()const{return (unsigned int)(m_indices.size() / 3);}
+	unsigned int NumVertices()const{return (unsigned int)(m_vertices.size() / 3);}
+	void GetTriangleCorners(std::vector<float> &corners)const; // appends 9 floats for each triangle, leaving out degenerate ones; doesn't change the solid, so can be used on any thread
 };
 
@@ -27,6 +27,7 @@ const wxChar* StretchTool::GetTitle(){
 void StretchTool::Run(bool redo){
 	m_undo_uses_add = m_object->Stretch(m_pos, m_shift, m_data);
 	for(int i = 0; i<3; i++)m_new_pos[i]= m_pos[i] + m_shift[i];
+	wxGetApp().WasModified(m_object);
 }
 
 void StretchTool::RollBack(){
@@ -36,5 +37,6 @@ void StretchTool::RollBack(){
 			unshift[i] = -m_shift[i];
 		}
 		m_object->Stretch(m_new_pos, unshift, m_data);
+		wxGetApp().WasModified(m_object);
 	}
 }
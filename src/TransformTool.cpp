@@ -4,6 +4,9 @@
 #include "stdafx.h"
 #include "TransformTool.h"
 #include "../interface/HeeksObj.h"
+#include "Shape.h"
+#include "StlSolid.h"
+#include "WorkerPool.h"
 
 TransformTool::TransformTool(HeeksObj *o, const gp_Trsf &t, const gp_Trsf &i){
 	object = o;
@@ -32,6 +35,54 @@ void TransformTool::RollBack(){
 	wxGetApp().WasModified(object);
 }
 
+class CTransformGeometryTask: public CWorkerTask
+{
+	HeeksObj* m_object;
+	const double* m_m;
+	gp_Trsf m_mat;
+
+public:
+	CTransformGeometryTask(HeeksObj* object, const double* m):m_object(object), m_m(m), m_mat(make_matrix(m)){}
+
+	void Run()
+	{
+		if(m_object->GetType() == StlSolidType)((CStlSolid*)m_object)->TransformVertices(m_m);
+		else ((CShape*)m_object)->TransformShape(m_mat);
+	}
+
+	// the display lists and child objects are remade on the main thread
+	void Finish()
+	{
+		if(m_object->GetType() == StlSolidType)((CStlSolid*)m_object)->OnVerticesTransformed();
+		else ((CShape*)m_object)->OnShapeTransformed();
+	}
+};
+
+static void ModifyObjectsByMatrix(const std::list<HeeksObj*> &list, const double* m)
+{
+	// transform the geometry of the solids and STL solids on all the processors, then everything else
+	std::vector<CWorkerTask*> tasks;
+	for(std::list<HeeksObj*>::const_iterator It = list.begin(); It != list.end(); It++)
+	{
+		HeeksObj* object = *It;
+		if(CShape::IsTypeAShape(object->GetType()) || object->GetType() == StlSolidType)tasks.push_back(new CTransformGeometryTask(object, m));
+	}
+	CWorkerPool::Run(tasks);
+
+	for(std::vector<CWorkerTask*>::iterator It = tasks.begin(); It != tasks.end(); It++)
+	{
+		CTransformGeometryTask* task = (CTransformGeometryTask*)(*It);
+		task->Finish();
+		delete task;
+	}
+
+	for(std::list<HeeksObj*>::const_iterator It = list.begin(); It != list.end(); It++)
+	{
+		HeeksObj* object = *It;
+		if(!CShape::IsTypeAShape(object->GetType()) && object->GetType() != StlSolidType)object->ModifyByMatrix(m);
+	}
+}
+
 TransformObjectsTool::TransformObjectsTool(const std::list<HeeksObj*> &list, const gp_Trsf &t, const gp_Trsf &i){
 	m_list = list;
 	extract(t, modify_matrix);
@@ -47,19 +98,11 @@ const wxChar* TransformObjectsTool::GetTitle(){
 }
 
 void TransformObjectsTool::Run(bool redo){
-	std::list<HeeksObj*>::iterator It;
-	for(It = m_list.begin(); It != m_list.end(); It++){
-		HeeksObj* object = *It;
-		object->ModifyByMatrix(modify_matrix);
-	}
+	ModifyObjectsByMatrix(m_list, modify_matrix);
 	wxGetApp().WereModified(m_list);
 }
 
 void TransformObjectsTool::RollBack(){
-	std::list<HeeksObj*>::const_iterator It;
-	for(It = m_list.begin(); It != m_list.end(); It++){
-		HeeksObj* object = *It;
-		object->ModifyByMatrix(revert_matrix);
-	}
+	ModifyObjectsByMatrix(m_list, revert_matrix);
 	wxGetApp().WereModified(m_list);
 }
@@ -11,6 +11,7 @@
 #include "HLine.h"
 #include "HILine.h"
 #include "HeeksConfig.h"
+#include "Instance.h"
 
 //static double from[3];
 static double centre[3];
@@ -78,6 +79,8 @@ void TransformTools::Translate(bool copy)
 	// transform the objects
 	if(copy)
 	{
+		// the copies of each solid share its geometry
+		std::map<HeeksObj*, CInstanceSource*> sources;
 		for(int i = 0; i<ncopies; i++)
 		{
 			gp_Trsf mat;
@@ -87,7 +90,7 @@ void TransformTools::Translate(bool copy)
 			for(std::list<HeeksObj*>::iterator It = selected_items.begin(); It != selected_items.end(); It++)
 			{
 				HeeksObj* object = *It;
-				HeeksObj* new_object = object->MakeACopy();
+				HeeksObj* new_object = CInstance::MakeCopy(object, sources);
 				object->m_owner->Add(new_object, NULL);
 				wxGetApp().TransformUndoably(new_object, m);
 			}
@@ -171,6 +174,8 @@ void TransformTools::Rotate(bool copy)
 	wxGetApp().StartHistory();
 	if(copy)
 	{
+		// the copies of each solid share its geometry
+		std::map<HeeksObj*, CInstanceSource*> sources;
 		for(int i = 0; i<ncopies; i++)
 		{
 			gp_Trsf mat;
@@ -183,7 +188,7 @@ void TransformTools::Rotate(bool copy)
 			for(std::list<HeeksObj*>::iterator It = selected_items.begin(); It != selected_items.end(); It++)
 			{
 				HeeksObj* object = *It;
-				HeeksObj* new_object = object->MakeACopy();
+				HeeksObj* new_object = CInstance::MakeCopy(object, sources);
 				wxGetApp().TransformUndoably(new_object, m);             // Rotate the duplicate object.
 				wxGetApp().AddUndoably(new_object, object->m_owner, NULL);// And add it to this object's owner
 			}
@@ -0,0 +1,227 @@
+// VertexBuffer.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "VertexBuffer.h"
+
+#ifdef HAVE_OSMESA
+#include <GL/osmesa.h>
+#endif
+
+#ifdef __APPLE__
+#include <dlfcn.h>
+#elif !defined(WIN32)
+// from GL/glx.h, which would bring in all the X11 headers
+extern "C" void (*glXGetProcAddressARB(const GLubyte* name))(void);
+#endif
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STATIC_DRAW 0x88E4
+#endif
+
+// OpenGL 1.5 functions, looked up when first needed, because they are not exported by opengl32.lib on Windows
+typedef void (APIENTRY *BindBufferFn)(GLenum target, GLuint buffer);
+typedef void (APIENTRY *DeleteBuffersFn)(GLsizei n, const GLuint* buffers);
+typedef void (APIENTRY *GenBuffersFn)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRY *BufferDataFn)(GLenum target, ptrdiff_t size, const GLvoid* data, GLenum usage);
+
+static BindBufferFn gl_bind_buffer = NULL;
+static DeleteBuffersFn gl_delete_buffers = NULL;
+static GenBuffersFn gl_gen_buffers = NULL;
+static BufferDataFn gl_buffer_data = NULL;
+
+// buffers of CVertexBuffers which have been destroyed, to be deleted the next time something is drawn
+static std::vector<GLuint> old_buffers;
+static wxCriticalSection old_buffers_lock;
+
+static void* GetGLProcAddress(const char* name)
+{
+#ifdef HAVE_OSMESA
+	// drawing a picture without a window
+	if(OSMesaGetCurrentContext())return (void*)OSMesaGetProcAddress(name);
+#endif
+#ifdef WIN32
+	return (void*)wglGetProcAddress(name);
+#elif defined(__APPLE__)
+	return dlsym(RTLD_DEFAULT, name);
+#else
+	return (void*)glXGetProcAddressARB((const GLubyte*)name);
+#endif
+}
+
+// static
+bool CVertexBuffer::BufferObjectsAvailable()
+{
+	// must be called with a current OpenGL context
+	static bool looked_up = false;
+	static bool available = false;
+	if(!looked_up)
+	{
+		looked_up = true;
+		const char* version = (const char*)glGetString(GL_VERSION);
+		if(version == NULL)
+		{
+			// no context yet, try again later
+			looked_up = false;
+			return false;
+		}
+
+		int major = 0, minor = 0;
+		sscanf(version, "%d.%d", &major, &minor);
+		if(major > 1 || (major == 1 && minor >= 5))
+		{
+			gl_bind_buffer = (BindBufferFn)GetGLProcAddress("glBindBuffer");
+			gl_delete_buffers = (DeleteBuffersFn)GetGLProcAddress("glDeleteBuffers");
+			gl_gen_buffers = (GenBuffersFn)GetGLProcAddress("glGenBuffers");
+			gl_buffer_data = (BufferDataFn)GetGLProcAddress("glBufferData");
+			available = (gl_bind_buffer && gl_delete_buffers && gl_gen_buffers && gl_buffer_data);
+		}
+	}
+
+	return available;
+}
+
+CVertexBuffer::CVertexBuffer():m_vertex_buffer(0), m_normal_buffer(0), m_index_buffer(0), m_num_indices(0), m_has_normals(false), m_upload_failed(false)
+{
+}
+
+CVertexBuffer::~CVertexBuffer()
+{
+	Destroy();
+}
+
+void CVertexBuffer::SetData(std::vector<float>& vertices, std::vector<float>& normals, std::vector<unsigned int>& indices)
+{
+	Destroy();
+	m_vertices.swap(vertices);
+	m_normals.swap(normals);
+	m_indices.swap(indices);
+	m_num_indices = (unsigned int)m_indices.size();
+	m_has_normals = !m_normals.empty();
+	m_upload_failed = false;
+}
+
+bool CVertexBuffer::Upload()
+{
+	if(!BufferObjectsAvailable())return false;
+
+	// clear any old error, so a failed upload can be detected
+	while(glGetError() != GL_NO_ERROR){}
+
+	GLuint names[3];
+	gl_gen_buffers(m_has_normals ? 3:2, names);
+	m_vertex_buffer = names[0];
+	m_index_buffer = names[1];
+	if(m_has_normals)m_normal_buffer = names[2];
+
+	gl_bind_buffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+	gl_buffer_data(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(float), &m_vertices[0], GL_STATIC_DRAW);
+	if(m_has_normals)
+	{
+		gl_bind_buffer(GL_ARRAY_BUFFER, m_normal_buffer);
+		gl_buffer_data(GL_ARRAY_BUFFER, m_normals.size() * sizeof(float), &m_normals[0], GL_STATIC_DRAW);
+	}
+	gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+	gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer);
+	gl_buffer_data(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned int), &m_indices[0], GL_STATIC_DRAW);
+	gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	if(glGetError() != GL_NO_ERROR)
+	{
+		// probably out of memory on the graphics card; keep drawing from memory
+		GLuint names[3] = {m_vertex_buffer, m_index_buffer, m_normal_buffer};
+		gl_delete_buffers(m_has_normals ? 3:2, names);
+		m_vertex_buffer = 0;
+		m_normal_buffer = 0;
+		m_index_buffer = 0;
+		m_upload_failed = true;
+		return false;
+	}
+
+	// the graphics card has its own copy now
+	std::vector<float>().swap(m_vertices);
+	std::vector<float>().swap(m_normals);
+	std::vector<unsigned int>().swap(m_indices);
+	return true;
+}
+
+void CVertexBuffer::DeleteBuffers()
+{
+	if(m_vertex_buffer == 0)return;
+
+	// OpenGL may not be current now, for example when the document is closing, so leave them for the next draw
+	{
+		wxCriticalSectionLocker locker(old_buffers_lock);
+		old_buffers.push_back(m_vertex_buffer);
+		old_buffers.push_back(m_index_buffer);
+		if(m_normal_buffer)old_buffers.push_back(m_normal_buffer);
+	}
+	m_vertex_buffer = 0;
+	m_normal_buffer = 0;
+	m_index_buffer = 0;
+}
+
+// static
+void CVertexBuffer::DeleteOldBuffers()
+{
+	// must be called with a current OpenGL context
+	std::vector<GLuint> names;
+	{
+		wxCriticalSectionLocker locker(old_buffers_lock);
+		if(old_buffers.empty())return;
+		names.swap(old_buffers);
+	}
+	gl_delete_buffers((GLsizei)names.size(), &names[0]);
+}
+
+void CVertexBuffer::Destroy()
+{
+	DeleteBuffers();
+	std::vector<float>().swap(m_vertices);
+	std::vector<float>().swap(m_normals);
+	std::vector<unsigned int>().swap(m_indices);
+	m_num_indices = 0;
+	m_has_normals = false;
+	m_upload_failed = false;
+}
+
+void CVertexBuffer::Draw(GLenum mode, unsigned int first_index, unsigned int num_indices)
+{
+	if(num_indices == 0 || first_index + num_indices > m_num_indices)return;
+
+	DeleteOldBuffers();
+	if(m_vertex_buffer == 0 && !m_upload_failed && !m_vertices.empty())Upload();
+
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if(m_has_normals)glEnableClientState(GL_NORMAL_ARRAY);
+
+	if(m_vertex_buffer)
+	{
+		gl_bind_buffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+		glVertexPointer(3, GL_FLOAT, 0, NULL);
+		if(m_has_normals)
+		{
+			gl_bind_buffer(GL_ARRAY_BUFFER, m_normal_buffer);
+			glNormalPointer(GL_FLOAT, 0, NULL);
+		}
+		gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+		gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer);
+		glDrawElements(mode, num_indices, GL_UNSIGNED_INT, (const GLvoid*)(first_index * sizeof(unsigned int)));
+		gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	else
+	{
+		glVertexPointer(3, GL_FLOAT, 0, &m_vertices[0]);
+		if(m_has_normals)glNormalPointer(GL_FLOAT, 0, &m_normals[0]);
+		glDrawElements(mode, num_indices, GL_UNSIGNED_INT, &m_indices[first_index]);
+	}
+
+	glPopClientAttrib();
+}
@@ -0,0 +1,44 @@
+// VertexBuffer.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// Indexed triangles or lines, with optional normals, drawn with glDrawElements.
+// The geometry is uploaded into OpenGL buffer objects the first time it is drawn, and the copy in memory is then freed.
+// If buffer objects are not available ( before OpenGL 1.5 ), or the upload fails, it is drawn from client side vertex arrays instead.
+// Buffer objects are only deleted when drawing, when OpenGL is current, so a CVertexBuffer can be destroyed at any time.
+class CVertexBuffer
+{
+	std::vector<float> m_vertices; // x, y, z of each vertex
+	std::vector<float> m_normals; // x, y, z of each vertex's normal, or empty
+	std::vector<unsigned int> m_indices;
+	unsigned int m_vertex_buffer; // OpenGL buffer object names, 0 if not uploaded
+	unsigned int m_normal_buffer;
+	unsigned int m_index_buffer;
+	unsigned int m_num_indices;
+	bool m_has_normals;
+	bool m_upload_failed; // so a failed upload isn't tried again every time it is drawn
+
+	// not copyable
+	CVertexBuffer(const CVertexBuffer&);
+	CVertexBuffer& operator=(const CVertexBuffer&);
+
+	bool Upload();
+	void DeleteBuffers();
+	static void DeleteOldBuffers();
+
+public:
+	CVertexBuffer();
+	~CVertexBuffer();
+
+	// takes the contents of the given arrays, by swapping; they are left empty
+	void SetData(std::vector<float>& vertices, std::vector<float>& normals, std::vector<unsigned int>& indices);
+	bool IsEmpty()const{return m_num_indices == 0;}
+	unsigned int NumIndices()const{return m_num_indices;}
+	void Draw(GLenum mode){Draw(mode, 0, m_num_indices);}
+	void Draw(GLenum mode, unsigned int first_index, unsigned int num_indices);
+	void Destroy();
+
+	static bool BufferObjectsAvailable();
+};
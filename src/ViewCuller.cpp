@@ -0,0 +1,95 @@
+// ViewCuller.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "ViewCuller.h"
+
+// types which don't draw anything outside of their box
+static bool TypeCanBeCulled(int type)
+{
+	switch(type)
+	{
+	case PointType:
+	case LineType:
+	case ArcType:
+	case CircleType:
+	case SketchType:
+	case AreaType:
+	case SolidType:
+	case StlSolidType:
+	case WireType:
+	case TextType:
+	case EllipseType:
+	case SplineType:
+	case GroupType:
+	case ImageType:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// adds the object, and the children of groups and sketches, which can be culled; returns true if the object can be culled
+bool CViewCuller::AddObject(HeeksObj* object, std::vector<CBox> &boxes)
+{
+	int type = object->GetType();
+	if(!TypeCanBeCulled(type))return false;
+
+	if(type == GroupType || type == SketchType)
+	{
+		// a group can only be left out if all of its children are inside its box
+		bool all_children_can_be_culled = true;
+		for(HeeksObj* child = object->GetFirstChild(); child; child = object->GetNextChild())
+		{
+			if(!AddObject(child, boxes))all_children_can_be_culled = false;
+		}
+		if(!all_children_can_be_culled)return false;
+	}
+
+	CBox box;
+	object->GetBox(box);
+	if(!box.m_valid)return false;
+
+	m_item_index.insert(std::make_pair(object, (int)m_objects.size()));
+	m_objects.push_back(object);
+	boxes.push_back(box);
+	return true;
+}
+
+void CViewCuller::Rebuild(const std::list<HeeksObj*> &objects)
+{
+	m_objects.clear();
+	m_item_index.clear();
+	std::vector<CBox> boxes;
+	for(std::list<HeeksObj*>::const_iterator It = objects.begin(); It != objects.end(); It++)
+	{
+		AddObject(*It, boxes);
+	}
+	m_tree.Build(boxes);
+	m_valid = true;
+}
+
+void CViewCuller::BeginDrawing(const std::list<HeeksObj*> &objects)
+{
+	if(!m_valid)Rebuild(objects);
+
+	CFrustum frustum;
+	frustum.SetFromGL();
+	std::vector<int> visible_items;
+	m_tree.Find(frustum, visible_items);
+
+	m_item_visible.assign(m_objects.size(), 0);
+	for(std::vector<int>::iterator It = visible_items.begin(); It != visible_items.end(); It++)
+	{
+		m_item_visible[*It] = 1;
+	}
+	m_active = true;
+}
+
+bool CViewCuller::IsCulled(HeeksObj* object)const
+{
+	if(!m_active)return false;
+	std::map<HeeksObj*, int>::const_iterator FindIt = m_item_index.find(object);
+	if(FindIt == m_item_index.end())return false;
+	return m_item_visible[FindIt->second] == 0;
+}
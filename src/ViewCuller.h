@@ -0,0 +1,30 @@
+// ViewCuller.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "BoxTree.h"
+
+// finds which objects are off the screen, or outside the pick window, so drawing and picking, and groups and sketches, can skip them.
+// the boxes of the objects are kept, until Invalidate is called because something has changed
+class CViewCuller
+{
+	CBoxTree m_tree;
+	std::vector<HeeksObj*> m_objects; // the object for each item in the tree
+	std::map<HeeksObj*, int> m_item_index;
+	std::vector<char> m_item_visible;
+	bool m_valid;
+	bool m_active;
+
+	bool AddObject(HeeksObj* object, std::vector<CBox> &boxes);
+	void Rebuild(const std::list<HeeksObj*> &objects);
+
+public:
+	CViewCuller():m_valid(false), m_active(false){}
+
+	void Invalidate(){m_valid = false;}
+	void BeginDrawing(const std::list<HeeksObj*> &objects); // uses the current OpenGL matrices, which may be a pick projection
+	void EndDrawing(){m_active = false;}
+	bool IsCulled(HeeksObj* object)const; // only true between BeginDrawing and EndDrawing
+};
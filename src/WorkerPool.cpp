@@ -0,0 +1,87 @@
+// WorkerPool.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "WorkerPool.h"
+#include <wx/thread.h>
+
+class CTaskQueue
+{
+	const std::vector<CWorkerTask*> &m_tasks;
+	size_t m_next;
+	wxMutex m_mutex;
+
+public:
+	CTaskQueue(const std::vector<CWorkerTask*> &tasks):m_tasks(tasks), m_next(0){}
+
+	CWorkerTask* Next()
+	{
+		wxMutexLocker lock(m_mutex);
+		if(m_next >= m_tasks.size())return NULL;
+		return m_tasks[m_next++];
+	}
+
+	void RunTasks()
+	{
+		for(CWorkerTask* task = Next(); task; task = Next())
+		{
+			task->Run();
+		}
+	}
+};
+
+class CWorkerThread: public wxThread
+{
+	CTaskQueue &m_queue;
+
+public:
+	CWorkerThread(CTaskQueue &queue):wxThread(wxTHREAD_JOINABLE), m_queue(queue){}
+
+	ExitCode Entry()
+	{
+		m_queue.RunTasks();
+		return 0;
+	}
+};
+
+// static
+int CWorkerPool::NumThreads()
+{
+	int n = wxThread::GetCPUCount();
+	return (n < 1) ? 1 : n;
+}
+
+// static
+void CWorkerPool::Run(const std::vector<CWorkerTask*> &tasks, int num_threads)
+{
+	if(num_threads <= 0)num_threads = NumThreads();
+	if((size_t)num_threads > tasks.size())num_threads = (int)tasks.size();
+
+	CTaskQueue queue(tasks);
+
+	// Open CASCADE's memory manager has to be told that it is used from more than one thread
+	if(num_threads > 1)Standard::SetReentrant(Standard_True);
+
+	std::list<CWorkerThread*> threads;
+	for(int i = 1; i<num_threads; i++)
+	{
+		CWorkerThread* thread = new CWorkerThread(queue);
+		if(thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+		{
+			// the calling thread will do the remaining tasks
+			delete thread;
+			break;
+		}
+		threads.push_back(thread);
+	}
+
+	// the calling thread works too
+	queue.RunTasks();
+
+	for(std::list<CWorkerThread*>::iterator It = threads.begin(); It != threads.end(); It++)
+	{
+		CWorkerThread* thread = *It;
+		thread->Wait();
+		delete thread;
+	}
+}
@@ -0,0 +1,21 @@
+// WorkerPool.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// a piece of work that can be done on any thread; it mustn't use the GUI or OpenGL
+class CWorkerTask
+{
+public:
+	virtual ~CWorkerTask(){}
+	virtual void Run() = 0;
+};
+
+class CWorkerPool
+{
+public:
+	// runs all the tasks, on up to num_threads threads ( 0 for one per processor ), including the calling thread, and returns when they have all finished
+	static void Run(const std::vector<CWorkerTask*> &tasks, int num_threads = 0);
+	static int NumThreads(); // one per processor
+};
@@ -0,0 +1,222 @@
+// XmlElementReader.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "XmlElementReader.h"
+
+static const size_t buffer_size = 1 << 20;
+
+static bool StartsWith(const std::string &s, const char* prefix)
+{
+	size_t n = strlen(prefix);
+	return s.size() >= n && s.compare(0, n, prefix) == 0;
+}
+
+// true if s is too short to tell yet whether it starts with prefix
+static bool MightStartWith(const std::string &s, const char* prefix)
+{
+	size_t n = strlen(prefix);
+	return s.size() < n && strncmp(prefix, s.c_str(), s.size()) == 0;
+}
+
+CXmlElementReader::CXmlElementReader(const wxChar* filepath):m_buffer(buffer_size), m_buffer_pos(0), m_buffer_size(0), m_encoding(TIXML_DEFAULT_ENCODING), m_depth(0), m_object_depth(0), m_root_found(false), m_document_version(1)
+{
+	m_file = wxFopen(filepath, _T("rb"));
+	if(m_file == NULL)
+	{
+		m_error = _("couldn't open file");
+		return;
+	}
+
+	// skip a UTF-8 byte order mark
+	unsigned char bom[3] = {0, 0, 0};
+	if(fread(bom, 1, 3, m_file) == 3 && bom[0] == 0xef && bom[1] == 0xbb && bom[2] == 0xbf)
+		m_encoding = TIXML_ENCODING_UTF8;
+	else
+		fseek(m_file, 0, SEEK_SET);
+}
+
+CXmlElementReader::~CXmlElementReader()
+{
+	if(m_file)fclose(m_file);
+}
+
+int CXmlElementReader::GetChar()
+{
+	if(m_buffer_pos >= m_buffer_size)
+	{
+		m_buffer_size = fread(&m_buffer[0], 1, m_buffer.size(), m_file);
+		m_buffer_pos = 0;
+		if(m_buffer_size == 0)return EOF;
+	}
+	return (unsigned char)(m_buffer[m_buffer_pos++]);
+}
+
+bool CXmlElementReader::ReadMarkup()
+{
+	// m_markup starts with '<'; read up to and including the closing '>'
+	m_markup.resize(1);
+	char quote = 0;
+	int bracket_depth = 0;
+	while(1)
+	{
+		int c = GetChar();
+		if(c == EOF)return false;
+		m_markup += (char)c;
+		size_t len = m_markup.size();
+
+		if(m_markup[1] == '!')
+		{
+			if(StartsWith(m_markup, "<!--"))
+			{
+				if(len >= 7 && c == '>' && m_markup.compare(len - 3, 3, "-->") == 0)return true;
+				continue;
+			}
+			if(StartsWith(m_markup, "<![CDATA["))
+			{
+				if(len >= 12 && c == '>' && m_markup.compare(len - 3, 3, "]]>") == 0)return true;
+				continue;
+			}
+			if(MightStartWith(m_markup, "<!--") || MightStartWith(m_markup, "<![CDATA["))continue;
+			// a DOCTYPE, which may have an internal subset in square brackets
+			if(c == '[')bracket_depth++;
+			else if(c == ']')bracket_depth--;
+			else if(c == '>' && bracket_depth <= 0)return true;
+			continue;
+		}
+
+		if(m_markup[1] == '?')
+		{
+			if(len >= 4 && c == '>' && m_markup[len - 2] == '?')return true;
+			continue;
+		}
+
+		// an element's start or end tag
+		if(quote)
+		{
+			if(c == quote)quote = 0;
+		}
+		else if(c == '"' || c == '\'')quote = (char)c;
+		else if(c == '>')return true;
+	}
+}
+
+bool CXmlElementReader::ElementFinished()
+{
+	m_doc.Clear();
+	m_doc.Parse(m_text.c_str(), 0, m_encoding);
+
+	// free the text now, unless it's small enough to be worth keeping the memory for the next element
+	if(m_text.capacity() > buffer_size)std::string().swap(m_text);
+	else m_text.clear();
+
+	if(m_doc.Error())
+	{
+		m_error = Ctt(m_doc.ErrorDesc());
+		return false;
+	}
+	return m_doc.FirstChildElement() != NULL;
+}
+
+TiXmlElement* CXmlElementReader::NextElement()
+{
+	if(m_file == NULL || !m_error.IsEmpty())return NULL;
+
+	bool in_element = false;
+	while(1)
+	{
+		int c = GetChar();
+		if(c == EOF)break;
+
+		if(c != '<')
+		{
+			if(in_element)m_text += (char)c;
+			continue;
+		}
+
+		m_markup.assign(1, '<');
+		if(!ReadMarkup())
+		{
+			m_error = _("unexpected end of file");
+			return NULL;
+		}
+
+		char second = m_markup[1];
+		if(second == '?')
+		{
+			// use the encoding from the declaration, like TiXmlDocument::LoadFile does
+			if(!m_root_found && StartsWith(m_markup, "<?xml"))
+			{
+				std::string lower(m_markup);
+				for(size_t i = 0; i<lower.size(); i++)lower[i] = tolower(lower[i]);
+				if(lower.find("utf-8") != std::string::npos)m_encoding = TIXML_ENCODING_UTF8;
+				else if(m_encoding == TIXML_ENCODING_UNKNOWN)m_encoding = TIXML_ENCODING_LEGACY;
+			}
+			else if(in_element)m_text += m_markup;
+			continue;
+		}
+
+		if(second == '!')
+		{
+			if(in_element)m_text += m_markup;
+			continue;
+		}
+
+		if(second == '/')
+		{
+			// end tag
+			m_depth--;
+			if(in_element)
+			{
+				m_text += m_markup;
+				if(m_depth == m_object_depth)
+				{
+					if(ElementFinished())return m_doc.FirstChildElement();
+					return NULL;
+				}
+			}
+			continue;
+		}
+
+		// start tag
+		bool empty_element = (m_markup[m_markup.size() - 2] == '/');
+		if(!m_root_found)
+		{
+			m_root_found = true;
+			size_t name_end = m_markup.find_first_of(" \t\r\n/>", 1);
+			if(m_markup.compare(1, name_end - 1, "HeeksCAD_Document") == 0)
+			{
+				// parse the start tag on its own, to get the version
+				std::string root_text(m_markup);
+				if(!empty_element)root_text.insert(root_text.size() - 1, "/");
+				TiXmlDocument root_doc;
+				root_doc.Parse(root_text.c_str(), NULL, m_encoding);
+				if(root_doc.RootElement())root_doc.RootElement()->QueryIntAttribute("version", &m_document_version);
+
+				m_object_depth = 1;
+				if(!empty_element)m_depth++;
+				continue;
+			}
+		}
+
+		if(in_element)
+		{
+			m_text += m_markup;
+		}
+		else if(m_depth == m_object_depth)
+		{
+			in_element = true;
+			m_text = m_markup;
+			if(empty_element)
+			{
+				if(ElementFinished())return m_doc.FirstChildElement();
+				return NULL;
+			}
+		}
+		if(!empty_element)m_depth++;
+	}
+
+	if(in_element)m_error = _("unexpected end of file");
+	else if(!m_root_found)m_error = _("no elements found");
+	return NULL;
+}
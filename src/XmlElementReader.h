@@ -0,0 +1,41 @@
+// XmlElementReader.h
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+// reads a HeeksCAD document one object element at a time, so the whole document never has to be in memory as a DOM.
+// each element is handed out as its own small TinyXML tree, so the existing ReadFromXMLElement functions can be used on it.
+class CXmlElementReader
+{
+	FILE* m_file;
+	std::vector<char> m_buffer;
+	size_t m_buffer_pos;
+	size_t m_buffer_size;
+	std::string m_text; // the text of the element being read
+	std::string m_markup;
+	TiXmlDocument m_doc;
+	TiXmlEncoding m_encoding;
+	int m_depth;
+	int m_object_depth; // 1 for the children of a HeeksCAD_Document element, 0 for a file with just one object in it
+	bool m_root_found;
+	int m_document_version; // the version attribute of the HeeksCAD_Document element; 1 if it hasn't got one
+	wxString m_error;
+
+	// not copyable
+	CXmlElementReader(const CXmlElementReader&);
+	CXmlElementReader& operator=(const CXmlElementReader&);
+
+	int GetChar();
+	bool ReadMarkup(); // reads from just after a '<' to the end of the markup into m_markup
+	bool ElementFinished();
+
+public:
+	CXmlElementReader(const wxChar* filepath);
+	~CXmlElementReader();
+
+	bool IsOpen()const{return m_file != NULL;}
+	TiXmlElement* NextElement(); // returns NULL at the end of the file, or if there's an error; the element is deleted by the next call
+	const wxString& GetError()const{return m_error;} // empty if there hasn't been an error
+	int GetDocumentVersion()const{return m_document_version;} // known once the first element has been read
+};
@@ -9,6 +9,8 @@
 using namespace std;
 static const double Pi = 3.14159265358979323846264338327950288419716939937511;
 
+#define DXF_READ_BLOCK_SIZE 1048576 // bytes of the file read at a time
+
 CDxfWrite::CDxfWrite(const char* filepath)
 {
 	// start the file
@@ -176,18 +178,25 @@ CDxfRead::CDxfRead(const char* filepath)
 #ifdef STORE_LINE_NUMBERS
 	m_line_number = 0;
 #endif
-	m_ifs = new ifstream(filepath);
-	if(!(*m_ifs)){
+	m_line[0] = '\0';
+	m_str = m_line;
+	m_buffer_pos = 0;
+	m_buffer_end = 0;
+	m_all_read = false;
+	m_eof = false;
+	m_fp = fopen(filepath, "rb");
+	if(m_fp == NULL){
 		m_fail = true;
+		m_eof = true;
 		wprintf(wxT("DXF file didn't load\n"));
 		return;
 	}
-	m_ifs->imbue(std::locale("C"));
+	m_buffer.resize(DXF_READ_BLOCK_SIZE);
 }
 
 CDxfRead::~CDxfRead()
 {
-	delete m_ifs;
+	if(m_fp)fclose(m_fp);
 }
 
 double CDxfRead::mm( double value ) const
@@ -231,19 +240,17 @@ bool CDxfRead::ReadLine()
 	double e[3] = {0, 0, 0};
 	bool hidden = false;
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
 
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadLine() Failed to read integer from '%s'\n", m_str );
 			return false;
 		}
 
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found, so finish with line
@@ -265,37 +272,37 @@ bool CDxfRead::ReadLine()
 			case 10:
 				// start x
 				get_line();
-				ss.str(m_str); ss >> s[0]; s[0] = mm(s[0]); if(ss.fail()) return false;
+				if(!get_value(s[0])) return false; s[0] = mm(s[0]);
 				break;
 			case 20:
 				// start y
 				get_line();
-				ss.str(m_str); ss >> s[1]; s[1] = mm(s[1]); if(ss.fail()) return false;
+				if(!get_value(s[1])) return false; s[1] = mm(s[1]);
 				break;
 			case 30:
 				// start z
 				get_line();
-				ss.str(m_str); ss >> s[2]; s[2] = mm(s[2]); if(ss.fail()) return false;
+				if(!get_value(s[2])) return false; s[2] = mm(s[2]);
 				break;
 			case 11:
 				// end x
 				get_line();
-				ss.str(m_str); ss >> e[0]; e[0] = mm(e[0]); if(ss.fail()) return false;
+				if(!get_value(e[0])) return false; e[0] = mm(e[0]);
 				break;
 			case 21:
 				// end y
 				get_line();
-				ss.str(m_str); ss >> e[1]; e[1] = mm(e[1]); if(ss.fail()) return false;
+				if(!get_value(e[1])) return false; e[1] = mm(e[1]);
 				break;
 			case 31:
 				// end z
 				get_line();
-				ss.str(m_str); ss >> e[2]; e[2] = mm(e[2]); if(ss.fail()) return false;
+				if(!get_value(e[2])) return false; e[2] = mm(e[2]);
 				break;
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 
 			case 100:
@@ -329,19 +336,17 @@ bool CDxfRead::ReadPoint()
 {
 	double s[3] = {0, 0, 0};
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
 
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadPoint() Failed to read integer from '%s'\n", m_str );
 			return false;
 		}
 
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found, so finish with line
@@ -357,23 +362,23 @@ bool CDxfRead::ReadPoint()
 			case 10:
 				// start x
 				get_line();
-				ss.str(m_str); ss >> s[0]; s[0] = mm(s[0]); if(ss.fail()) return false;
+				if(!get_value(s[0])) return false; s[0] = mm(s[0]);
 				break;
 			case 20:
 				// start y
 				get_line();
-				ss.str(m_str); ss >> s[1]; s[1] = mm(s[1]); if(ss.fail()) return false;
+				if(!get_value(s[1])) return false; s[1] = mm(s[1]);
 				break;
 			case 30:
 				// start z
 				get_line();
-				ss.str(m_str); ss >> s[2]; s[2] = mm(s[2]); if(ss.fail()) return false;
+				if(!get_value(s[2])) return false; s[2] = mm(s[2]);
 				break;
 
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 
 			case 100:
@@ -413,18 +418,16 @@ bool CDxfRead::ReadArc()
 	double z_extrusion_dir = 1.0;
 	bool hidden = false;
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadArc() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
 
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found, so finish with arc
@@ -446,37 +449,37 @@ bool CDxfRead::ReadArc()
 			case 10:
 				// centre x
 				get_line();
-				ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+				if(!get_value(c[0])) return false; c[0] = mm(c[0]);
 				break;
 			case 20:
 				// centre y
 				get_line();
-				ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+				if(!get_value(c[1])) return false; c[1] = mm(c[1]);
 				break;
 			case 30:
 				// centre z
 				get_line();
-				ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+				if(!get_value(c[2])) return false; c[2] = mm(c[2]);
 				break;
 			case 40:
 				// radius
 				get_line();
-				ss.str(m_str); ss >> radius; radius = mm(radius); if(ss.fail()) return false;
+				if(!get_value(radius)) return false; radius = mm(radius);
 				break;
 			case 50:
 				// start angle
 				get_line();
-				ss.str(m_str); ss >> start_angle; if(ss.fail()) return false;
+				if(!get_value(start_angle)) return false;
 				break;
 			case 51:
 				// end angle
 				get_line();
-				ss.str(m_str); ss >> end_angle; if(ss.fail()) return false;
+				if(!get_value(end_angle)) return false;
 				break;
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 
 
@@ -491,7 +494,7 @@ bool CDxfRead::ReadArc()
 			case 230:
 				//Z extrusion direction for arc 
 				get_line();
-				ss.str(m_str); ss >> z_extrusion_dir; if(ss.fail()) return false;                                
+				if(!get_value(z_extrusion_dir)) return false;                                
 				break;
 
 			default:
@@ -519,17 +522,15 @@ bool CDxfRead::ReadSpline()
 
 	double temp_double;
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadSpline() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found, so finish with Spline
@@ -543,130 +544,130 @@ bool CDxfRead::ReadSpline()
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 			case 210:
 				// normal x
 				get_line();
-				ss.str(m_str); ss >> sd.norm[0]; if(ss.fail()) return false;
+				if(!get_value(sd.norm[0])) return false;
 				break;
 			case 220:
 				// normal y
 				get_line();
-				ss.str(m_str); ss >> sd.norm[1]; if(ss.fail()) return false;
+				if(!get_value(sd.norm[1])) return false;
 				break;
 			case 230:
 				// normal z
 				get_line();
-				ss.str(m_str); ss >> sd.norm[2]; if(ss.fail()) return false;
+				if(!get_value(sd.norm[2])) return false;
 				break;
 			case 70:
 				// flag
 				get_line();
-				ss.str(m_str); ss >> sd.flag; if(ss.fail()) return false;
+				if(!get_value(sd.flag)) return false;
 				break;
 			case 71:
 				// degree
 				get_line();
-				ss.str(m_str); ss >> sd.degree; if(ss.fail()) return false;
+				if(!get_value(sd.degree)) return false;
 				break;
 			case 72:
 				// knots
 				get_line();
-				ss.str(m_str); ss >> sd.knots; if(ss.fail()) return false;
+				if(!get_value(sd.knots)) return false;
 				break;
 			case 73:
 				// control points
 				get_line();
-				ss.str(m_str); ss >> sd.control_points; if(ss.fail()) return false;
+				if(!get_value(sd.control_points)) return false;
 				break;
 			case 74:
 				// fit points
 				get_line();
-				ss.str(m_str); ss >> sd.fit_points; if(ss.fail()) return false;
+				if(!get_value(sd.fit_points)) return false;
 				break;
 			case 12:
 				// starttan x
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.starttanx.push_back(temp_double);
 				break;
 			case 22:
 				// starttan y
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.starttany.push_back(temp_double);
 				break;
 			case 32:
 				// starttan z
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.starttanz.push_back(temp_double);
 				break;
 			case 13:
 				// endtan x
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.endtanx.push_back(temp_double);
 				break;
 			case 23:
 				// endtan y
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.endtany.push_back(temp_double);
 				break;
 			case 33:
 				// endtan z
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.endtanz.push_back(temp_double);
 				break;
 			case 40:
 				// knot
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.knot.push_back(temp_double);
 				break;
 			case 41:
 				// weight
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.weight.push_back(temp_double);
 				break;
 			case 10:
 				// control x
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.controlx.push_back(temp_double);
 				break;
 			case 20:
 				// control y
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.controly.push_back(temp_double);
 				break;
 			case 30:
 				// control z
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.controlz.push_back(temp_double);
 				break;
 			case 11:
 				// fit x
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.fitx.push_back(temp_double);
 				break;
 			case 21:
 				// fit y
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.fity.push_back(temp_double);
 				break;
 			case 31:
 				// fit z
 				get_line();
-				ss.str(m_str); ss >> temp_double; temp_double = mm(temp_double); if(ss.fail()) return false;
+				if(!get_value(temp_double)) return false; temp_double = mm(temp_double);
 				sd.fitz.push_back(temp_double);
 				break;
 			case 42:
@@ -693,17 +694,15 @@ bool CDxfRead::ReadCircle()
 	double c[3]; // centre
 	bool hidden = false;
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadCircle() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found, so finish with Circle
@@ -725,27 +724,27 @@ bool CDxfRead::ReadCircle()
 			case 10:
 				// centre x
 				get_line();
-				ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+				if(!get_value(c[0])) return false; c[0] = mm(c[0]);
 				break;
 			case 20:
 				// centre y
 				get_line();
-				ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+				if(!get_value(c[1])) return false; c[1] = mm(c[1]);
 				break;
 			case 30:
 				// centre z
 				get_line();
-				ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+				if(!get_value(c[2])) return false; c[2] = mm(c[2]);
 				break;
 			case 40:
 				// radius
 				get_line();
-				ss.str(m_str); ss >> radius; radius = mm(radius); if(ss.fail()) return false;
+				if(!get_value(radius)) return false; radius = mm(radius);
 				break;
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 
 			case 100:
@@ -777,17 +776,15 @@ bool CDxfRead::ReadText()
 
 	memset( c, 0, sizeof(c) );
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadText() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				return false;
@@ -799,27 +796,27 @@ bool CDxfRead::ReadText()
 			case 10:
 				// centre x
 				get_line();
-				ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+				if(!get_value(c[0])) return false; c[0] = mm(c[0]);
 				break;
 			case 20:
 				// centre y
 				get_line();
-				ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+				if(!get_value(c[1])) return false; c[1] = mm(c[1]);
 				break;
 			case 30:
 				// centre z
 				get_line();
-				ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+				if(!get_value(c[2])) return false; c[2] = mm(c[2]);
 				break;
 			case 40:
 				// text height
 				get_line();
-				ss.str(m_str); ss >> height; height = mm(height); if(ss.fail()) return false;
+				if(!get_value(height)) return false; height = mm(height);
 				break;
 			case 41:
 				// text relative x scale
 				get_line();
-				ss.str(m_str); ss >> scale_x; if(ss.fail()) return false;
+				if(!get_value(scale_x)) return false;
 				break;
 			case 1:
 				// text
@@ -831,19 +828,19 @@ bool CDxfRead::ReadText()
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 
 			case 72:
 				// horizontal justification
 				get_line();
-				ss.str(m_str); ss >> hj; if(ss.fail()) return false;
+				if(!get_value(hj)) return false;
 				break;
 
 			case 73:
 				// horizontal justification
 				get_line();
-				ss.str(m_str); ss >> vj; if(ss.fail()) return false;
+				if(!get_value(vj)) return false;
 				break;
 
 			case 100:
@@ -874,17 +871,15 @@ bool CDxfRead::ReadMText()
 
 	memset( c, 0, sizeof(c) );
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadMText() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				return false;
@@ -896,23 +891,23 @@ bool CDxfRead::ReadMText()
 			case 10:
 				// centre x
 				get_line();
-				ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+				if(!get_value(c[0])) return false; c[0] = mm(c[0]);
 				break;
 			case 20:
 				// centre y
 				get_line();
-				ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+				if(!get_value(c[1])) return false; c[1] = mm(c[1]);
 				break;
 			case 30:
 				// centre z
 				get_line();
-				ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+				if(!get_value(c[2])) return false; c[2] = mm(c[2]);
 				break;
 			case 40:
 			case 43:
 				// text height
 				get_line();
-				ss.str(m_str); ss >> height; height = mm(height); if(ss.fail()) return false;
+				if(!get_value(height)) return false; height = mm(height);
 				break;
 			case 1:
 				// text
@@ -924,7 +919,7 @@ bool CDxfRead::ReadMText()
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 
 			case 71:
@@ -933,7 +928,7 @@ bool CDxfRead::ReadMText()
 				//4 = Middle left; 5 = Middle center; 6 = Middle right
 				//7 = Bottom left; 8 = Bottom center; 9 = Bottom right
 				get_line();
-				ss.str(m_str); ss >> hj; if(ss.fail()) return false;
+				if(!get_value(hj)) return false;
 				switch(hj)
 				{
 					case 1:
@@ -978,7 +973,7 @@ bool CDxfRead::ReadMText()
 			case 72:
 				// drawing direction
 				get_line(); // to do
-				//ss.str(m_str); ss >> vj; if(ss.fail()) return false;
+				//if(!get_value(vj)) return false;
 				break;
 
 			case 100:
@@ -1007,17 +1002,15 @@ bool CDxfRead::ReadEllipse()
 	double start=0; //start of arc
 	double end=0;  // end of arc
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadEllipse() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found, so finish with Ellipse
@@ -1032,52 +1025,52 @@ bool CDxfRead::ReadEllipse()
 			case 10:
 				// centre x
 				get_line();
-				ss.str(m_str); ss >> c[0]; c[0] = mm(c[0]); if(ss.fail()) return false;
+				if(!get_value(c[0])) return false; c[0] = mm(c[0]);
 				break;
 			case 20:
 				// centre y
 				get_line();
-				ss.str(m_str); ss >> c[1]; c[1] = mm(c[1]); if(ss.fail()) return false;
+				if(!get_value(c[1])) return false; c[1] = mm(c[1]);
 				break;
 			case 30:
 				// centre z
 				get_line();
-				ss.str(m_str); ss >> c[2]; c[2] = mm(c[2]); if(ss.fail()) return false;
+				if(!get_value(c[2])) return false; c[2] = mm(c[2]);
 				break;
 			case 11:
 				// major x
 				get_line();
-				ss.str(m_str); ss >> m[0]; m[0] = mm(m[0]); if(ss.fail()) return false;
+				if(!get_value(m[0])) return false; m[0] = mm(m[0]);
 				break;
 			case 21:
 				// major y
 				get_line();
-				ss.str(m_str); ss >> m[1]; m[1] = mm(m[1]); if(ss.fail()) return false;
+				if(!get_value(m[1])) return false; m[1] = mm(m[1]);
 				break;
 			case 31:
 				// major z
 				get_line();
-				ss.str(m_str); ss >> m[2]; m[2] = mm(m[2]); if(ss.fail()) return false;
+				if(!get_value(m[2])) return false; m[2] = mm(m[2]);
 				break;
 			case 40:
 				// ratio
 				get_line();
-				ss.str(m_str); ss >> ratio; if(ss.fail()) return false;
+				if(!get_value(ratio)) return false;
 				break;
 			case 41:
 				// start
 				get_line();
-				ss.str(m_str); ss >> start; if(ss.fail()) return false;
+				if(!get_value(start)) return false;
 				break;
 			case 42:
 				// end
 				get_line();
-				ss.str(m_str); ss >> end; if(ss.fail()) return false;
+				if(!get_value(end)) return false;
 				break;
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 			case 100:
 			case 210:
@@ -1215,17 +1208,15 @@ bool CDxfRead::ReadLwPolyLine()
 	bool next_item_found = false;
 	bool mirrored = false;
 
-	while(!((*m_ifs).eof()) && !next_item_found)
+	while(!m_eof && !next_item_found)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadLwPolyLine() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found
@@ -1255,37 +1246,37 @@ bool CDxfRead::ReadLwPolyLine()
 					x_found = false;
 					y_found = false;
 				}
-				ss.str(m_str); ss >> x; x = mm(x); if(ss.fail()) return false;
+				if(!get_value(x)) return false; x = mm(x);
 				x_found = true;
 				break;
 			case 20:
 				// y
 				get_line();
-				ss.str(m_str); ss >> y; y = mm(y); if(ss.fail()) return false;
+				if(!get_value(y)) return false; y = mm(y);
 				y_found = true;
 				break;
 			case 230:
 				// z extrusion direction
 				get_line();
-				ss.str(m_str); ss >> z; if(ss.fail()) return false;
+				if(!get_value(z)) return false;
 				mirrored = (z < 0);
 				break;
 			case 42:
 				// bulge
 				get_line();
-				ss.str(m_str); ss >> bulge; if(ss.fail()) return false;
+				if(!get_value(bulge)) return false;
 				bulge_found = true;
 				break;
 			case 70:
 				// flags
 				get_line();
-				if(sscanf(m_str, "%d", &flags) != 1)return false;
+				if(!get_value(flags))return false;
 				closed = ((flags & 1) != 0);
 				break;
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 			default:
 				// skip the next line
@@ -1319,15 +1310,13 @@ bool CDxfRead::ReadVertex(double *pVertex, bool *bulge_found, double *bulge)
 	pVertex[1] = 0.0;
 	pVertex[2] = 0.0;
 
-	while(!(*m_ifs).eof()) {
+	while(!m_eof) {
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1) {
+		if(!get_value(n)) {
 			printf("CDxfRead::ReadVertex() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				DerefACI();
@@ -1343,30 +1332,30 @@ bool CDxfRead::ReadVertex(double *pVertex, bool *bulge_found, double *bulge)
 			case 10:
 				// x
 				get_line();
-				ss.str(m_str); ss >> x; pVertex[0] = mm(x); if(ss.fail()) return false;
+				if(!get_value(x)) return false; pVertex[0] = mm(x);
 				x_found = true;
 				break;
 			case 20:
 				// y
 				get_line();
-				ss.str(m_str); ss >> y; pVertex[1] = mm(y); if(ss.fail()) return false;
+				if(!get_value(y)) return false; pVertex[1] = mm(y);
 				y_found = true;
 				break;
 			case 30:
 				// z
 				get_line();
-				ss.str(m_str); ss >> z; pVertex[2] = mm(z); if(ss.fail()) return false;
+				if(!get_value(z)) return false; pVertex[2] = mm(z);
 				break;
 
 			case 42:
 				get_line();
 				*bulge_found = true;
-				ss.str(m_str); ss >> *bulge; if(ss.fail()) return false;
+				if(!get_value(*bulge)) return false;
 				break;
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 
 			default:
@@ -1392,17 +1381,15 @@ bool CDxfRead::ReadPolyLine()
 	bool bulge_found;
 	double bulge;
 
-	while(!(*m_ifs).eof())
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadPolyLine() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found
@@ -1430,13 +1417,13 @@ bool CDxfRead::ReadPolyLine()
 			case 70:
 				// flags
 				get_line();
-				if(sscanf(m_str, "%d", &flags) != 1)return false;
+				if(!get_value(flags))return false;
 				closed = ((flags & 1) != 0);
 				break;
 			case 62:
 				// color index
 				get_line();
-				ss.str(m_str); ss >> m_aci; if(ss.fail()) return false;
+				if(!get_value(m_aci)) return false;
 				break;
 			default:
 				// skip the next line
@@ -1467,17 +1454,15 @@ bool CDxfRead::ReadLeader()
 	bool next_item_found = false;
 	std::list<three_doubles> vertices;
 
-	while(!((*m_ifs).eof()) && !next_item_found)
+	while(!m_eof && !next_item_found)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadLeader() Failed to read integer from '%s'\n", m_str);
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found, so finish with Leader
@@ -1491,17 +1476,17 @@ bool CDxfRead::ReadLeader()
 			case 10:
 				// x
 				get_line();
-				ss.str(m_str); ss >> vertex_coordinates[0]; vertex_coordinates[0] = mm(vertex_coordinates[0]); if(ss.fail()) return false;
+				if(!get_value(vertex_coordinates[0])) return false; vertex_coordinates[0] = mm(vertex_coordinates[0]);
 				break;
 			case 20:
 				// y
 				get_line();
-				ss.str(m_str); ss >> vertex_coordinates[1]; vertex_coordinates[1] = mm(vertex_coordinates[1]); if(ss.fail()) return false;
+				if(!get_value(vertex_coordinates[1])) return false; vertex_coordinates[1] = mm(vertex_coordinates[1]);
 				break;
 			case 30:
 				// z
 				get_line();
-				ss.str(m_str); ss >> vertex_coordinates[2]; vertex_coordinates[2] = mm(vertex_coordinates[2]); if(ss.fail()) return false;
+				if(!get_value(vertex_coordinates[2])) return false; vertex_coordinates[2] = mm(vertex_coordinates[2]);
 				three_doubles td;
 				for(int i = 0; i<3; i++)td.x[i] = vertex_coordinates[i];
 				vertices.push_back(td);
@@ -1509,27 +1494,27 @@ bool CDxfRead::ReadLeader()
 			case 211:
 				// x
 				get_line();
-				ss.str(m_str); ss >> horizontal_direction[0]; if(ss.fail()) return false;
+				if(!get_value(horizontal_direction[0])) return false;
 				break;
 			case 221:
 				// y
 				get_line();
-				ss.str(m_str); ss >> horizontal_direction[1]; if(ss.fail()) return false;
+				if(!get_value(horizontal_direction[1])) return false;
 				break;
 			case 231:
 				// z
 				get_line();
-				ss.str(m_str); ss >> horizontal_direction[2]; if(ss.fail()) return false;
+				if(!get_value(horizontal_direction[2])) return false;
 				break;
 			case 40:
 				// ratio
 				get_line();
-				ss.str(m_str); ss >> text_annotation_height; if(ss.fail()) return false;
+				if(!get_value(text_annotation_height)) return false;
 				break;
 			case 41:
 				// start
 				get_line();
-				ss.str(m_str); ss >> text_annotation_width; if(ss.fail()) return false;
+				if(!get_value(text_annotation_width)) return false;
 				break;
 			case 100:
 			case 210:
@@ -1571,11 +1556,11 @@ bool CDxfRead::ReadLeader()
 
 bool CDxfRead::ReadMLine()
 {
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadMLine() Failed to read integer from '%s'\n", m_str );
 			return false;
@@ -1595,11 +1580,11 @@ bool CDxfRead::ReadMLine()
 
 bool CDxfRead::ReadXLine()
 {
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadXLine() Failed to read integer from '%s'\n", m_str );
 			return false;
@@ -1633,17 +1618,15 @@ bool CDxfRead::ReadDimension()
 	double radius_leader_length = 0;
 	std::string str;
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadDimension() Failed to read integer from '%s'\n", m_str );
 			return false;
 		}
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:
 				// next item found, so finish
@@ -1653,137 +1636,137 @@ bool CDxfRead::ReadDimension()
 			case 3:
 				// style name
 				get_line();
-				//ss.str(m_str); ss >> str; if(ss.fail()) return false;
+				//if(!get_value(str)) return false;
 				break;
 			case 70:
 				// dimension type
 				get_line();
-				ss.str(m_str); ss >> dimension_type; if(ss.fail()) return false;
+				if(!get_value(dimension_type)) return false;
 				break;
 			case 50:
 				// angle
 				get_line();
-				ss.str(m_str); ss >> angle; if(ss.fail()) return false;
+				if(!get_value(angle)) return false;
 				break;
 			case 51:
 				// angle2
 				get_line();
-				ss.str(m_str); ss >> angle2; if(ss.fail()) return false;
+				if(!get_value(angle2)) return false;
 				break;
 			case 52:
 				// angle3
 				get_line();
-				ss.str(m_str); ss >> angle3; if(ss.fail()) return false;
+				if(!get_value(angle3)) return false;
 				break;
 			case 40:
 				// radius leader length
 				get_line();
-				ss.str(m_str); ss >> radius_leader_length; if(ss.fail()) return false;
+				if(!get_value(radius_leader_length)) return false;
 				break;
 			case 10:
 				// x
 				get_line();
-				ss.str(m_str); ss >> def_point[0]; def_point[0] = mm(def_point[0]); if(ss.fail()) return false;
+				if(!get_value(def_point[0])) return false; def_point[0] = mm(def_point[0]);
 				break;
 			case 20:
 				// y
 				get_line();
-				ss.str(m_str); ss >> def_point[1]; def_point[1] = mm(def_point[1]); if(ss.fail()) return false;
+				if(!get_value(def_point[1])) return false; def_point[1] = mm(def_point[1]);
 				break;
 			case 30:
 				// z
 				get_line();
-				ss.str(m_str); ss >> def_point[2]; def_point[2] = mm(def_point[2]); if(ss.fail()) return false;
+				if(!get_value(def_point[2])) return false; def_point[2] = mm(def_point[2]);
 				break;
 			case 11:
 				// x
 				get_line();
-				ss.str(m_str); ss >> mid[0]; mid[0] = mm(mid[0]); if(ss.fail()) return false;
+				if(!get_value(mid[0])) return false; mid[0] = mm(mid[0]);
 				break;
 			case 21:
 				// y
 				get_line();
-				ss.str(m_str); ss >> mid[1]; mid[1] = mm(mid[1]); if(ss.fail()) return false;
+				if(!get_value(mid[1])) return false; mid[1] = mm(mid[1]);
 				break;
 			case 31:
 				// z
 				get_line();
-				ss.str(m_str); ss >> mid[2]; mid[2] = mm(mid[2]); if(ss.fail()) return false;
+				if(!get_value(mid[2])) return false; mid[2] = mm(mid[2]);
 				break;
 			case 12:
 				// x
 				get_line();
-				ss.str(m_str); ss >> p1[0]; p1[0] = mm(p1[0]); if(ss.fail()) return false;
+				if(!get_value(p1[0])) return false; p1[0] = mm(p1[0]);
 				break;
 			case 22:
 				// y
 				get_line();
-				ss.str(m_str); ss >> p1[1]; p1[1] = mm(p1[1]); if(ss.fail()) return false;
+				if(!get_value(p1[1])) return false; p1[1] = mm(p1[1]);
 				break;
 			case 32:
 				// z
 				get_line();
-				ss.str(m_str); ss >> p1[2]; p1[2] = mm(p1[2]); if(ss.fail()) return false;
+				if(!get_value(p1[2])) return false; p1[2] = mm(p1[2]);
 				break;
 			case 13:
 				// x
 				get_line();
-				ss.str(m_str); ss >> p2[0]; p2[0] = mm(p2[0]); if(ss.fail()) return false;
+				if(!get_value(p2[0])) return false; p2[0] = mm(p2[0]);
 				break;
 			case 23:
 				// y
 				get_line();
-				ss.str(m_str); ss >> p2[1]; p2[1] = mm(p2[1]); if(ss.fail()) return false;
+				if(!get_value(p2[1])) return false; p2[1] = mm(p2[1]);
 				break;
 			case 33:
 				// z
 				get_line();
-				ss.str(m_str); ss >> p2[2]; p2[2] = mm(p2[2]); if(ss.fail()) return false;
+				if(!get_value(p2[2])) return false; p2[2] = mm(p2[2]);
 				break;
 			case 14:
 				// x
 				get_line();
-				ss.str(m_str); ss >> p3[0]; p3[0] = mm(p3[0]); if(ss.fail()) return false;
+				if(!get_value(p3[0])) return false; p3[0] = mm(p3[0]);
 				break;
 			case 24:
 				// y
 				get_line();
-				ss.str(m_str); ss >> p3[1]; p3[1] = mm(p3[1]); if(ss.fail()) return false;
+				if(!get_value(p3[1])) return false; p3[1] = mm(p3[1]);
 				break;
 			case 34:
 				// z
 				get_line();
-				ss.str(m_str); ss >> p3[2]; p3[2] = mm(p3[2]); if(ss.fail()) return false;
+				if(!get_value(p3[2])) return false; p3[2] = mm(p3[2]);
 				break;
 			case 15:
 				// x
 				get_line();
-				ss.str(m_str); ss >> p4[0]; p4[0] = mm(p4[0]); if(ss.fail()) return false;
+				if(!get_value(p4[0])) return false; p4[0] = mm(p4[0]);
 				break;
 			case 25:
 				// y
 				get_line();
-				ss.str(m_str); ss >> p4[1]; p4[1] = mm(p4[1]); if(ss.fail()) return false;
+				if(!get_value(p4[1])) return false; p4[1] = mm(p4[1]);
 				break;
 			case 35:
 				// z
 				get_line();
-				ss.str(m_str); ss >> p4[2]; p4[2] = mm(p4[2]); if(ss.fail()) return false;
+				if(!get_value(p4[2])) return false; p4[2] = mm(p4[2]);
 				break;
 			case 16:
 				// x
 				get_line();
-				ss.str(m_str); ss >> p5[0]; p5[0] = mm(p5[0]); if(ss.fail()) return false;
+				if(!get_value(p5[0])) return false; p5[0] = mm(p5[0]);
 				break;
 			case 26:
 				// y
 				get_line();
-				ss.str(m_str); ss >> p5[1]; p5[1] = mm(p5[1]); if(ss.fail()) return false;
+				if(!get_value(p5[1])) return false; p5[1] = mm(p5[1]);
 				break;
 			case 36:
 				// z
 				get_line();
-				ss.str(m_str); ss >> p5[2]; p5[2] = mm(p5[2]); if(ss.fail()) return false;
+				if(!get_value(p5[2])) return false; p5[2] = mm(p5[2]);
 				break;
 
 			case 53:
@@ -1862,30 +1845,55 @@ void CDxfRead::get_line()
 {
 	if (m_unused_line[0] != '\0')
 	{
-		strcpy(m_str, m_unused_line);
+		strcpy(m_line, m_unused_line);
 		memset( m_unused_line, '\0', sizeof(m_unused_line));
+		m_str = m_line;
 		return;
 	}
-	m_ifs->getline(m_str, 1024);
-
-	// Clean whitespaces
-	char str[1024];
-	int len = strlen(m_str);
-	int j = 0;
-	bool non_white_found = false;
-	for(int i = 0; i<len; i++){
-		if(non_white_found || (m_str[i] != ' ' && m_str[i] != '\t')){
-#if wxUSE_UNICODE
-			if(m_str[i] != '\r')
-#endif
-			{
-				str[j] = m_str[i]; j++;
-			}
-			non_white_found = true;
+
+	// find the end of the line, reading the next block of the file if it isn't all in the buffer
+	char* end = NULL;
+	while(1)
+	{
+		end = (char*)memchr(&m_buffer[0] + m_buffer_pos, '\n', m_buffer_end - m_buffer_pos);
+		if(end != NULL || m_all_read)break;
+
+		size_t part_line = m_buffer_end - m_buffer_pos;
+		if(part_line > 0 && m_buffer_pos > 0)memmove(&m_buffer[0], &m_buffer[m_buffer_pos], part_line);
+		m_buffer_pos = 0;
+		m_buffer_end = part_line;
+		size_t space = m_buffer.size() - 1 - m_buffer_end; // leave room to terminate a last line which has no newline
+		if(space == 0)
+		{
+			// the buffer is full and has no newline, so the line is longer than the buffer.
+			// only the first 1023 chars of a line are used, so keep those, and read over the rest until the newline
+			m_buffer_end = 1023;
+			space = m_buffer.size() - 1 - m_buffer_end;
 		}
+		size_t num_read = fread(&m_buffer[m_buffer_end], 1, space, m_fp);
+		m_buffer_end += num_read;
+		if(num_read < space)m_all_read = true;
 	}
-	str[j] = 0;
-	strcpy(m_str, str);
+
+	char* start = &m_buffer[0] + m_buffer_pos;
+	if(end != NULL)
+	{
+		m_buffer_pos = end - &m_buffer[0] + 1;
+	}
+	else
+	{
+		// like getline, reaching the end of the file sets eof, even if there was a last line without a newline
+		end = &m_buffer[0] + m_buffer_end;
+		m_buffer_pos = m_buffer_end;
+		m_eof = true;
+	}
+
+	// cut the line in place; remove the leading whitespace and the carriage return
+	while(start < end && (*start == ' ' || *start == '\t'))start++;
+	while(end > start && end[-1] == '\r')end--;
+	if(end - start > 1023)end = start + 1023; // the line is copied into 1024 char arrays
+	*end = '\0';
+	m_str = start;
 	// wprintf(wxT("DXF: get_line() -> %s\n"), m_str);
 
 #ifdef STORE_LINE_NUMBERS
@@ -1893,6 +1901,99 @@ void CDxfRead::get_line()
 #endif
 }
 
+bool CDxfRead::get_value(int &value)const
+{
+	// like sscanf "%d"
+	const char* p = m_str;
+	while(*p == ' ' || *p == '\t')p++;
+	bool negative = (*p == '-');
+	if(*p == '-' || *p == '+')p++;
+	if(*p < '0' || *p > '9')return false;
+	long long v = 0;
+	for(; *p >= '0' && *p <= '9'; p++)
+	{
+		v = v * 10 + (*p - '0');
+		if(v > 2147483648LL)return false;
+	}
+	if(negative)v = -v;
+	if(v > 2147483647LL)return false;
+	value = (int)v;
+	return true;
+}
+
+bool CDxfRead::get_value(double &value)const
+{
+	// most numbers in a DXF file have few enough digits to be converted exactly with one multiplication or division by a power of ten
+	// anything else is done by a stream in the "C" locale, as before
+	static const double powers_of_ten[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+	const char* p = m_str;
+	while(*p == ' ' || *p == '\t')p++;
+	bool negative = (*p == '-');
+	if(*p == '-' || *p == '+')p++;
+
+	unsigned long long mantissa = 0;
+	int num_digits = 0; // not counting leading zeros
+	int exponent = 0;
+	bool digit_found = false;
+	bool fast = true;
+	for(; *p >= '0' && *p <= '9'; p++)
+	{
+		digit_found = true;
+		if(mantissa == 0 && *p == '0')continue;
+		if(++num_digits > 18){fast = false; break;}
+		mantissa = mantissa * 10 + (*p - '0');
+	}
+	if(fast && *p == '.')
+	{
+		for(p++; *p >= '0' && *p <= '9'; p++)
+		{
+			digit_found = true;
+			if(mantissa == 0 && *p == '0'){exponent--; continue;}
+			if(++num_digits > 18){fast = false; break;}
+			mantissa = mantissa * 10 + (*p - '0');
+			exponent--;
+		}
+	}
+	if(fast && (*p == 'e' || *p == 'E'))
+	{
+		p++;
+		bool negative_exponent = (*p == '-');
+		if(*p == '-' || *p == '+')p++;
+		if(*p < '0' || *p > '9')fast = false;
+		int e = 0;
+		for(; fast && *p >= '0' && *p <= '9'; p++)
+		{
+			e = e * 10 + (*p - '0');
+			if(e > 1000)fast = false;
+		}
+		exponent += negative_exponent ? -e : e;
+	}
+
+	if(fast && digit_found && mantissa <= (1ULL << 53))
+	{
+		if(mantissa == 0)
+		{
+			value = negative ? -0.0 : 0.0;
+			return true;
+		}
+		if(exponent >= -22 && exponent <= 22)
+		{
+			double v = (double)mantissa;
+			if(exponent < 0)v /= powers_of_ten[-exponent];
+			else v *= powers_of_ten[exponent];
+			value = negative ? -v : v;
+			return true;
+		}
+	}
+
+	std::istringstream ss;
+	ss.imbue(std::locale("C"));
+	ss.str(m_str);
+	ss >> value;
+	return !ss.fail();
+}
+
 void CDxfRead::put_line(const char *value)
 {
 	strcpy( m_unused_line, value );
@@ -1902,19 +2003,17 @@ bool CDxfRead::ReadUCS()
 {
 	double e[3] = {0, 0, 0};
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
 
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadUCS() Failed to read integer from '%s'\n", m_str );
 			return false;
 		}
 
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 9:	// next item found, so finish
 				OnReadUCS(e);
@@ -1923,17 +2022,17 @@ bool CDxfRead::ReadUCS()
 			case 10:
 				// x
 				get_line();
-				ss.str(m_str); ss >> e[0]; e[0] = mm(e[0]); if(ss.fail()) return false;
+				if(!get_value(e[0])) return false; e[0] = mm(e[0]);
 				break;
 			case 20:
 				// y
 				get_line();
-				ss.str(m_str); ss >> e[1]; e[1] = mm(e[1]); if(ss.fail()) return false;
+				if(!get_value(e[1])) return false; e[1] = mm(e[1]);
 				break;
 			case 30:
 				// z
 				get_line();
-				ss.str(m_str); ss >> e[2]; e[2] = mm(e[2]); if(ss.fail()) return false;
+				if(!get_value(e[2])) return false; e[2] = mm(e[2]);
 				break;
 			default:
 				// skip the next line
@@ -1947,24 +2046,22 @@ bool CDxfRead::ReadUCS()
 
 bool CDxfRead::ReadUnits()
 {
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
 
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadUnits() Failed to read integer from '%s'\n", m_str );
 			return false;
 		}
 
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 70:
 				// x
 				get_line();
-				if(sscanf(m_str, "%d", &n) == 1)
+				if(get_value(n))
 				{
 					m_eUnits = eDxfUnits_t( n );
 				}
@@ -1984,19 +2081,17 @@ bool CDxfRead::ReadLayer()
 	std::string layername;
 	int aci = -1;
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
 
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadLayer() Failed to read integer from '%s'\n", m_str );
 			return false;
 		}
 
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:	// next item found, so finish with line
 				if (layername.empty())
@@ -2015,7 +2110,7 @@ bool CDxfRead::ReadLayer()
 			case 62:
 				// layer color ; if negative, layer is off
 				get_line();
-				if(sscanf(m_str, "%d", &aci) != 1)return false;
+				if(!get_value(aci))return false;
 				break;
 
 			case 6:	// linetype name
@@ -2041,11 +2136,11 @@ bool CDxfRead::ReadSection()
 	// wprintf(wxT("CDxfRead::ReadSection()\n"));
 
 	get_line();
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		int n;
 
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			wprintf(wxT("CDxfRead::ReadSection() Failed to read integer from '%s'\n"),m_str );
 			return false;
@@ -2075,7 +2170,7 @@ bool CDxfRead::ReadSection()
 					// wprintf(wxT("DXF: previous line skipped\n"));
 					get_line();
 					int n = 1;
-					if(sscanf(m_str, "%d", &n) == 1)
+					if(get_value(n))
 					{
 						if(n == 0)m_measurement_inch = true;
 					}
@@ -2112,19 +2207,17 @@ bool CDxfRead::ReadBlock()
 	wxString block_name;
 	double e[3] = {0, 0, 0};
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
 
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadBlock() Failed to read integer from '%s'\n", m_str );
 			return false;
 		}
 
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:	// next item found, so finish with line
 				if (block_name.empty())
@@ -2144,17 +2237,17 @@ bool CDxfRead::ReadBlock()
 			case 10:
 				// base point x
 				get_line();
-				ss.str(m_str); ss >> e[0]; e[0] = mm(e[0]); if(ss.fail()) return false;
+				if(!get_value(e[0])) return false; e[0] = mm(e[0]);
 				break;
 			case 20:
 				// base point y
 				get_line();
-				ss.str(m_str); ss >> e[1]; e[1] = mm(e[1]); if(ss.fail()) return false;
+				if(!get_value(e[1])) return false; e[1] = mm(e[1]);
 				break;
 			case 30:
 				// base point z
 				get_line();
-				ss.str(m_str); ss >> e[2]; e[2] = mm(e[2]); if(ss.fail()) return false;
+				if(!get_value(e[2])) return false; e[2] = mm(e[2]);
 				break;
 
 			case 5:	// handle
@@ -2183,19 +2276,17 @@ bool CDxfRead::ReadInsert()
 
 	// to do, scale, rotation etc.
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
 
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadInsert() Failed to read integer from '%s'\n", m_str );
 			return false;
 		}
 
-		std::istringstream ss;
-		ss.imbue(std::locale("C"));
 		switch(n){
 			case 0:	// next item found, so finish with line
 				if (block_name.empty())
@@ -2214,23 +2305,23 @@ bool CDxfRead::ReadInsert()
 			case 10:
 				// insert point x
 				get_line();
-				ss.str(m_str); ss >> e[0]; e[0] = mm(e[0]); if(ss.fail()) return false;
+				if(!get_value(e[0])) return false; e[0] = mm(e[0]);
 				break;
 			case 20:
 				// insert point y
 				get_line();
-				ss.str(m_str); ss >> e[1]; e[1] = mm(e[1]); if(ss.fail()) return false;
+				if(!get_value(e[1])) return false; e[1] = mm(e[1]);
 				break;
 			case 30:
 				// insert point z
 				get_line();
-				ss.str(m_str); ss >> e[2]; e[2] = mm(e[2]); if(ss.fail()) return false;
+				if(!get_value(e[2])) return false; e[2] = mm(e[2]);
 				break;
 
 			case 50:
 				// rotation angle
 				get_line();
-				ss.str(m_str); ss >> rotation_angle; if(ss.fail()) return false;
+				if(!get_value(rotation_angle)) return false;
 				break;
 
 			case 100: // subclass marker
@@ -2251,12 +2342,12 @@ bool CDxfRead::ReadEndBlock()
 {
 	// wxString block_name;
 
-	while(!((*m_ifs).eof()))
+	while(!m_eof)
 	{
 		get_line();
 		int n;
 
-		if(sscanf(m_str, "%d", &n) != 1)
+		if(!get_value(n))
 		{
 			printf("CDxfRead::ReadEndBlock() Failed to read integer from '%s'\n", m_str );
 			return false;
@@ -2301,7 +2392,8 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 
 	get_line();
 
-	while(!((*m_ifs).eof()))
+	// a read failure stops the loop, but what was read before it is still added
+	while(!m_eof)
 	{
 		if(!strcmp(m_str, "0"))
 		{
@@ -2310,7 +2402,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadSection())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read section\n"));
-					return;
+					break;
 				}
 				continue;
 			} // End if - then
@@ -2318,7 +2410,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadBlock())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read block\n"));
-					return;
+					break;
 				}
 				continue;
 
@@ -2327,7 +2419,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadEndBlock())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read end block\n"));
-					return;
+					break;
 				}
 				continue;
 
@@ -2336,7 +2428,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadInsert())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read insert\n"));
-					return;
+					break;
 				}
 				continue;
 
@@ -2350,7 +2442,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadLayer())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read layer\n"));
-					return;
+					break;
 				}
 				continue;		}
 
@@ -2361,7 +2453,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadLine())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read line\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2369,7 +2461,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadArc())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read arc\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2377,7 +2469,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadCircle())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read circle\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2385,7 +2477,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadText())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read text\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2393,7 +2485,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadMText())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read mtext\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2401,7 +2493,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadEllipse())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read ellipse\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2409,7 +2501,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadSpline())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read spline\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2417,7 +2509,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadLwPolyLine())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read LW Polyline\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2425,7 +2517,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadPolyLine())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read Polyline\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2433,7 +2525,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadPoint())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read Point\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2441,7 +2533,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadLeader())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read Leader\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2449,7 +2541,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadMLine())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read MLine\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2457,7 +2549,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadXLine())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read XLine\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2465,7 +2557,7 @@ void CDxfRead::DoRead(const bool ignore_errors /* = false */ )
 				if(!ReadDimension())
 				{
 					wprintf(wxT("CDxfRead::DoRead() Failed to read Dimension\n"));
-					return;
+					break;
 				}
 				continue;
 			}
@@ -2488,6 +2580,9 @@ void  CDxfRead::DerefACI()
 
 wxString CDxfRead::ParseUnicode(const wxString& str) const
 {
+	// every escape starts with a backslash; this is used for every entity, so don't compile the expression if there isn't one
+	if(str.Find(wxT('\\')) == wxNOT_FOUND)return str;
+
 	wxString ret = str;
 	wxRegEx reg;
 
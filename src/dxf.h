@@ -108,10 +108,16 @@ public:
 // derive a class from this and implement it's virtual functions
 class CDxfRead{
 private:
-	std::ifstream* m_ifs;
+	FILE* m_fp;
+	std::vector<char> m_buffer; // a block of the file; the lines are cut in it, in place
+	size_t m_buffer_pos; // the start of the next line
+	size_t m_buffer_end; // the end of what has been read into it
+	bool m_all_read; // the whole file has been read into the buffer
+	bool m_eof;
 
 	bool m_fail;
-	char m_str[1024];
+	char* m_str; // the current line, which is in m_buffer or m_line. it is only valid until the next get_line
+	char m_line[1024];
 	char m_unused_line[1024];
 	eDxfUnits_t m_eUnits;
 	bool m_measurement_inch;
@@ -153,6 +159,8 @@ private:
 
 	void get_line();
 	void put_line(const char *value);
+	bool get_value(int &value)const; // these convert the current line
+	bool get_value(double &value)const;
 	void DerefACI();
 	void StorePolyLinePoint(double x, double y, double z, bool bulge_found, double bulge);
 	void AddPolyLinePoints(bool mirrored, bool closed);
@@ -0,0 +1,222 @@
+// HeeksBinaryFiletest.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+// times HeeksCAD reading and writing .heeks and .heeksb files, and checks a .heeksb file holds everything the .heeks file did.
+// it runs HeeksCAD's --convert mode, so HeeksCAD must be built first:
+//   HeeksBinaryFiletest path/to/heekscad [a.heeks b.heeks ...]
+// with no .heeks files, it makes one with sketches, a small and a large STL solid, and some solids.
+// each file goes XML -> XML, and XML -> binary -> XML; the two XML files written must be the same.
+
+#include <BRep_Builder.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepTools.hxx>
+#include <TopoDS_Compound.hxx>
+#include <gp_Pnt.hxx>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <locale.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+static std::string program;
+
+static void MakeDocument(const std::string &filepath)
+{
+	std::ofstream ofs(filepath.c_str());
+	ofs << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n";
+	ofs << "<HeeksCAD_Document version=\"2\">\n";
+
+	int id = 1;
+
+	// sketches of lines
+	for(int i = 0; i < 200; i++)
+	{
+		ofs << "<Sketch title=\"Sketch\" id=\"" << id++ << "\">\n";
+		for(int j = 0; j < 50; j++)
+		{
+			ofs << "<Line col=\"0\" sx=\"" << i * 10 + j * 0.1 << "\" sy=\"" << j * 0.2 << "\" sz=\"0\" ex=\"" << i * 10 + (j + 1) * 0.1 << "\" ey=\"" << (j + 1) * 0.2 << "\" ez=\"0\" id=\"" << id++ << "\" />\n";
+		}
+		ofs << "</Sketch>\n";
+	}
+
+	// a small STL solid, in the layout every version can read
+	ofs << "<STLSolid col=\"12566463\" id=\"" << id++ << "\">\n";
+	ofs << "<tri p1x=\"0\" p1y=\"0\" p1z=\"0\" p2x=\"1\" p2y=\"0\" p2z=\"0\" p3x=\"0\" p3y=\"1\" p3z=\"0\" />\n";
+	ofs << "<tri p1x=\"1\" p1y=\"0\" p1z=\"0\" p2x=\"1\" p2y=\"1\" p2z=\"0\" p3x=\"0\" p3y=\"1\" p3z=\"0\" />\n";
+	ofs << "</STLSolid>\n";
+
+	// a large STL solid, a bumpy grid of 180,000 triangles, with shared vertices
+	const int n = 300;
+	ofs << "<STLSolid col=\"12566463\" version=\"2\" vertices=\"" << (n + 1) * (n + 1) << "\" triangles=\"" << n * n * 2 << "\" id=\"" << id++ << "\">";
+	for(int y = 0; y <= n; y++)
+	{
+		for(int x = 0; x <= n; x++)
+		{
+			ofs << x * 0.5 << " " << y * 0.5 << " " << ((x * 7 + y * 13) % 17) * 0.05 << " ";
+		}
+	}
+	for(int y = 0; y < n; y++)
+	{
+		for(int x = 0; x < n; x++)
+		{
+			int v = y * (n + 1) + x;
+			ofs << v << " " << v + 1 << " " << v + n + 2 << " ";
+			ofs << v << " " << v + n + 2 << " " << v + n + 1 << " ";
+		}
+	}
+	ofs << "</STLSolid>\n";
+
+	// solids, as a BREP, like SaveXMLFile writes them
+	char oldlocale[1000];
+	strcpy(oldlocale, setlocale(LC_NUMERIC, "C"));
+	TopoDS_Compound compound;
+	BRep_Builder builder;
+	builder.MakeCompound(compound);
+	const int num_solids = 200;
+	for(int i = 0; i < num_solids; i++)
+	{
+		builder.Add(compound, BRepPrimAPI_MakeBox(gp_Pnt((i % 20) * 10.0, (i / 20) * 10.0, -20.0), 5.0, 5.0, 5.0).Shape());
+	}
+	std::ostringstream brep;
+	BRepTools::Write(compound, brep);
+	setlocale(LC_NUMERIC, oldlocale);
+
+	ofs << "<BREP_file>\n<index_map>\n";
+	for(int i = 0; i < num_solids; i++)
+	{
+		ofs << "<index_pair index=\"" << i + 1 << "\" id=\"" << id++ << "\" title=\"Solid\" solid_type=\"0\" vis=\"1\" />\n";
+	}
+	ofs << "</index_map>\n<file_text><![CDATA[" << brep.str() << "]]></file_text>\n</BREP_file>\n";
+
+	ofs << "</HeeksCAD_Document>\n";
+}
+
+static bool CopyFile(const std::string &from, const std::string &to)
+{
+	std::ifstream ifs(from.c_str(), std::ios::binary);
+	if(!ifs)return false;
+	std::ofstream ofs(to.c_str(), std::ios::binary);
+	ofs << ifs.rdbuf();
+	return ofs.good();
+}
+
+static bool ReadFile(const std::string &filepath, std::string &text)
+{
+	std::ifstream ifs(filepath.c_str(), std::ios::binary);
+	if(!ifs)return false;
+	std::ostringstream ss;
+	ss << ifs.rdbuf();
+	text = ss.str();
+	return true;
+}
+
+static std::string ChangeExtension(const std::string &filepath, const char* ext)
+{
+	size_t dot = filepath.rfind('.');
+	return filepath.substr(0, dot) + "." + ext;
+}
+
+// runs "heekscad --convert ext filepath", and gets the times it prints
+static bool Convert(const char* ext, const std::string &filepath, double &read_time, double &write_time)
+{
+	std::string command = "\"" + program + "\" --convert " + ext + " \"" + filepath + "\"";
+	FILE* f = popen(command.c_str(), "r");
+	if(f == NULL)return false;
+
+	bool found = false;
+	char line[4096];
+	while(fgets(line, sizeof(line), f))
+	{
+		const char* times = strstr(line, "read in ");
+		if(times && sscanf(times, "read in %lfs, written in %lfs", &read_time, &write_time) == 2)found = true;
+	}
+	int result = pclose(f);
+
+	if(!found || result != 0)
+	{
+		std::cout << command << " failed\n";
+		return false;
+	}
+	return true;
+}
+
+static long FileSize(const std::string &filepath)
+{
+	std::string text;
+	if(!ReadFile(filepath, text))return 0;
+	return (long)text.size();
+}
+
+static bool TestFile(const std::string &filepath)
+{
+	std::cout << filepath << "\n";
+
+	// XML -> XML
+	std::string xml_path = ChangeExtension(filepath, "xml_round_trip.heeks");
+	if(!CopyFile(filepath, xml_path))
+	{
+		std::cout << "couldn't copy " << filepath << "\n";
+		return false;
+	}
+	double xml_read, xml_write;
+	if(!Convert("heeks", xml_path, xml_read, xml_write))return false;
+
+	// XML -> binary -> XML
+	std::string binary_path = ChangeExtension(filepath, "binary_round_trip.heeks");
+	CopyFile(filepath, binary_path);
+	double xml_read2, binary_write, binary_read, xml_write2;
+	if(!Convert("heeksb", binary_path, xml_read2, binary_write))return false;
+	if(!Convert("heeks", ChangeExtension(binary_path, "heeksb"), binary_read, xml_write2))return false;
+
+	std::cout << "  XML:    " << FileSize(xml_path) << " bytes, read in " << xml_read << "s, written in " << xml_write << "s\n";
+	std::cout << "  binary: " << FileSize(ChangeExtension(binary_path, "heeksb")) << " bytes, read in " << binary_read << "s, written in " << binary_write << "s\n";
+
+	std::string xml_text, binary_text;
+	ReadFile(xml_path, xml_text);
+	ReadFile(binary_path, binary_text);
+	if(xml_text != binary_text)
+	{
+		size_t i = 0;
+		while(i < xml_text.size() && i < binary_text.size() && xml_text[i] == binary_text[i])i++;
+		size_t line_start = xml_text.rfind('\n', i);
+		line_start = (line_start == std::string::npos) ? 0 : line_start + 1;
+		std::cout << "  DIFFERENT after going through a binary file, at byte " << i << ":\n";
+		std::cout << "  " << xml_text.substr(line_start, xml_text.find('\n', i) - line_start) << "\n";
+		std::cout << "  " << binary_text.substr(line_start, binary_text.find('\n', i) - line_start) << "\n";
+		return false;
+	}
+
+	std::cout << "  the same after going through a binary file\n";
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2)
+	{
+		std::cout << "usage: HeeksBinaryFiletest path/to/heekscad [a.heeks b.heeks ...]\n";
+		return 1;
+	}
+	program = argv[1];
+
+	std::vector<std::string> files;
+	for(int i = 2; i < argc; i++)files.push_back(argv[i]);
+	if(files.size() == 0)
+	{
+		MakeDocument("generated.heeks");
+		files.push_back("generated.heeks");
+	}
+
+	bool ok = true;
+	for(unsigned int i = 0; i < files.size(); i++)
+	{
+		if(!TestFile(files[i]))ok = false;
+	}
+
+	return ok ? 0 : 1;
+}
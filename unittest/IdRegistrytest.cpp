@@ -0,0 +1,162 @@
+// IdRegistrytest.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+// checks CIdTable against a std::map of the same IDs, then times it against the std::map lookups and ID search it replaced
+
+#include "../src/IdRegistry.cpp"
+#include <stdlib.h>
+#include <time.h>
+#include <iostream>
+
+// stands in for real objects; CIdTable only compares the pointers
+static HeeksObj* FakeObject(int n){return (HeeksObj*)(size_t)(16 * (n + 1));}
+
+// the old way of doing it
+class CMapIdTable
+{
+	std::map<int, std::list<HeeksObj*> > m_map;
+	int m_next_id;
+
+public:
+	CMapIdTable():m_next_id(1){}
+
+	void Add(int id, HeeksObj* object){m_map[id].push_back(object);}
+	void Remove(int id, HeeksObj* object)
+	{
+		std::map<int, std::list<HeeksObj*> >::iterator FindIt = m_map.find(id);
+		if(FindIt == m_map.end())return;
+		FindIt->second.remove(object);
+		if(FindIt->second.size() == 0)m_map.erase(FindIt);
+	}
+	HeeksObj* Find(int id)const
+	{
+		std::map<int, std::list<HeeksObj*> >::const_iterator FindIt = m_map.find(id);
+		if(FindIt == m_map.end())return NULL;
+		return FindIt->second.back();
+	}
+	int GetNextID()
+	{
+		while(m_map.find(m_next_id) != m_map.end())m_next_id++;
+		return m_next_id;
+	}
+};
+
+static bool CheckAgainstMap(int num_steps)
+{
+	CIdTable table;
+	std::map<int, std::list<HeeksObj*> > expected;
+	std::vector< std::pair<int, HeeksObj*> > added;
+
+	for(int step = 0; step < num_steps; step++)
+	{
+		int r = rand() % 10;
+		if(r < 5 || added.size() == 0)
+		{
+			// mostly new IDs, sometimes an ID which is already used
+			int id = (r == 0 && added.size() > 0) ? added[rand() % added.size()].first : table.GetNextID();
+			if(table.Contains(id) && r != 0)
+			{
+				std::cout << "GetNextID gave " << id << " which is already used\n";
+				return false;
+			}
+			HeeksObj* object = FakeObject(step);
+			table.Add(id, object);
+			expected[id].push_back(object);
+			added.push_back(std::make_pair(id, object));
+		}
+		else if(r < 8)
+		{
+			size_t n = rand() % added.size();
+			table.Remove(added[n].first, added[n].second);
+			expected[added[n].first].remove(added[n].second);
+			if(expected[added[n].first].size() == 0)expected.erase(added[n].first);
+			added[n] = added.back();
+			added.pop_back();
+		}
+		else
+		{
+			int id = rand() % (added.size() + 10);
+			std::list<HeeksObj*> objects;
+			table.FindAll(id, objects);
+			std::map<int, std::list<HeeksObj*> >::iterator FindIt = expected.find(id);
+			bool same = (FindIt == expected.end()) ? (objects.size() == 0) : (objects == FindIt->second);
+			if(!same)
+			{
+				std::cout << "FindAll(" << id << ") gave different objects\n";
+				return false;
+			}
+		}
+
+		if(table.Size() != added.size())
+		{
+			std::cout << "Size() is " << table.Size() << ", expected " << added.size() << "\n";
+			return false;
+		}
+	}
+
+	// a released ID must be given out again before any new one
+	if(added.size() > 0)
+	{
+		int id = added[0].first;
+		std::map<int, std::list<HeeksObj*> >::iterator FindIt = expected.find(id);
+		for(std::list<HeeksObj*>::iterator It = FindIt->second.begin(); It != FindIt->second.end(); It++)table.Remove(id, *It);
+		int next = table.GetNextID();
+		if(next > id)
+		{
+			std::cout << "GetNextID gave " << next << " after " << id << " was released\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template<class T> static double TimeAddRemove(int num_objects, int num_rounds)
+{
+	T table;
+	std::vector<int> ids(num_objects);
+	clock_t start = clock();
+	for(int i = 0; i < num_objects; i++)
+	{
+		ids[i] = table.GetNextID();
+		table.Add(ids[i], FakeObject(i));
+	}
+	// delete and re-add objects, like undo and redo do
+	for(int round = 0; round < num_rounds; round++)
+	{
+		for(int i = round % 7; i < num_objects; i += 7)table.Remove(ids[i], FakeObject(i));
+		for(int i = round % 7; i < num_objects; i += 7)
+		{
+			ids[i] = table.GetNextID();
+			table.Add(ids[i], FakeObject(i));
+		}
+		for(int i = 0; i < num_objects; i++)
+		{
+			if(table.Find(ids[i]) == NULL)std::cout << "lost ID " << ids[i] << "\n";
+		}
+	}
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[])
+{
+	srand(time(0));
+
+	bool ok = true;
+	for(int i = 0; i < 20; i++)
+	{
+		if(!CheckAgainstMap(10000))ok = false;
+	}
+	std::cout << (ok ? "CIdTable matches std::map\n" : "CIdTable FAILED\n");
+
+	int sizes[] = {1000, 10000, 100000, 1000000};
+	for(int i = 0; i < 4; i++)
+	{
+		double t_map = TimeAddRemove<CMapIdTable>(sizes[i], 10);
+		double t_table = TimeAddRemove<CIdTable>(sizes[i], 10);
+		std::cout << sizes[i] << " objects: std::map " << t_map << "s, CIdTable " << t_table << "s\n";
+	}
+
+	return ok ? 0 : 1;
+}
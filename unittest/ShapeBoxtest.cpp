@@ -0,0 +1,156 @@
+// ShapeBoxtest.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+// checks that GetShapeBox, which CShape::GetBox uses, doesn't mesh solids, and times it against meshing them to find their boxes, as GetBox used to.
+//   ShapeBoxtest [a.step]
+// with no STEP file, it writes 1,000 boxes, cylinders and spheres to generated.step and reads them back.
+
+#include "../src/ShapeBox.cpp"
+#include <TopLoc_Location.hxx>
+#include <gp_Ax2.hxx>
+#include <locale.h>
+#include <time.h>
+#include <iostream>
+
+static void MakeStepFile(const char* filepath)
+{
+	TopoDS_Compound compound;
+	BRep_Builder builder;
+	builder.MakeCompound(compound);
+	for(int i = 0; i < 1000; i++)
+	{
+		gp_Pnt p((i % 10) * 20.0, ((i / 10) % 10) * 20.0, (i / 100) * 20.0);
+		switch(i % 3)
+		{
+		case 0:
+			builder.Add(compound, BRepPrimAPI_MakeBox(p, 10.0, 8.0, 6.0).Shape());
+			break;
+		case 1:
+			builder.Add(compound, BRepPrimAPI_MakeCylinder(gp_Ax2(p, gp_Dir(0, 0, 1)), 5.0, 10.0).Shape());
+			break;
+		default:
+			builder.Add(compound, BRepPrimAPI_MakeSphere(p, 6.0).Shape());
+			break;
+		}
+	}
+
+	STEPControl_Writer writer;
+	writer.Transfer(compound, STEPControl_AsIs);
+	writer.Write(filepath);
+}
+
+static void ReadStepFile(const char* filepath, std::vector<TopoDS_Shape> &solids)
+{
+	solids.clear();
+	STEPControl_Reader reader;
+	if(reader.ReadFile(filepath) != IFSelect_RetDone)return;
+	reader.TransferRoots();
+	for(TopExp_Explorer ex(reader.OneShape(), TopAbs_SOLID); ex.More(); ex.Next())solids.push_back(ex.Current());
+}
+
+static int NumTriangulatedFaces(const TopoDS_Shape &shape)
+{
+	int n = 0;
+	for(TopExp_Explorer ex(shape, TopAbs_FACE); ex.More(); ex.Next())
+	{
+		TopLoc_Location loc;
+		if(!BRep_Tool::Triangulation(TopoDS::Face(ex.Current()), loc).IsNull())n++;
+	}
+	return n;
+}
+
+// the box of the triangle corners, like the face boxes GetBox used to add up
+static void GetMeshBox(const TopoDS_Shape &shape, CBox &box)
+{
+	for(TopExp_Explorer ex(shape, TopAbs_FACE); ex.More(); ex.Next())
+	{
+		TopLoc_Location loc;
+		Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(TopoDS::Face(ex.Current()), loc);
+		if(triangulation.IsNull())continue;
+		const TColgp_Array1OfPnt& nodes = triangulation->Nodes();
+		for(int i = nodes.Lower(); i <= nodes.Upper(); i++)
+		{
+			gp_Pnt p = nodes(i).Transformed(loc.Transformation());
+			box.Insert(p.X(), p.Y(), p.Z());
+		}
+	}
+}
+
+static bool Contains(const CBox &outer, const CBox &inner)
+{
+	const double tol = 1.0e-6;
+	for(int i = 0; i < 3; i++)
+	{
+		if(inner.m_x[i] < outer.m_x[i] - tol)return false;
+		if(inner.m_x[i + 3] > outer.m_x[i + 3] + tol)return false;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	char oldlocale[1000];
+	strcpy(oldlocale, setlocale(LC_NUMERIC, "C"));
+
+	const char* filepath = "generated.step";
+	if(argc > 1)filepath = argv[1];
+	else MakeStepFile(filepath);
+
+	std::vector<TopoDS_Shape> solids;
+	ReadStepFile(filepath, solids);
+	if(solids.size() == 0)
+	{
+		std::cout << "no solids in " << filepath << "\n";
+		return 1;
+	}
+
+	bool ok = true;
+
+	// the way GetBox finds boxes now
+	std::vector<CBox> boxes(solids.size());
+	clock_t start = clock();
+	for(unsigned int i = 0; i < solids.size(); i++)GetShapeBox(solids[i], boxes[i]);
+	double t_new = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	int num_meshed = 0;
+	for(unsigned int i = 0; i < solids.size(); i++)
+	{
+		if(NumTriangulatedFaces(solids[i]) > 0)num_meshed++;
+	}
+	if(num_meshed > 0)
+	{
+		std::cout << "GetShapeBox meshed " << num_meshed << " of " << solids.size() << " solids\n";
+		ok = false;
+	}
+
+	// the way GetBox used to find them, meshing at 1mm
+	std::vector<CBox> mesh_boxes(solids.size());
+	start = clock();
+	for(unsigned int i = 0; i < solids.size(); i++)
+	{
+		BRepTools::Clean(solids[i]);
+		BRepMesh::Mesh(solids[i], 1.0);
+		GetMeshBox(solids[i], mesh_boxes[i]);
+	}
+	double t_old = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	// the triangles are on the surfaces, so they must be inside the box
+	int num_outside = 0;
+	for(unsigned int i = 0; i < solids.size(); i++)
+	{
+		if(mesh_boxes[i].m_valid && !(boxes[i].m_valid && Contains(boxes[i], mesh_boxes[i])))num_outside++;
+	}
+	if(num_outside > 0)
+	{
+		std::cout << num_outside << " of " << solids.size() << " meshed solids went outside their boxes\n";
+		ok = false;
+	}
+
+	setlocale(LC_NUMERIC, oldlocale);
+
+	std::cout << solids.size() << " solids from " << filepath << ": GetShapeBox " << t_new << "s, meshing " << t_old << "s\n";
+	std::cout << (ok ? "GetShapeBox didn't mesh anything\n" : "GetShapeBox FAILED\n");
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+// SpanLinkertest.cpp
+// Copyright (c) 2014, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+// makes chains of 10,000 to 1,000,000 spans, shuffles them and reverses some, then times CSpanLinker joining them up again.
+// up to 20,000 spans, it also runs the relinker CSpanLinker replaced, which looked through the whole list for every link, and checks they make the same chains.
+
+#include "../src/SpanLinker.cpp"
+#include <stdlib.h>
+#include <time.h>
+#include <iostream>
+
+static const double tol = 0.01;
+
+class Span
+{
+public:
+	double m_s[3];
+	double m_e[3];
+};
+
+static double Random(){return (double)rand() / RAND_MAX;}
+
+static void MakeSpans(int num_spans, std::vector<Span> &spans)
+{
+	// random walks of 100 spans each, spread out so different walks hardly ever touch
+	spans.clear();
+	double p[3] = {0.0, 0.0, 0.0};
+	double side = sqrt((double)num_spans) * 10.0;
+	for(int i = 0; i < num_spans; i++)
+	{
+		if(i % 100 == 0)
+		{
+			p[0] = Random() * side;
+			p[1] = Random() * side;
+			p[2] = 0.0;
+		}
+		Span span;
+		double angle = Random() * 6.2831853;
+		for(int j = 0; j<3; j++)span.m_s[j] = p[j] + (Random() - 0.5) * tol * 0.5; // ends which only match within the tolerance
+		p[0] += cos(angle);
+		p[1] += sin(angle);
+		for(int j = 0; j<3; j++)span.m_e[j] = p[j];
+		spans.push_back(span);
+	}
+
+	// shuffle them and reverse some
+	for(int i = num_spans - 1; i > 0; i--)
+	{
+		int k = rand() % (i + 1);
+		std::swap(spans[i], spans[k]);
+	}
+	for(int i = 0; i < num_spans; i++)
+	{
+		if(rand() % 2)
+		{
+			Span &span = spans[i];
+			for(int j = 0; j<3; j++)std::swap(span.m_s[j], span.m_e[j]);
+		}
+	}
+}
+
+static bool IsEqual(const double* a, const double* b)
+{
+	double dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+	return sqrt(dx*dx + dy*dy + dz*dz) <= tol;
+}
+
+// the relinker as it was before CSpanLinker, working on Span objects instead of HeeksObj
+class COldRelinker
+{
+	std::vector<Span> m_spans;
+	std::vector<char> m_reversed;
+	std::set<int> m_added_from_old_set;
+	int m_old_front;
+	int m_new_back;
+	int m_new_front;
+
+	void Reverse(int i)
+	{
+		Span &span = m_spans[i];
+		for(int j = 0; j<3; j++)std::swap(span.m_s[j], span.m_e[j]);
+		m_reversed[i] = !m_reversed[i];
+	}
+
+	bool TryAdd(int i)
+	{
+		if(m_added_from_old_set.find(i) != m_added_from_old_set.end())return false;
+
+		if(IsEqual(m_spans[m_new_back].m_e, m_spans[i].m_s))
+		{
+			m_new_lists.back().push_back(CSpanLinker::Link(i, m_reversed[i] != 0));
+			m_new_back = i;
+			m_added_from_old_set.insert(i);
+			return true;
+		}
+		if(IsEqual(m_spans[m_new_back].m_e, m_spans[i].m_e))
+		{
+			Reverse(i);
+			m_new_lists.back().push_back(CSpanLinker::Link(i, m_reversed[i] != 0));
+			m_new_back = i;
+			m_added_from_old_set.insert(i);
+			return true;
+		}
+		if(IsEqual(m_spans[m_new_front].m_s, m_spans[i].m_e))
+		{
+			m_new_lists.back().push_front(CSpanLinker::Link(i, m_reversed[i] != 0));
+			m_new_front = i;
+			m_added_from_old_set.insert(i);
+			return true;
+		}
+		if(IsEqual(m_spans[m_new_front].m_s, m_spans[i].m_s))
+		{
+			Reverse(i);
+			m_new_lists.back().push_front(CSpanLinker::Link(i, m_reversed[i] != 0));
+			m_new_front = i;
+			m_added_from_old_set.insert(i);
+			return true;
+		}
+		return false;
+	}
+
+	void StartNewList(int i)
+	{
+		std::list<CSpanLinker::Link> empty_list;
+		m_new_lists.push_back(empty_list);
+		m_new_lists.back().push_back(CSpanLinker::Link(i, false));
+		m_added_from_old_set.insert(i);
+		m_old_front = i;
+		m_new_back = i;
+		m_new_front = i;
+	}
+
+	bool AddNext()
+	{
+		int n = (int)m_spans.size();
+		int i = m_old_front;
+		do{
+			i = (i + 1) % n;
+			if(TryAdd(i))return true;
+		}while(i != m_old_front);
+
+		for(i = 0; i < n; i++)
+		{
+			if(m_added_from_old_set.find(i) == m_added_from_old_set.end())
+			{
+				StartNewList(i);
+				return true;
+			}
+		}
+		return false;
+	}
+
+public:
+	std::list< std::list<CSpanLinker::Link> > m_new_lists;
+
+	COldRelinker(const std::vector<Span> &spans):m_spans(spans), m_reversed(spans.size(), 0), m_old_front(0), m_new_back(0), m_new_front(0){}
+
+	void Do()
+	{
+		if(m_spans.size() == 0)return;
+		StartNewList(0);
+		while(AddNext()){}
+	}
+};
+
+static bool SameChains(const std::list< std::list<CSpanLinker::Link> > &a, const std::list< std::list<CSpanLinker::Link> > &b)
+{
+	if(a.size() != b.size())return false;
+	std::list< std::list<CSpanLinker::Link> >::const_iterator ItB = b.begin();
+	for(std::list< std::list<CSpanLinker::Link> >::const_iterator ItA = a.begin(); ItA != a.end(); ItA++, ItB++)
+	{
+		if(ItA->size() != ItB->size())return false;
+		std::list<CSpanLinker::Link>::const_iterator ItB2 = ItB->begin();
+		for(std::list<CSpanLinker::Link>::const_iterator ItA2 = ItA->begin(); ItA2 != ItA->end(); ItA2++, ItB2++)
+		{
+			if(ItA2->m_span != ItB2->m_span || ItA2->m_reversed != ItB2->m_reversed)return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	srand(time(0));
+
+	bool ok = true;
+	int sizes[] = {10000, 20000, 100000, 1000000};
+	for(int i = 0; i < 4; i++)
+	{
+		std::vector<Span> spans;
+		MakeSpans(sizes[i], spans);
+
+		clock_t start = clock();
+		CSpanLinker linker(tol);
+		for(std::vector<Span>::iterator It = spans.begin(); It != spans.end(); It++)linker.AddSpan(It->m_s, It->m_e);
+		linker.Do();
+		double t_new = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+		std::cout << sizes[i] << " spans, " << linker.m_chains.size() << " chains: CSpanLinker " << t_new << "s";
+
+		if(sizes[i] <= 20000)
+		{
+			start = clock();
+			COldRelinker old_relinker(spans);
+			old_relinker.Do();
+			double t_old = (double)(clock() - start) / CLOCKS_PER_SEC;
+			bool same = SameChains(old_relinker.m_new_lists, linker.m_chains);
+			if(!same)ok = false;
+			std::cout << ", old relinker " << t_old << "s, " << (same ? "same chains" : "DIFFERENT CHAINS");
+		}
+		std::cout << "\n";
+	}
+
+	return ok ? 0 : 1;
+}